@@ -0,0 +1,50 @@
+// Steady-state allocation check.
+//
+// Streams input through the plugin's native injector with the runner's
+// malloc counting every allocation the pipeline makes for it, from the evdev
+// read to the encoded event message, and fails on any allocation after the
+// warm-up. Run with:
+//
+//   flutter test integration_test/allocation_check_test.dart -d linux
+
+import 'dart:convert';
+import 'dart:io';
+
+import 'package:flutter/services.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:integration_test/integration_test.dart';
+
+import 'package:universal_gamepad/universal_gamepad.dart';
+
+// The check is a test hook, not public API, so it is driven over the
+// plugin's method channel directly.
+const _methods = MethodChannel('dev.universal_gamepad/methods');
+
+void main() {
+  final binding = IntegrationTestWidgetsFlutterBinding.ensureInitialized();
+
+  testWidgets('steady-state input does not allocate',
+      (WidgetTester tester) async {
+    // Input is only encoded while Dart listens.
+    var received = 0;
+    final subscription = Gamepad.instance.events.listen((event) {
+      if (event is GamepadButtonEvent || event is GamepadAxisEvent) {
+        ++received;
+      }
+    });
+    try {
+      final report = await _methods.invokeMapMethod<String, Object?>(
+        'runAllocationCheck',
+        {'rounds': 500},
+      );
+
+      binding.reportData = {'allocations': report};
+      // ignore: avoid_print
+      print(const JsonEncoder.withIndent('  ').convert(report));
+      expect(received, greaterThan(0));
+      expect(report!['allocations'], 0);
+    } finally {
+      await subscription.cancel();
+    }
+  }, skip: !Platform.isLinux, timeout: Timeout.none);
+}
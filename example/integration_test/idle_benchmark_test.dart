@@ -0,0 +1,51 @@
+// Idle cost benchmark.
+//
+// Runs the plugin in each threading mode with zero, one and several idle
+// uinput pads attached and reports, per thread, CPU time and wakeups (voluntary context switches)
+// over a fixed window, plus whole-process getrusage() numbers. Run with:
+//
+//   flutter test integration_test/idle_benchmark_test.dart -d linux
+//
+// Idle pads need write access to /dev/uinput; without it only the
+// zero-device run is meaningful and `idleDevices` reports how many pads
+// were actually created.
+
+import 'dart:convert';
+import 'dart:io';
+
+import 'package:flutter/services.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:integration_test/integration_test.dart';
+
+// The idle measurement is a benchmark hook, not public API, so it is driven
+// over the plugin's method channel directly.
+const _methods = MethodChannel('dev.universal_gamepad/methods');
+
+const _window = Duration(seconds: 10);
+const _deviceCounts = [0, 1, 4];
+const _threadingModes = ['threaded', 'inline'];
+
+void main() {
+  final binding = IntegrationTestWidgetsFlutterBinding.ensureInitialized();
+
+  testWidgets('idle cost', (WidgetTester tester) async {
+    final modes = <String, Object>{};
+    for (final mode in _threadingModes) {
+      await _methods.invokeMethod<void>('setThreadingMode', {'mode': mode});
+      final runs = <Object?>[];
+      for (final devices in _deviceCounts) {
+        runs.add(await _methods.invokeMethod<Object?>('measureIdle', {
+          'durationMs': _window.inMilliseconds,
+          'idleDevices': devices,
+        }));
+      }
+      modes[mode] = runs;
+    }
+    await _methods.invokeMethod<void>('setThreadingMode', {'mode': 'threaded'});
+
+    final report = {'windowMs': _window.inMilliseconds, 'modes': modes};
+    binding.reportData = {'idle_benchmark': report};
+    // ignore: avoid_print
+    print(const JsonEncoder.withIndent('  ').convert(report));
+  }, skip: !Platform.isLinux, timeout: const Timeout(Duration(minutes: 3)));
+}
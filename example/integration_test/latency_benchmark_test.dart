@@ -0,0 +1,158 @@
+// End-to-end input latency benchmark.
+//
+// Injects input through the plugin's native injector (a uinput pad when
+// /dev/uinput is writable, otherwise a device fed straight into the evdev
+// worker) and measures how long each change takes to arrive on the event
+// stream. The injector stamps each injection natively with the wall clock
+// and the Dart side compares that stamp with the time the event is
+// received, so the method call that triggers the injection is not part of
+// the sample. Run with:
+//
+//   flutter test integration_test/latency_benchmark_test.dart -d linux
+//
+// The JSON report is printed and attached to the binding's reportData, so
+// `flutter drive` writes it to build/integration_response_data.json.
+
+import 'dart:async';
+import 'dart:convert';
+import 'dart:io';
+
+import 'package:flutter/services.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:integration_test/integration_test.dart';
+
+import 'package:universal_gamepad/universal_gamepad.dart';
+
+// The injector is a benchmark hook, not public API, so it is driven over the
+// plugin's method channel directly.
+const _methods = MethodChannel('dev.universal_gamepad/methods');
+
+const _injectorName = 'Universal Gamepad Injector';
+const _latencySamples = 500;
+const _throughputEvents = 2000;
+
+/// Delivery modes to benchmark. Each entry configures the plugin before its
+/// run. Switching the threading mode restarts the native manager, so every
+/// entry sets it explicitly.
+final Map<String, Future<void> Function()> _deliveryModes = {
+  'fixed-16ms': () async {
+    await _setThreading('threaded');
+    await Gamepad.instance.setDeliveryLatencyBounds(
+      min: const Duration(milliseconds: 16),
+      max: const Duration(milliseconds: 16),
+    );
+  },
+  'adaptive': () async {
+    await _setThreading('threaded');
+    await Gamepad.instance.setDeliveryLatencyBounds();
+  },
+  'inline': () => _setThreading('inline'),
+};
+
+Future<void> _setThreading(String mode) =>
+    _methods.invokeMethod<void>('setThreadingMode', {'mode': mode});
+
+void main() {
+  final binding = IntegrationTestWidgetsFlutterBinding.ensureInitialized();
+
+  testWidgets('end-to-end latency', (WidgetTester tester) async {
+    final events = Gamepad.instance.events;
+    String? source;
+
+    final modes = <String, Object>{};
+    for (final entry in _deliveryModes.entries) {
+      await entry.value();
+      final connected = events
+          .whereType<GamepadConnectionEvent>()
+          .firstWhere((e) => e.connected && e.info.name == _injectorName);
+      source = await _methods.invokeMethod<String>('startInjector');
+      final gamepadId = (await connected.timeout(const Duration(seconds: 5)))
+          .gamepadId;
+      modes[entry.key] = {
+        'latency': await _measureLatency(events, gamepadId),
+        'throughput': await _measureThroughput(events, gamepadId),
+      };
+      await _methods.invokeMethod<void>('stopInjector');
+    }
+    await _setThreading('threaded');
+
+    final report = {
+      'source': source,
+      'samples': _latencySamples,
+      'modes': modes,
+    };
+    binding.reportData = {'latency_benchmark': report};
+    // ignore: avoid_print
+    print(const JsonEncoder.withIndent('  ').convert(report));
+  }, skip: !Platform.isLinux);
+}
+
+/// Injects one stick change at a time and times its arrival from the native
+/// injection stamp.
+Future<Map<String, double>> _measureLatency(
+  Stream<GamepadEvent> events,
+  int gamepadId,
+) async {
+  final samples = <int>[];
+  for (var i = 0; i < _latencySamples; i++) {
+    // Distinct values, far enough apart to never be throttled.
+    final value = -0.9 + (i % 90) * 0.02;
+    final receivedAtUs = events
+        .whereType<GamepadAxisEvent>()
+        .firstWhere((e) =>
+            e.gamepadId == gamepadId &&
+            e.axis == GamepadAxis.leftStickX &&
+            (e.value - value).abs() < 0.001)
+        .then((_) => DateTime.now().microsecondsSinceEpoch);
+    final injectedAtUs = await _methods.invokeMethod<int>(
+        'inject', {'type': 2, 'index': 0, 'value': value});
+    samples.add(
+        await receivedAtUs.timeout(const Duration(seconds: 1)) -
+            injectedAtUs!);
+  }
+
+  samples.sort();
+  double percentile(double p) =>
+      samples[((samples.length - 1) * p).round()] / 1000.0;
+  return {
+    'p50_ms': percentile(0.50),
+    'p95_ms': percentile(0.95),
+    'p99_ms': percentile(0.99),
+    'max_ms': samples.last / 1000.0,
+  };
+}
+
+/// Injects a native burst of button toggles, which are never coalesced, and
+/// measures how fast they are delivered, from the start of the burst to the
+/// arrival of its last event. Fails if the burst is not delivered in full.
+Future<Map<String, num>> _measureThroughput(
+  Stream<GamepadEvent> events,
+  int gamepadId,
+) async {
+  var received = 0;
+  var lastAtUs = 0;
+  final done = Completer<void>();
+  final subscription = events
+      .whereType<GamepadButtonEvent>()
+      .where((e) => e.gamepadId == gamepadId)
+      .listen((_) {
+    if (++received == _throughputEvents && !done.isCompleted) {
+      lastAtUs = DateTime.now().microsecondsSinceEpoch;
+      done.complete();
+    }
+  });
+
+  try {
+    final startedAtUs = await _methods.invokeMethod<int>(
+        'injectBurst', {'index': 0, 'count': _throughputEvents});
+    await done.future.timeout(const Duration(seconds: 10), onTimeout: () {
+      fail('Received $received of $_throughputEvents burst events');
+    });
+    return {
+      'events': received,
+      'events_per_second': received / ((lastAtUs - startedAtUs!) / 1e6),
+    };
+  } finally {
+    await subscription.cancel();
+  }
+}
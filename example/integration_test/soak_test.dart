@@ -0,0 +1,45 @@
+// Hotplug churn soak test.
+//
+// Connects, streams through and disconnects a uinput pad over and over and
+// fails if process RSS grows by more than a few bytes per cycle, or if open
+// fds or the GSources on the plugin's contexts keep growing. Needs write
+// access to /dev/uinput. Run with:
+//
+//   flutter test integration_test/soak_test.dart -d linux \
+//       --dart-define=SOAK_CYCLES=5000
+
+import 'dart:convert';
+import 'dart:io';
+
+import 'package:flutter/services.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:integration_test/integration_test.dart';
+
+// The soak is a test hook, not public API, so it is driven over the
+// plugin's method channel directly.
+const _methods = MethodChannel('dev.universal_gamepad/methods');
+
+const _cycles = int.fromEnvironment('SOAK_CYCLES', defaultValue: 200);
+
+void main() {
+  final binding = IntegrationTestWidgetsFlutterBinding.ensureInitialized();
+
+  testWidgets('hotplug churn does not leak', (WidgetTester tester) async {
+    final report = await _methods.invokeMapMethod<String, Object?>(
+      'runSoak',
+      {'cycles': _cycles, 'eventsPerCycle': 100},
+    );
+
+    binding.reportData = {'soak': report};
+    // ignore: avoid_print
+    print(const JsonEncoder.withIndent('  ').convert(report));
+    expect(report!['fdGrowth'], 0);
+    expect(report['sourceGrowth'], 0);
+    expect(report['liveSourceGrowth'], 0);
+    expect(
+      report['rssSlopeKbPerCycle'] as double,
+      lessThanOrEqualTo(report['maxRssSlopeKbPerCycle'] as double),
+    );
+    expect(report['leaked'], isFalse);
+  }, skip: !Platform.isLinux, timeout: Timeout.none);
+}
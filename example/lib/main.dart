@@ -104,6 +104,19 @@ class _GamepadDemoPageState extends State<GamepadDemoPage> {
           _addLog(
             '${e.axis.name}: ${e.value.toStringAsFixed(3)}',
           );
+
+        case GamepadPointerEvent e:
+          _addLog(
+            'pointer: ${e.dx.toStringAsFixed(1)}, ${e.dy.toStringAsFixed(1)}',
+          );
+
+        case GamepadRawEvent e:
+          _addLog('raw: ${e.length} evdev events');
+
+        case GamepadBatteryEvent e:
+          _addLog(
+            'battery: ${e.battery.level ?? "?"}% ${e.battery.status.name}',
+          );
       }
     });
   }
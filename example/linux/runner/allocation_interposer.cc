@@ -0,0 +1,107 @@
+// Allocation counting for the plugin's allocation check
+// (integration_test/allocation_check_test.dart).
+//
+// Defining malloc, calloc, realloc, memalign, aligned_alloc and
+// posix_memalign in the executable interposes them for the whole process.
+// Each forwards to glibc's own (__libc_malloc and friends), so free() and
+// malloc_usable_size() stay consistent, and counts the call while the
+// counter is armed and the calling thread has asked for its allocations to
+// count.  operator new goes through malloc, so C++ allocations are counted
+// too.  Outside a counted scope an allocation costs one thread-local load
+// more than usual.
+//
+// The plugin finds the functions below with dlsym() and does nothing if
+// they are missing, so only this runner pays for the interposer; apps
+// using the plugin keep their own allocator.
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+namespace {
+
+std::atomic<bool> g_armed{false};
+std::atomic<uint64_t> g_allocations{0};
+std::atomic<uint64_t> g_bytes{0};
+
+thread_local bool t_counting = false;
+
+void Count(size_t size) {
+  if (t_counting && g_armed.load(std::memory_order_relaxed)) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace
+
+extern "C" {
+
+// The counter's interface to the plugin.
+
+// Sets whether the calling thread's allocations count; returns the previous
+// setting.
+bool universal_gamepad_count_allocations(bool counting) {
+  bool saved = t_counting;
+  t_counting = counting;
+  return saved;
+}
+
+// Arming clears the counts; disarming keeps them readable.
+void universal_gamepad_arm_allocation_counter(bool armed) {
+  if (armed) {
+    g_allocations.store(0);
+    g_bytes.store(0);
+  }
+  g_armed.store(armed);
+}
+
+uint64_t universal_gamepad_allocations() { return g_allocations.load(); }
+
+uint64_t universal_gamepad_allocated_bytes() { return g_bytes.load(); }
+
+// glibc's allocator under its internal names.
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void* malloc(size_t size) noexcept {
+  Count(size);
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+  Count(count * size);
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) noexcept {
+  Count(size);
+  return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size) noexcept {
+  Count(size);
+  return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept {
+  Count(size);
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** result, size_t alignment, size_t size) noexcept {
+  if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) {
+    return EINVAL;
+  }
+  Count(size);
+  void* ptr = __libc_memalign(alignment, size);
+  if (!ptr) return ENOMEM;
+  *result = ptr;
+  return 0;
+}
+
+}  // extern "C"
@@ -1,6 +1,12 @@
 import 'platform_interface.dart';
+import 'types/gamepad_axis.dart';
+import 'types/gamepad_axis_coalescing.dart';
+import 'types/gamepad_diagnostics.dart';
 import 'types/gamepad_event.dart';
 import 'types/gamepad_info.dart';
+import 'types/gamepad_replay_result.dart';
+import 'types/gamepad_state.dart';
+import 'types/gamepad_stats.dart';
 
 /// Unified gamepad input API for all Flutter platforms.
 ///
@@ -11,7 +17,8 @@ class Gamepad {
 
   static final instance = Gamepad._();
 
-  /// Stream of all gamepad events (connections, buttons, axes).
+  /// Stream of all gamepad events (connections, buttons, axes, pointer
+  /// motion).
   Stream<GamepadEvent> get events => GamepadPlatform.instance.events;
 
   /// Stream of connection/disconnection events only.
@@ -26,10 +33,110 @@ class Gamepad {
   Stream<GamepadAxisEvent> get axisEvents =>
       events.where((e) => e is GamepadAxisEvent).cast();
 
+  /// Stream of emulated cursor motion only. See [setPointerEmulation].
+  Stream<GamepadPointerEvent> get pointerEvents =>
+      events.where((e) => e is GamepadPointerEvent).cast();
+
+  /// Stream of raw evdev batches only. See [setRawPassthrough].
+  Stream<GamepadRawEvent> get rawEvents =>
+      events.where((e) => e is GamepadRawEvent).cast();
+
+  /// Stream of battery level and charge status changes only.
+  Stream<GamepadBatteryEvent> get batteryEvents =>
+      events.where((e) => e is GamepadBatteryEvent).cast();
+
   /// Returns a list of currently connected gamepads.
   Future<List<GamepadInfo>> listGamepads() =>
       GamepadPlatform.instance.listGamepads();
 
+  /// Returns each connected gamepad's measured report rate and jitter,
+  /// taken from kernel timestamps of its input reports. Only has effect on
+  /// Linux.
+  Future<List<GamepadStats>> getStats() => GamepadPlatform.instance.getStats();
+
+  /// Returns where startup and hotplug time went: plugin registration, the
+  /// initial device scan, and per device probe the time spent opening,
+  /// initialising, classifying and attaching it, plus when its first input
+  /// event was delivered. Returns null except on Linux.
+  Future<GamepadDiagnostics?> getDiagnostics() =>
+      GamepadPlatform.instance.getDiagnostics();
+
+  /// Returns a snapshot of each connected gamepad's sticks and triggers
+  /// with their velocity and acceleration, computed natively from every
+  /// raw sample and its kernel timestamp. Poll it once per frame for
+  /// rhythm or racing input.
+  ///
+  /// With a [presentationTime] (typically now plus the frame's expected
+  /// display latency), each signal is also extrapolated to that instant
+  /// from its high-rate samples, with a confidence value; blend towards
+  /// [GamepadSignal.value] as confidence drops. Only has effect on Linux.
+  Future<List<GamepadState>> getGamepadState({DateTime? presentationTime}) =>
+      GamepadPlatform.instance
+          .getGamepadState(presentationTime: presentationTime);
+
+  /// Turns a stick into a cursor. While enabled, the stick is integrated
+  /// natively over every raw sample and each delivery emits a
+  /// [GamepadPointerEvent] with the motion since the previous one, so the
+  /// cursor moves smoothly whatever the delivery rate. [speed] is the
+  /// pointer speed at full deflection in logical pixels per second,
+  /// [deadzone] a radial deadzone as a fraction of full deflection, and
+  /// [curve] the exponent of the response past it (1 is linear). Throws a
+  /// [PlatformException] with code `invalid_args` unless [speed] is finite
+  /// and non-negative, [curve] finite and positive and [deadzone] at least
+  /// 0 and below 1. Only has effect on Linux.
+  Future<void> setPointerEmulation({
+    required bool enabled,
+    bool rightStick = true,
+    double speed = 1500,
+    double deadzone = 0.15,
+    double curve = 2,
+  }) =>
+      GamepadPlatform.instance.setPointerEmulation(
+        enabled: enabled,
+        rightStick: rightStick,
+        speed: speed,
+        deadzone: deadzone,
+        curve: curve,
+      );
+
+  /// Streams every evdev event of [gamepadId] — all codes, including
+  /// ones with no W3C mapping, with no throttling — as [GamepadRawEvent]
+  /// batches, alongside the mapped events. For controller testers and
+  /// calibration tools. Throws a [PlatformException] if no such gamepad is
+  /// connected. Only has effect on Linux.
+  Future<void> setRawPassthrough(int gamepadId, {required bool enabled}) =>
+      GamepadPlatform.instance.setRawPassthrough(gamepadId, enabled: enabled);
+
+  /// Controls focus gating, which is off by default. When enabled, while
+  /// the app window is unfocused or minimized, native code keeps tracking
+  /// gamepad state but stops delivering input, and on refocus it emits one
+  /// event per button or axis that changed meanwhile. A window that has
+  /// never been focused is not gated. Connection events are always
+  /// delivered, at the latest on refocus. Only has effect on Linux.
+  Future<void> setFocusGating({required bool enabled}) =>
+      GamepadPlatform.instance.setFocusGating(enabled: enabled);
+
+  /// Selects how the samples of [axis] that native batching coalesces into
+  /// one [GamepadAxisEvent] are summarised: the envelope, mean or
+  /// displacement are computed from every raw sample, so fast flicks are
+  /// not lost between deliveries. Only has effect on Linux.
+  Future<void> setAxisCoalescing(
+    GamepadAxis axis,
+    GamepadAxisCoalescing mode,
+  ) =>
+      GamepadPlatform.instance.setAxisCoalescing(axis, mode);
+
+  /// Bounds how long input may wait in the native queue before it is
+  /// delivered. The delivery interval adapts between [min] and [max]: it
+  /// follows the fastest pad's report rate, relaxes to [max] when input is
+  /// idle, and backs off when the UI thread falls behind. Pass equal values
+  /// for a fixed interval. Only has effect on Linux.
+  Future<void> setDeliveryLatencyBounds({
+    Duration min = const Duration(milliseconds: 4),
+    Duration max = const Duration(milliseconds: 16),
+  }) =>
+      GamepadPlatform.instance.setDeliveryLatencyBounds(min: min, max: max);
+
   /// Releases native resources. After calling this, the instance
   /// should not be used until a new stream is requested.
   Future<void> dispose() => GamepadPlatform.instance.dispose();
@@ -41,4 +148,78 @@ class Gamepad {
   /// Resumes native gamepad polling after a [pause]. Connected gamepads
   /// will be re-detected and emit connection events.
   Future<void> resume() => GamepadPlatform.instance.resume();
+
+  /// Re-emits processed input through a uinput virtual gamepad per connected
+  /// pad, so other applications see the same mapped input. With [grab], the
+  /// physical devices are grabbed exclusively while forwarding to prevent
+  /// double input. Only has effect on Linux.
+  Future<void> setForwarding({required bool enabled, bool grab = false}) =>
+      GamepadPlatform.instance.setForwarding(enabled: enabled, grab: grab);
+
+  /// Continuously records every processed event to a compact native journal
+  /// file at [path], for replays and bug reproduction. Recorded input
+  /// reaches the file within about two seconds, even if no more follows.
+  /// Throws a [PlatformException] if the file cannot be created or the
+  /// plugin has been disposed. Only has effect on Linux.
+  Future<void> startJournal(String path) =>
+      GamepadPlatform.instance.startJournal(path);
+
+  /// Stops a journal started with [startJournal] and flushes it to disk.
+  Future<void> stopJournal() => GamepadPlatform.instance.stopJournal();
+
+  /// Reads up to [maxEvents] events recorded at or after [fromTimestamp]
+  /// (milliseconds since epoch) from the journal at [path]. Seeking uses the
+  /// journal's keyframe index, so it does not decode the file from the start.
+  ///
+  /// The list starts with the state at [fromTimestamp], stamped with it: a
+  /// [GamepadConnectionEvent] for every pad connected then, followed by a
+  /// button or axis event for each of its controls. These do not count
+  /// towards [maxEvents].
+  Future<List<GamepadEvent>> readJournal(
+    String path, {
+    int fromTimestamp = 0,
+    int maxEvents = 1000,
+  }) =>
+      GamepadPlatform.instance.readJournal(
+        path,
+        fromTimestamp: fromTimestamp,
+        maxEvents: maxEvents,
+      );
+
+  /// Writes the last [window] of raw and processed input, which the native
+  /// side records at all times, to a text file at [path] for bug reports.
+  /// Sending `SIGUSR2` to the process dumps to the temp directory instead.
+  /// The native ring holds a fixed number of records, so a fast pad may
+  /// cover less than [window]. Only has effect on Linux.
+  Future<void> dumpFlightRecorder(
+    String path, {
+    Duration window = const Duration(seconds: 30),
+  }) =>
+      GamepadPlatform.instance.dumpFlightRecorder(path, window: window);
+
+  /// Runs the raw input of a flight recorder dump at [path] back through the
+  /// native pipeline (mapping, throttling, coalescing, drain batching and
+  /// raw passthrough) in simulated time, as fast as the CPU allows. Drains
+  /// run at the ticks the dump recorded, with their recorded lateness and
+  /// cost, so adaptive delivery batches as it did live. The result
+  /// holds the first [maxEvents] delivered events and how long the replay
+  /// took, which makes it suitable for benchmarking long recorded sessions.
+  /// Only has effect on Linux.
+  Future<GamepadReplayResult?> replayFlightRecord(
+    String path, {
+    int maxEvents = 1000,
+  }) =>
+      GamepadPlatform.instance.replayFlightRecord(path, maxEvents: maxEvents);
+
+  /// Enables or disables the native pipeline's trace points. Enabling clears
+  /// previously recorded spans. Disabled trace points cost a single branch.
+  /// Only has effect on Linux and Windows.
+  Future<void> setTracing(bool enabled) =>
+      GamepadPlatform.instance.setTracing(enabled);
+
+  /// Writes the spans recorded since [setTracing] was enabled to [path] as
+  /// Chrome trace JSON, which loads in `chrome://tracing` and Perfetto.
+  /// Only has effect on Linux and Windows.
+  Future<void> exportTrace(String path) =>
+      GamepadPlatform.instance.exportTrace(path);
 }
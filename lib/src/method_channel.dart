@@ -4,8 +4,14 @@ import 'dart:io';
 import 'package:flutter/services.dart';
 
 import 'platform_interface.dart';
+import 'types/gamepad_axis.dart';
+import 'types/gamepad_axis_coalescing.dart';
+import 'types/gamepad_diagnostics.dart';
 import 'types/gamepad_event.dart';
 import 'types/gamepad_info.dart';
+import 'types/gamepad_replay_result.dart';
+import 'types/gamepad_state.dart';
+import 'types/gamepad_stats.dart';
 
 /// Implementation of [GamepadPlatform] using EventChannel and MethodChannel.
 class MethodChannelGamepad extends GamepadPlatform {
@@ -31,6 +37,101 @@ class MethodChannelGamepad extends GamepadPlatform {
         .toList();
   }
 
+  @override
+  Future<List<GamepadStats>> getStats() async {
+    if (!Platform.isLinux) return const [];
+    final result =
+        await _methodChannel.invokeListMethod<Map>('getStats') ?? [];
+    return result
+        .map((m) => GamepadStats.fromMap(Map<String, dynamic>.from(m)))
+        .toList();
+  }
+
+  @override
+  Future<GamepadDiagnostics?> getDiagnostics() async {
+    if (!Platform.isLinux) return null;
+    final result =
+        await _methodChannel.invokeMapMethod<String, dynamic>('getDiagnostics');
+    return result == null ? null : GamepadDiagnostics.fromMap(result);
+  }
+
+  @override
+  Future<List<GamepadState>> getGamepadState({
+    DateTime? presentationTime,
+  }) async {
+    if (!Platform.isLinux) return const [];
+    final result = await _methodChannel.invokeListMethod<Map>(
+          'getGamepadState',
+          {
+            if (presentationTime != null)
+              'presentationTimeUs': presentationTime.microsecondsSinceEpoch,
+          },
+        ) ??
+        [];
+    return result
+        .map((m) => GamepadState.fromMap(Map<String, dynamic>.from(m)))
+        .toList();
+  }
+
+  @override
+  Future<void> setPointerEmulation({
+    required bool enabled,
+    required bool rightStick,
+    required double speed,
+    required double deadzone,
+    required double curve,
+  }) async {
+    if (!Platform.isLinux) return;
+    await _methodChannel.invokeMethod<void>('setPointerEmulation', {
+      'enabled': enabled,
+      'rightStick': rightStick,
+      'speed': speed,
+      'deadzone': deadzone,
+      'curve': curve,
+    });
+  }
+
+  @override
+  Future<void> setRawPassthrough(
+    int gamepadId, {
+    required bool enabled,
+  }) async {
+    if (!Platform.isLinux) return;
+    await _methodChannel.invokeMethod<void>(
+        'setRawPassthrough', {'id': gamepadId, 'enabled': enabled});
+  }
+
+  @override
+  Future<void> setFocusGating({required bool enabled}) async {
+    if (!Platform.isLinux) return;
+    await _methodChannel
+        .invokeMethod<void>('setFocusGating', {'enabled': enabled});
+  }
+
+  @override
+  Future<void> setAxisCoalescing(
+    GamepadAxis axis,
+    GamepadAxisCoalescing mode,
+  ) async {
+    if (!Platform.isLinux) return;
+    await _methodChannel.invokeMethod<void>('setAxisCoalescing', {
+      'axis': axis.index,
+      'mode': mode.index,
+    });
+  }
+
+  @override
+  Future<void> setDeliveryLatencyBounds({
+    required Duration min,
+    required Duration max,
+  }) async {
+    if (!Platform.isLinux) return;
+    await _methodChannel.invokeMethod<void>('setDeliveryLatencyBounds', {
+      'minMs': min.inMilliseconds,
+      'maxMs': max.inMilliseconds,
+    });
+  }
+
   @override
   Future<void> dispose() async {
     await _methodChannel.invokeMethod<void>('dispose');
@@ -48,4 +149,83 @@ class MethodChannelGamepad extends GamepadPlatform {
     if (!Platform.isWindows) return;
     await _methodChannel.invokeMethod<void>('resume');
   }
+
+  @override
+  Future<void> setForwarding({
+    required bool enabled,
+    bool grab = false,
+  }) async {
+    if (!Platform.isLinux) return;
+    await _methodChannel.invokeMethod<void>('setForwarding', {
+      'enabled': enabled,
+      'grab': grab,
+    });
+  }
+
+  @override
+  Future<void> startJournal(String path) async {
+    if (!Platform.isLinux) return;
+    await _methodChannel.invokeMethod<void>('startJournal', {'path': path});
+  }
+
+  @override
+  Future<void> stopJournal() async {
+    if (!Platform.isLinux) return;
+    await _methodChannel.invokeMethod<void>('stopJournal');
+  }
+
+  @override
+  Future<List<GamepadEvent>> readJournal(
+    String path, {
+    int fromTimestamp = 0,
+    int maxEvents = 1000,
+  }) async {
+    if (!Platform.isLinux) return const [];
+    final result = await _methodChannel.invokeListMethod<List>('readJournal', {
+          'path': path,
+          'from': fromTimestamp,
+          'maxEvents': maxEvents,
+        }) ??
+        [];
+    return result.map(GamepadEvent.fromList).toList();
+  }
+
+  @override
+  Future<void> dumpFlightRecorder(
+    String path, {
+    Duration window = const Duration(seconds: 30),
+  }) async {
+    if (!Platform.isLinux) return;
+    await _methodChannel.invokeMethod<void>('dumpFlightRecorder', {
+      'path': path,
+      'windowMs': window.inMilliseconds,
+    });
+  }
+
+  @override
+  Future<GamepadReplayResult?> replayFlightRecord(
+    String path, {
+    int maxEvents = 1000,
+  }) async {
+    if (!Platform.isLinux) return null;
+    final result = await _methodChannel.invokeMapMethod<String, dynamic>(
+      'replayFlightRecord',
+      {'path': path, 'maxEvents': maxEvents},
+    );
+    return result == null ? null : GamepadReplayResult.fromMap(result);
+  }
+
+  @override
+  Future<void> setTracing(bool enabled) async {
+    if (!Platform.isLinux && !Platform.isWindows) return;
+    await _methodChannel.invokeMethod<void>('setTracing', {
+      'enabled': enabled,
+    });
+  }
+
+  @override
+  Future<void> exportTrace(String path) async {
+    if (!Platform.isLinux && !Platform.isWindows) return;
+    await _methodChannel.invokeMethod<void>('exportTrace', {'path': path});
+  }
 }
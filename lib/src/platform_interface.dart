@@ -1,8 +1,14 @@
 import 'package:plugin_platform_interface/plugin_platform_interface.dart';
 
 import 'method_channel.dart';
+import 'types/gamepad_axis.dart';
+import 'types/gamepad_axis_coalescing.dart';
+import 'types/gamepad_diagnostics.dart';
 import 'types/gamepad_event.dart';
 import 'types/gamepad_info.dart';
+import 'types/gamepad_replay_result.dart';
+import 'types/gamepad_state.dart';
+import 'types/gamepad_stats.dart';
 
 /// The interface that implementations of gamepad must implement.
 abstract class GamepadPlatform extends PlatformInterface {
@@ -29,6 +35,51 @@ abstract class GamepadPlatform extends PlatformInterface {
     throw UnimplementedError('listGamepads() has not been implemented.');
   }
 
+  /// Returns the measured report cadence of connected gamepads.
+  Future<List<GamepadStats>> getStats() async => const [];
+
+  /// Returns the startup and hotplug timing breakdown, or null if the
+  /// platform does not record one.
+  Future<GamepadDiagnostics?> getDiagnostics() async => null;
+
+  /// Returns the analog signals of connected gamepads with their
+  /// derivatives.
+  Future<List<GamepadState>> getGamepadState({
+    DateTime? presentationTime,
+  }) async =>
+      const [];
+
+  /// Enables or disables native stick pointer emulation.
+  Future<void> setPointerEmulation({
+    required bool enabled,
+    required bool rightStick,
+    required double speed,
+    required double deadzone,
+    required double curve,
+  }) async {}
+
+  /// Enables or disables raw evdev passthrough for one gamepad.
+  Future<void> setRawPassthrough(
+    int gamepadId, {
+    required bool enabled,
+  }) async {}
+
+  /// Enables or disables pausing input delivery while the window is
+  /// unfocused.
+  Future<void> setFocusGating({required bool enabled}) async {}
+
+  /// Selects how coalesced samples of [axis] are summarised.
+  Future<void> setAxisCoalescing(
+    GamepadAxis axis,
+    GamepadAxisCoalescing mode,
+  ) async {}
+
+  /// Bounds the delay native event batching may add before delivery.
+  Future<void> setDeliveryLatencyBounds({
+    required Duration min,
+    required Duration max,
+  }) async {}
+
   /// Releases native resources.
   Future<void> dispose() {
     throw UnimplementedError('dispose() has not been implemented.');
@@ -40,4 +91,49 @@ abstract class GamepadPlatform extends PlatformInterface {
 
   /// Resumes native gamepad polling after a [pause].
   Future<void> resume() async {}
+
+  /// Re-emits processed gamepad input through virtual system gamepads.
+  /// No-op on platforms without virtual device support.
+  Future<void> setForwarding({
+    required bool enabled,
+    bool grab = false,
+  }) async {}
+
+  /// Starts journaling processed events to a native file at [path].
+  /// No-op on platforms without a native journal.
+  Future<void> startJournal(String path) async {}
+
+  /// Stops journaling and flushes the journal file.
+  Future<void> stopJournal() async {}
+
+  /// Reads up to [maxEvents] events at or after [fromTimestamp]
+  /// (milliseconds since epoch) from the journal at [path], preceded by the
+  /// state of every pad connected at [fromTimestamp].
+  Future<List<GamepadEvent>> readJournal(
+    String path, {
+    int fromTimestamp = 0,
+    int maxEvents = 1000,
+  }) async =>
+      const [];
+
+  /// Writes recently recorded native input to a text file at [path].
+  /// No-op on platforms without a native flight recorder.
+  Future<void> dumpFlightRecorder(
+    String path, {
+    Duration window = const Duration(seconds: 30),
+  }) async {}
+
+  /// Replays a flight recorder dump through the native pipeline in
+  /// simulated time. Returns null on platforms without a native replay.
+  Future<GamepadReplayResult?> replayFlightRecord(
+    String path, {
+    int maxEvents = 1000,
+  }) async =>
+      null;
+
+  /// Enables or disables native trace points.
+  Future<void> setTracing(bool enabled) async {}
+
+  /// Writes recorded trace points to [path] as Chrome trace JSON.
+  Future<void> exportTrace(String path) async {}
 }
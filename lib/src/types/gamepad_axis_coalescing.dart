@@ -0,0 +1,22 @@
+/// How the axis samples coalesced into one [GamepadAxisEvent] are
+/// summarised.
+///
+/// Native code batches input and delivers only the newest value of each
+/// axis per batch. The other policies are computed natively from every raw
+/// sample, so a flick that peaks and returns between two deliveries is
+/// still visible. Enum values are declared in wire order.
+enum GamepadAxisCoalescing {
+  /// Only the newest value (the default).
+  latest,
+
+  /// Also reports the minimum and maximum seen, in
+  /// [GamepadAxisEvent.min] and [GamepadAxisEvent.max].
+  envelope,
+
+  /// Also reports the time-weighted mean, in [GamepadAxisEvent.average].
+  average,
+
+  /// Also reports the time integral of the value in axis-seconds, in
+  /// [GamepadAxisEvent.displacement].
+  displacement,
+}
@@ -0,0 +1,46 @@
+/// Charge status of a gamepad battery.
+enum GamepadBatteryStatus { unknown, charging, discharging, full, notCharging }
+
+/// Battery level and charge status of a gamepad.
+class GamepadBattery {
+  const GamepadBattery({
+    this.level,
+    this.status = GamepadBatteryStatus.unknown,
+  });
+
+  /// Charge in percent, if the driver reports it. Drivers that only report
+  /// a coarse level (critical, low, normal, high, full) give a
+  /// representative percentage for it.
+  final int? level;
+
+  final GamepadBatteryStatus status;
+
+  factory GamepadBattery.fromMap(Map<String, dynamic> map) {
+    return GamepadBattery(
+      level: map['level'] as int?,
+      status: statusFromName(map['status'] as String?),
+    );
+  }
+
+  static GamepadBatteryStatus statusFromName(String? name) =>
+      GamepadBatteryStatus.values.firstWhere(
+        (s) => s.name == name,
+        orElse: () => GamepadBatteryStatus.unknown,
+      );
+
+  Map<String, dynamic> toMap() => {'level': level, 'status': status.name};
+
+  @override
+  bool operator ==(Object other) =>
+      identical(this, other) ||
+      other is GamepadBattery &&
+          runtimeType == other.runtimeType &&
+          level == other.level &&
+          status == other.status;
+
+  @override
+  int get hashCode => Object.hash(level, status);
+
+  @override
+  String toString() => 'GamepadBattery(level: $level, status: ${status.name})';
+}
@@ -0,0 +1,121 @@
+import 'gamepad_axis.dart';
+import 'gamepad_button.dart';
+
+/// How a gamepad's triggers report.
+enum GamepadTriggerType {
+  /// No triggers.
+  none,
+
+  /// On/off trigger buttons.
+  digital,
+
+  /// Triggers with a travel range.
+  analog,
+}
+
+/// How a gamepad is connected.
+///
+/// Linux reports the kernel bus; Windows only knows wired or wireless.
+enum GamepadBus { usb, bluetooth, virtual, wired, wireless, unknown }
+
+/// What a gamepad can report, determined once when it connects.
+class GamepadCapabilities {
+  const GamepadCapabilities({
+    required this.buttons,
+    required this.axes,
+    this.triggers = GamepadTriggerType.none,
+    this.accelerometer = false,
+    this.gyroscope = false,
+    this.touchpad = false,
+    this.rumble = false,
+    this.leds = false,
+    this.bus = GamepadBus.unknown,
+    this.uniq,
+  });
+
+  /// Bitmap of the [GamepadButton]s the gamepad has (bit i = index i).
+  final int buttons;
+
+  /// Bitmap of the [GamepadAxis] values the gamepad has (bit i = index i).
+  final int axes;
+
+  final GamepadTriggerType triggers;
+  final bool accelerometer;
+  final bool gyroscope;
+  final bool touchpad;
+  final bool rumble;
+  final bool leds;
+  final GamepadBus bus;
+
+  /// Unique id reported by the driver (usually a MAC address or serial),
+  /// if any.
+  final String? uniq;
+
+  bool hasButton(GamepadButton button) => buttons & (1 << button.index) != 0;
+
+  bool hasAxis(GamepadAxis axis) => axes & (1 << axis.index) != 0;
+
+  factory GamepadCapabilities.fromMap(Map<String, dynamic> map) {
+    return GamepadCapabilities(
+      buttons: map['buttons'] as int? ?? 0,
+      axes: map['axes'] as int? ?? 0,
+      triggers: GamepadTriggerType.values.firstWhere(
+        (t) => t.name == map['triggers'],
+        orElse: () => GamepadTriggerType.none,
+      ),
+      accelerometer: map['accelerometer'] as bool? ?? false,
+      gyroscope: map['gyroscope'] as bool? ?? false,
+      touchpad: map['touchpad'] as bool? ?? false,
+      rumble: map['rumble'] as bool? ?? false,
+      leds: map['leds'] as bool? ?? false,
+      bus: GamepadBus.values.firstWhere(
+        (b) => b.name == map['bus'],
+        orElse: () => GamepadBus.unknown,
+      ),
+      uniq: map['uniq'] as String?,
+    );
+  }
+
+  Map<String, dynamic> toMap() {
+    return {
+      'buttons': buttons,
+      'axes': axes,
+      'triggers': triggers.name,
+      'accelerometer': accelerometer,
+      'gyroscope': gyroscope,
+      'touchpad': touchpad,
+      'rumble': rumble,
+      'leds': leds,
+      'bus': bus.name,
+      'uniq': uniq,
+    };
+  }
+
+  @override
+  bool operator ==(Object other) =>
+      identical(this, other) ||
+      other is GamepadCapabilities &&
+          runtimeType == other.runtimeType &&
+          buttons == other.buttons &&
+          axes == other.axes &&
+          triggers == other.triggers &&
+          accelerometer == other.accelerometer &&
+          gyroscope == other.gyroscope &&
+          touchpad == other.touchpad &&
+          rumble == other.rumble &&
+          leds == other.leds &&
+          bus == other.bus &&
+          uniq == other.uniq;
+
+  @override
+  int get hashCode => Object.hash(buttons, axes, triggers, accelerometer,
+      gyroscope, touchpad, rumble, leds, bus, uniq);
+
+  @override
+  String toString() =>
+      'GamepadCapabilities(buttons: 0x${buttons.toRadixString(16)}, '
+      'axes: 0x${axes.toRadixString(16)}, triggers: ${triggers.name}, '
+      'accelerometer: $accelerometer, gyroscope: $gyroscope, '
+      'touchpad: $touchpad, rumble: $rumble, leds: $leds, '
+      'bus: ${bus.name}, uniq: $uniq)';
+}
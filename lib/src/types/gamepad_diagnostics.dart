@@ -0,0 +1,154 @@
+/// Outcome of one native device probe.
+enum GamepadProbeOutcome {
+  attached,
+  openFailed,
+  evdevFailed,
+  notGamepad,
+
+  /// Probed, but gone or already attached by the time it was handed over.
+  dropped,
+}
+
+/// Where the time of one device probe went.
+///
+/// Points in time ([startedAt], [attachedAt], [firstEventAt]) are offsets
+/// from plugin registration.
+class GamepadProbeTiming {
+  const GamepadProbeTiming({
+    required this.path,
+    required this.outcome,
+    this.gamepadId,
+    required this.startedAt,
+    required this.open,
+    required this.evdevInit,
+    required this.classify,
+    required this.absInfo,
+    required this.handoff,
+    required this.attach,
+    this.attachedAt,
+    this.firstEventAt,
+  });
+
+  /// Device node, e.g. `/dev/input/event5`.
+  final String path;
+  final GamepadProbeOutcome outcome;
+
+  /// Identifier the gamepad was attached as, if it was.
+  final int? gamepadId;
+
+  final Duration startedAt;
+
+  /// Time spent in `open()`.
+  final Duration open;
+
+  /// Time spent in `libevdev_new_from_fd()`.
+  final Duration evdevInit;
+
+  /// Gamepad check plus capability and battery lookups.
+  final Duration classify;
+
+  /// Caching the axis ranges.
+  final Duration absInfo;
+
+  /// Wait between the probe finishing and the reader thread taking it.
+  final Duration handoff;
+
+  /// Setting up the device's input watch.
+  final Duration attach;
+
+  final Duration? attachedAt;
+
+  /// When the first button or axis event of the gamepad was delivered, if
+  /// one has been.
+  final Duration? firstEventAt;
+
+  /// Total probe and attach time.
+  Duration get total =>
+      open + evdevInit + classify + absInfo + handoff + attach;
+
+  factory GamepadProbeTiming.fromMap(Map<String, dynamic> map) {
+    Duration us(String key) => Duration(microseconds: map[key] as int);
+    Duration? optionalUs(String key) =>
+        map[key] == null ? null : Duration(microseconds: map[key] as int);
+    return GamepadProbeTiming(
+      path: map['path'] as String,
+      outcome: GamepadProbeOutcome.values.firstWhere(
+        (o) => o.name == map['outcome'],
+        orElse: () => GamepadProbeOutcome.dropped,
+      ),
+      gamepadId: map['id'] as int?,
+      startedAt: us('atUs'),
+      open: us('openUs'),
+      evdevInit: us('evdevInitUs'),
+      classify: us('classifyUs'),
+      absInfo: us('absInfoUs'),
+      handoff: us('handoffUs'),
+      attach: us('attachUs'),
+      attachedAt: optionalUs('attachedAtUs'),
+      firstEventAt: optionalUs('firstEventAtUs'),
+    );
+  }
+
+  @override
+  String toString() =>
+      'GamepadProbeTiming(path: $path, outcome: ${outcome.name}, '
+      'gamepadId: $gamepadId, total: $total, firstEventAt: $firstEventAt)';
+}
+
+/// Startup and hotplug timing breakdown of the native plugin.
+class GamepadDiagnostics {
+  const GamepadDiagnostics({
+    required this.registration,
+    required this.startedAt,
+    required this.start,
+    required this.scanStartedAt,
+    required this.scan,
+    required this.probes,
+    this.config,
+  });
+
+  /// Time plugin registration took, including [start].
+  final Duration registration;
+
+  /// When the device manager started, from plugin registration.
+  final Duration startedAt;
+
+  /// Time starting the device manager took, including [scan].
+  final Duration start;
+
+  final Duration scanStartedAt;
+
+  /// Time the initial synchronous scan of /dev/input took.
+  final Duration scan;
+
+  /// The most recent device probes, oldest first.
+  final List<GamepadProbeTiming> probes;
+
+  /// The pipeline configuration in effect: `version`, `path`,
+  /// `axisEpsilon`, `triggerEpsilon`, `stickDeadzone`, `triggerDeadzone`,
+  /// `dedupeButtons` and, when set, `minDrainMs` and `maxDrainMs`.
+  final Map<String, Object?>? config;
+
+  factory GamepadDiagnostics.fromMap(Map<String, dynamic> map) {
+    Duration us(String key) => Duration(microseconds: map[key] as int);
+    return GamepadDiagnostics(
+      registration: us('registrationUs'),
+      startedAt: us('startAtUs'),
+      start: us('startUs'),
+      scanStartedAt: us('scanAtUs'),
+      scan: us('scanUs'),
+      probes: (map['probes'] as List)
+          .map((m) =>
+              GamepadProbeTiming.fromMap(Map<String, dynamic>.from(m as Map)))
+          .toList(),
+      config: map['config'] == null
+          ? null
+          : Map<String, Object?>.from(map['config'] as Map),
+    );
+  }
+
+  @override
+  String toString() =>
+      'GamepadDiagnostics(registration: $registration, start: $start, '
+      'scan: $scan, probes: ${probes.length})';
+}
@@ -1,4 +1,8 @@
+import 'dart:typed_data';
+
 import 'gamepad_axis.dart';
+import 'gamepad_axis_coalescing.dart';
+import 'gamepad_battery.dart';
 import 'gamepad_button.dart';
 import 'gamepad_info.dart';
 
@@ -18,13 +22,17 @@ sealed class GamepadEvent {
   /// Deserializes a [GamepadEvent] from a fixed-position list.
   ///
   /// Wire format — element 0 is the type tag (int):
-  ///   0 = connection, 1 = button, 2 = axis.
+  ///   0 = connection, 1 = button, 2 = axis, 3 = pointer, 4 = battery,
+  ///   5 = raw batch.
   factory GamepadEvent.fromList(List list) {
     final type = list[0] as int;
     return switch (type) {
       0 => GamepadConnectionEvent.fromList(list),
       1 => GamepadButtonEvent.fromList(list),
       2 => GamepadAxisEvent.fromList(list),
+      3 => GamepadPointerEvent.fromList(list),
+      4 => GamepadBatteryEvent.fromList(list),
+      5 => GamepadRawEvent.fromList(list),
       _ => throw ArgumentError('Unknown gamepad event type: $type'),
     };
   }
@@ -37,21 +45,29 @@ class GamepadConnectionEvent extends GamepadEvent {
     required super.timestamp,
     required this.connected,
     required this.info,
+    this.reconnected = false,
   });
 
   /// Whether the gamepad was connected (`true`) or disconnected (`false`).
   final bool connected;
 
+  /// Whether a gamepad that was connected before came back under the same
+  /// [gamepadId], e.g. after a Bluetooth dropout. Only reported on Linux and
+  /// Windows.
+  final bool reconnected;
+
   /// Information about the gamepad.
   final GamepadInfo info;
 
-  /// Wire format: [0, gamepadId(int), timestamp, connected, name, vendorId, productId]
+  /// Wire format: [0, gamepadId(int), timestamp, connected, name, vendorId,
+  /// productId, reconnected?]
   factory GamepadConnectionEvent.fromList(List list) {
     final id = list[1] as int;
     return GamepadConnectionEvent(
       gamepadId: id,
       timestamp: list[2] as int,
       connected: list[3] as bool,
+      reconnected: list.length > 7 && list[7] == true,
       info: GamepadInfo(
         id: id,
         name: (list[4] as String?) ?? 'Unknown',
@@ -106,6 +122,10 @@ class GamepadAxisEvent extends GamepadEvent {
     required super.timestamp,
     required this.axis,
     required this.value,
+    this.min,
+    this.max,
+    this.average,
+    this.displacement,
   });
 
   /// The axis that changed value.
@@ -114,7 +134,24 @@ class GamepadAxisEvent extends GamepadEvent {
   /// Current axis value (-1.0 to 1.0).
   final double value;
 
+  /// Lowest and highest value since the previous event of this axis, with
+  /// [GamepadAxisCoalescing.envelope]; otherwise `null`.
+  final double? min;
+  final double? max;
+
+  /// Time-weighted mean since the previous event of this axis, with
+  /// [GamepadAxisCoalescing.average]; otherwise `null`.
+  final double? average;
+
+  /// Integral of the value over time, in axis-seconds, from the previous
+  /// event of this axis to this one, with
+  /// [GamepadAxisCoalescing.displacement]; otherwise `null`. The value is
+  /// held after this event, so add `value * elapsed` for the time since.
+  final double? displacement;
+
   /// Wire format: [2, gamepadId(int), timestamp, axisIndex, value]
+  /// followed, for coalescing policies other than latest, by
+  /// [min, max, average, displacement] (unused fields are null).
   factory GamepadAxisEvent.fromList(List list) {
     final axisIndex = list[3] as int;
     final axis = GamepadAxis.fromIndex(axisIndex);
@@ -126,6 +163,137 @@ class GamepadAxisEvent extends GamepadEvent {
       timestamp: list[2] as int,
       axis: axis,
       value: (list[4] as num).toDouble(),
+      min: list.length > 5 ? (list[5] as num?)?.toDouble() : null,
+      max: list.length > 6 ? (list[6] as num?)?.toDouble() : null,
+      average: list.length > 7 ? (list[7] as num?)?.toDouble() : null,
+      displacement: list.length > 8 ? (list[8] as num?)?.toDouble() : null,
+    );
+  }
+}
+
+/// Cursor motion from stick pointer emulation, accumulated since the
+/// previous pointer event of the same gamepad.
+///
+/// Only emitted while pointer emulation is enabled (see
+/// `Gamepad.setPointerEmulation`).
+class GamepadPointerEvent extends GamepadEvent {
+  const GamepadPointerEvent({
+    required super.gamepadId,
+    required super.timestamp,
+    required this.dx,
+    required this.dy,
+  });
+
+  /// Horizontal motion in logical pixels; positive is right.
+  final double dx;
+
+  /// Vertical motion in logical pixels; positive is down.
+  final double dy;
+
+  /// Wire format: [3, gamepadId(int), timestamp, dx, dy]
+  factory GamepadPointerEvent.fromList(List list) {
+    return GamepadPointerEvent(
+      gamepadId: list[1] as int,
+      timestamp: list[2] as int,
+      dx: (list[3] as num).toDouble(),
+      dy: (list[4] as num).toDouble(),
+    );
+  }
+}
+
+/// Fired when a gamepad's battery level or charge status changes.
+///
+/// Only sent on an actual change; the state at connection time is in
+/// [GamepadInfo.battery] from `Gamepad.listGamepads`.
+class GamepadBatteryEvent extends GamepadEvent {
+  const GamepadBatteryEvent({
+    required super.gamepadId,
+    required super.timestamp,
+    required this.battery,
+  });
+
+  final GamepadBattery battery;
+
+  /// Wire format: [4, gamepadId(int), timestamp, level(int?), status]
+  factory GamepadBatteryEvent.fromList(List list) {
+    return GamepadBatteryEvent(
+      gamepadId: list[1] as int,
+      timestamp: list[2] as int,
+      battery: GamepadBattery(
+        level: list[3] as int?,
+        status: GamepadBattery.statusFromName(list[4] as String?),
+      ),
+    );
+  }
+}
+
+/// One evdev event from raw passthrough.
+class RawEvdevEvent {
+  const RawEvdevEvent({
+    required this.type,
+    required this.code,
+    required this.value,
+    required this.timestampUs,
+  });
+
+  /// evdev event type (EV_KEY, EV_ABS, ...; see linux/input-event-codes.h).
+  final int type;
+
+  /// evdev event code, e.g. BTN_SOUTH or ABS_X.
+  final int code;
+
+  final int value;
+
+  /// Kernel timestamp in microseconds since epoch.
+  final int timestampUs;
+
+  @override
+  String toString() =>
+      'RawEvdevEvent(type: $type, code: $code, value: $value, '
+      'timestampUs: $timestampUs)';
+}
+
+/// A batch of evdev events of one gamepad, in kernel order, from raw
+/// passthrough (see `Gamepad.setRawPassthrough`).
+///
+/// Records are decoded from the packed native buffer on access, so
+/// skipping a batch costs nothing.
+class GamepadRawEvent extends GamepadEvent {
+  GamepadRawEvent({
+    required super.gamepadId,
+    required super.timestamp,
+    required this.bytes,
+  }) : _data = ByteData.sublistView(bytes);
+
+  /// Size of one packed record: int64 time (us), int32 value, uint16 type,
+  /// uint16 code, little-endian.
+  static const recordSize = 16;
+
+  /// The packed records.
+  final Uint8List bytes;
+  final ByteData _data;
+
+  int get length => bytes.lengthInBytes ~/ recordSize;
+
+  RawEvdevEvent operator [](int index) {
+    final offset = index * recordSize;
+    return RawEvdevEvent(
+      timestampUs: _data.getInt64(offset, Endian.little),
+      value: _data.getInt32(offset + 8, Endian.little),
+      type: _data.getUint16(offset + 12, Endian.little),
+      code: _data.getUint16(offset + 14, Endian.little),
+    );
+  }
+
+  Iterable<RawEvdevEvent> get records =>
+      Iterable.generate(length, (i) => this[i]);
+
+  /// Wire format: [5, gamepadId(int), timestamp, Uint8List records]
+  factory GamepadRawEvent.fromList(List list) {
+    return GamepadRawEvent(
+      gamepadId: list[1] as int,
+      timestamp: list[2] as int,
+      bytes: list[3] as Uint8List,
     );
   }
 }
@@ -1,3 +1,6 @@
+import 'gamepad_battery.dart';
+import 'gamepad_capabilities.dart';
+
 /// Information about a connected gamepad.
 class GamepadInfo {
   const GamepadInfo({
@@ -5,6 +8,9 @@ class GamepadInfo {
     required this.name,
     this.vendorId,
     this.productId,
+    this.reportRate,
+    this.capabilities,
+    this.battery,
   });
 
   /// Unique identifier for this gamepad within the current session.
@@ -19,12 +25,33 @@ class GamepadInfo {
   /// USB product ID, if available.
   final int? productId;
 
+  /// Measured input reports per second, if the platform measures it and
+  /// the gamepad has reported enough input (Linux).
+  final double? reportRate;
+
+  /// What the gamepad can report, if the platform provides it (Linux,
+  /// Windows).
+  final GamepadCapabilities? capabilities;
+
+  /// Battery state when the list was taken, for gamepads with a battery
+  /// (Linux, Windows). Changes arrive as [GamepadBatteryEvent]s.
+  final GamepadBattery? battery;
+
   factory GamepadInfo.fromMap(Map<String, dynamic> map) {
     return GamepadInfo(
       id: map['id'] as int,
       name: map['name'] as String,
       vendorId: map['vendorId'] as int?,
       productId: map['productId'] as int?,
+      reportRate: (map['reportRateHz'] as num?)?.toDouble(),
+      capabilities: map['capabilities'] == null
+          ? null
+          : GamepadCapabilities.fromMap(
+              Map<String, dynamic>.from(map['capabilities'] as Map)),
+      battery: map['battery'] == null
+          ? null
+          : GamepadBattery.fromMap(
+              Map<String, dynamic>.from(map['battery'] as Map)),
     );
   }
 
@@ -34,6 +61,9 @@ class GamepadInfo {
       'name': name,
       if (vendorId != null) 'vendorId': vendorId,
       if (productId != null) 'productId': productId,
+      if (reportRate != null) 'reportRateHz': reportRate,
+      if (capabilities != null) 'capabilities': capabilities!.toMap(),
+      if (battery != null) 'battery': battery!.toMap(),
     };
   }
 
@@ -45,12 +75,19 @@ class GamepadInfo {
           id == other.id &&
           name == other.name &&
           vendorId == other.vendorId &&
-          productId == other.productId;
+          productId == other.productId &&
+          reportRate == other.reportRate &&
+          capabilities == other.capabilities &&
+          battery == other.battery;
 
   @override
-  int get hashCode => Object.hash(id, name, vendorId, productId);
+  int get hashCode =>
+      Object.hash(
+          id, name, vendorId, productId, reportRate, capabilities, battery);
 
   @override
   String toString() =>
-      'GamepadInfo(id: $id, name: $name, vendorId: $vendorId, productId: $productId)';
+      'GamepadInfo(id: $id, name: $name, vendorId: $vendorId, '
+      'productId: $productId, reportRate: $reportRate, '
+      'capabilities: $capabilities, battery: $battery)';
 }
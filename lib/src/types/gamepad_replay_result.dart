@@ -0,0 +1,39 @@
+import 'gamepad_event.dart';
+
+/// Outcome of replaying a flight recorder dump in simulated time.
+class GamepadReplayResult {
+  const GamepadReplayResult({
+    required this.events,
+    required this.deliveredCount,
+    required this.recordedDuration,
+    required this.elapsed,
+  });
+
+  /// The first events the replayed pipeline delivered, in delivery order.
+  final List<GamepadEvent> events;
+
+  /// Total number of events delivered, including those not in [events].
+  final int deliveredCount;
+
+  /// Time span covered by the delivered events.
+  final Duration recordedDuration;
+
+  /// Wall time the replay took.
+  final Duration elapsed;
+
+  factory GamepadReplayResult.fromMap(Map<String, dynamic> map) {
+    return GamepadReplayResult(
+      events: (map['events'] as List)
+          .map((e) => GamepadEvent.fromList(e as List))
+          .toList(),
+      deliveredCount: map['delivered'] as int,
+      recordedDuration: Duration(milliseconds: map['recordedMs'] as int),
+      elapsed: Duration(microseconds: map['elapsedUs'] as int),
+    );
+  }
+
+  @override
+  String toString() =>
+      'GamepadReplayResult(deliveredCount: $deliveredCount, '
+      'recordedDuration: $recordedDuration, elapsed: $elapsed)';
+}
@@ -0,0 +1,92 @@
+import 'gamepad_axis.dart';
+
+/// An analog signal of a gamepad with its rate of change.
+class GamepadSignal {
+  const GamepadSignal({
+    required this.value,
+    required this.velocity,
+    required this.acceleration,
+    this.predicted,
+    this.confidence,
+  });
+
+  /// Newest raw value: -1.0 to 1.0 for axes, 0.0 to 1.0 for triggers.
+  final double value;
+
+  /// Filtered rate of change, in value units per second.
+  final double velocity;
+
+  /// Filtered rate of change of [velocity], in value units per second
+  /// squared.
+  final double acceleration;
+
+  /// [value] extrapolated to the presentation time passed to
+  /// `Gamepad.getGamepadState`; `null` when none was given.
+  final double? predicted;
+
+  /// How far [predicted] can be trusted, from 0 to 1. Drops with the
+  /// prediction horizon and with how erratic the signal has recently been.
+  final double? confidence;
+
+  @override
+  String toString() => 'GamepadSignal(value: $value, velocity: $velocity, '
+      'acceleration: $acceleration, predicted: $predicted, '
+      'confidence: $confidence)';
+}
+
+/// Snapshot of a gamepad's analog signals.
+///
+/// Derivatives are computed natively from every raw sample and its kernel
+/// timestamp, before throttling and coalescing, so they are far smoother
+/// than differences of delivered events.
+class GamepadState {
+  const GamepadState({
+    required this.gamepadId,
+    required this.timestamp,
+    required this.axes,
+    required this.leftTrigger,
+    required this.rightTrigger,
+  });
+
+  /// Identifier of the gamepad this state belongs to.
+  final int gamepadId;
+
+  /// When the snapshot was taken, in microseconds since epoch.
+  final int timestamp;
+
+  /// Stick axes, indexed by [GamepadAxis.index].
+  final List<GamepadSignal> axes;
+
+  final GamepadSignal leftTrigger;
+  final GamepadSignal rightTrigger;
+
+  /// Returns the signal of [axis].
+  GamepadSignal axis(GamepadAxis axis) => axes[axis.index];
+
+  factory GamepadState.fromMap(Map<String, dynamic> map) {
+    final values = (map['values'] as List).cast<double>();
+    final velocities = (map['velocities'] as List).cast<double>();
+    final accelerations = (map['accelerations'] as List).cast<double>();
+    final predicted = (map['predicted'] as List?)?.cast<double>();
+    final confidence = (map['confidence'] as List?)?.cast<double>();
+    GamepadSignal signal(int i) => GamepadSignal(
+          value: values[i],
+          velocity: velocities[i],
+          acceleration: accelerations[i],
+          predicted: predicted?[i],
+          confidence: confidence?[i],
+        );
+    final axisCount = GamepadAxis.values.length;
+    return GamepadState(
+      gamepadId: map['id'] as int,
+      timestamp: map['timestampUs'] as int,
+      axes: List.generate(axisCount, signal),
+      leftTrigger: signal(axisCount),
+      rightTrigger: signal(axisCount + 1),
+    );
+  }
+
+  @override
+  String toString() => 'GamepadState(gamepadId: $gamepadId, axes: $axes, '
+      'leftTrigger: $leftTrigger, rightTrigger: $rightTrigger)';
+}
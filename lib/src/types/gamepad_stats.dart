@@ -0,0 +1,61 @@
+/// Measured input report cadence of a connected gamepad.
+class GamepadStats {
+  const GamepadStats({
+    required this.gamepadId,
+    required this.reportRate,
+    required this.meanInterval,
+    required this.jitter,
+    required this.intervals,
+    required this.gaps,
+    required this.jitterHistogram,
+    required this.jitterBucketLimits,
+  });
+
+  /// Identifier of the gamepad these stats belong to.
+  final int gamepadId;
+
+  /// Reports per second derived from [meanInterval]; 0 until measured.
+  final double reportRate;
+
+  /// Running mean time between consecutive input reports.
+  final Duration meanInterval;
+
+  /// Running mean deviation of report intervals from [meanInterval].
+  final Duration jitter;
+
+  /// Number of report intervals measured.
+  final int intervals;
+
+  /// Number of intervals skipped as idle gaps (the pad had nothing to
+  /// report) rather than measured.
+  final int gaps;
+
+  /// Count of interval deviations per bucket. Bucket `i` holds deviations
+  /// up to `jitterBucketLimits[i]`; the last bucket holds everything above
+  /// the final limit.
+  final List<int> jitterHistogram;
+
+  /// Upper bounds of all but the last [jitterHistogram] bucket.
+  final List<Duration> jitterBucketLimits;
+
+  factory GamepadStats.fromMap(Map<String, dynamic> map) {
+    return GamepadStats(
+      gamepadId: map['id'] as int,
+      reportRate: (map['reportRateHz'] as num).toDouble(),
+      meanInterval:
+          Duration(microseconds: (map['meanIntervalUs'] as num).round()),
+      jitter: Duration(microseconds: (map['jitterUs'] as num).round()),
+      intervals: map['intervals'] as int,
+      gaps: map['gaps'] as int,
+      jitterHistogram: (map['jitterHistogram'] as List).cast<int>(),
+      jitterBucketLimits: (map['jitterBucketLimitsUs'] as List)
+          .map((us) => Duration(microseconds: us as int))
+          .toList(),
+    );
+  }
+
+  @override
+  String toString() =>
+      'GamepadStats(gamepadId: $gamepadId, reportRate: $reportRate, '
+      'jitter: $jitter, intervals: $intervals, gaps: $gaps)';
+}
@@ -2,6 +2,13 @@ export 'src/gamepad_api.dart';
 export 'src/platform_interface.dart';
 export 'src/method_channel.dart';
 export 'src/types/gamepad_event.dart';
+export 'src/types/gamepad_battery.dart';
+export 'src/types/gamepad_capabilities.dart';
+export 'src/types/gamepad_diagnostics.dart';
 export 'src/types/gamepad_info.dart';
+export 'src/types/gamepad_replay_result.dart';
+export 'src/types/gamepad_state.dart';
+export 'src/types/gamepad_stats.dart';
 export 'src/types/gamepad_button.dart';
 export 'src/types/gamepad_axis.dart';
+export 'src/types/gamepad_axis_coalescing.dart';
@@ -0,0 +1,136 @@
+#include "allocation_check.h"
+
+#include "allocation_counter.h"
+#include "button_mapping.h"
+#include "evdev_manager.h"
+
+#include <memory>
+
+namespace AllocationCheck {
+
+namespace {
+
+// Time for the worker to discover the injector pad.
+constexpr guint kSettleMs = 500;
+// Time for the last round of a phase to be read and drained.
+constexpr guint kDrainMs = 100;
+// Rounds run before counting starts.
+constexpr int kWarmupRounds = 200;
+// Interval between rounds; shorter than the drain interval, so drains see
+// coalesced axis events as well as single ones.
+constexpr guint kRoundMs = 2;
+// Every stick axis plus one button per round.
+constexpr int kEventsPerRound = ButtonMapping::kAxisCount + 1;
+
+// State of one check, owned by its pending GLib timeout.
+struct Run {
+  FlMethodCall* method_call;
+  EvdevManager* manager;
+  const char* source;
+  int rounds;
+  int round = 0;
+  int remaining = 0;
+  bool armed = false;
+};
+
+void InjectRound(Run* run) {
+  // Steps of 0.07 stay clear of the change throttle.
+  double value = (run->round * 7 % 180) / 100.0 - 0.9;
+  for (int axis = 0; axis < ButtonMapping::kAxisCount; ++axis) {
+    run->manager->Inject(2, axis, value);
+  }
+  run->manager->Inject(1, 0, run->round % 2 == 0 ? 1.0 : 0.0);
+  ++run->round;
+}
+
+FlValue* BuildReport(const Run& run) {
+  int64_t events = static_cast<int64_t>(run.rounds) * kEventsPerRound;
+  auto allocations = static_cast<int64_t>(AllocationCounter::Allocations());
+  FlValue* report = fl_value_new_map();
+  fl_value_set_string_take(report, "source",
+                           fl_value_new_string(run.source));
+  fl_value_set_string_take(report, "events", fl_value_new_int(events));
+  fl_value_set_string_take(report, "allocations",
+                           fl_value_new_int(allocations));
+  fl_value_set_string_take(
+      report, "bytes",
+      fl_value_new_int(static_cast<int64_t>(AllocationCounter::Bytes())));
+  fl_value_set_string_take(
+      report, "allocationsPerEvent",
+      fl_value_new_float(events > 0 ? static_cast<double>(allocations) /
+                                          events
+                                    : 0.0));
+  return report;
+}
+
+void Finish(Run* run) {
+  std::unique_ptr<Run> owned(run);
+  AllocationCounter::Disarm();
+  run->manager->StopInjector();
+  g_autoptr(FlValue) report = BuildReport(*run);
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond_success(run->method_call, report, &error)) {
+    g_warning("gamepad: failed to respond to allocation check: %s",
+              error->message);
+  }
+  g_object_unref(run->method_call);
+}
+
+gboolean OnPhaseEnd(gpointer user_data);
+
+gboolean OnRound(gpointer user_data) {
+  auto* run = static_cast<Run*>(user_data);
+  InjectRound(run);
+  if (--run->remaining > 0) return G_SOURCE_CONTINUE;
+  g_timeout_add(kDrainMs, OnPhaseEnd, run);
+  return G_SOURCE_REMOVE;
+}
+
+void StartPhase(Run* run, int rounds) {
+  run->remaining = rounds;
+  g_timeout_add(kRoundMs, OnRound, run);
+}
+
+// Everything injected so far has been delivered: start counting after the
+// warm-up, report after the counted rounds.
+gboolean OnPhaseEnd(gpointer user_data) {
+  auto* run = static_cast<Run*>(user_data);
+  if (run->armed || run->rounds <= 0) {
+    Finish(run);
+    return G_SOURCE_REMOVE;
+  }
+  run->armed = true;
+  AllocationCounter::Arm();
+  StartPhase(run, run->rounds);
+  return G_SOURCE_REMOVE;
+}
+
+gboolean OnSettled(gpointer user_data) {
+  StartPhase(static_cast<Run*>(user_data), kWarmupRounds);
+  return G_SOURCE_REMOVE;
+}
+
+}  // namespace
+
+void Start(FlMethodCall* method_call, EvdevManager* manager, int rounds) {
+  if (!AllocationCounter::Interposed()) {
+    g_autoptr(GError) error = nullptr;
+    if (!fl_method_call_respond_error(
+            method_call, "allocation_check_unavailable",
+            "The process has no counting malloc", nullptr,
+            &error)) {
+      g_warning("gamepad: failed to respond to allocation check: %s",
+                error->message);
+    }
+    return;
+  }
+
+  auto* run = new Run();
+  run->method_call = FL_METHOD_CALL(g_object_ref(method_call));
+  run->manager = manager;
+  run->source = manager->StartInjector();
+  run->rounds = rounds;
+  g_timeout_add(kSettleMs, OnSettled, run);
+}
+
+}  // namespace AllocationCheck
@@ -0,0 +1,34 @@
+#ifndef ALLOCATION_CHECK_H_
+#define ALLOCATION_CHECK_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+class EvdevManager;
+
+/// Counts the heap allocations of the steady-state input path.
+///
+/// A run starts the benchmark injector, gives the worker time to pick it
+/// up, and streams kWarmupRounds rounds of input so queues, per-device
+/// state and the encoder's messages reach their working size.  It then
+/// arms AllocationCounter for |rounds| more rounds, each a burst of stick
+/// and button changes injected from one main-loop tick, and keeps counting
+/// until they have been drained.  What is counted is every allocation the
+/// pipeline makes for them on the worker and main threads: reading,
+/// mapping, queueing, draining and encoding.  The engine's copy of each
+/// message is not.  The result map is sent as the response to
+/// |method_call|:
+///
+///   {source, events, allocations, bytes, allocationsPerEvent}
+///
+/// A steady-state path that allocates nothing reports 0 allocations.
+/// Responds with an "allocation_check_unavailable" error when the process
+/// has no counting malloc (see AllocationCounter).
+namespace AllocationCheck {
+
+/// Starts a check of |rounds| counted rounds.  |manager| must outlive the
+/// run.  Main thread only.
+void Start(FlMethodCall* method_call, EvdevManager* manager, int rounds);
+
+}  // namespace AllocationCheck
+
+#endif  // ALLOCATION_CHECK_H_
@@ -0,0 +1,84 @@
+#include "allocation_counter.h"
+
+#include <dlfcn.h>
+#include <stdlib.h>
+
+namespace AllocationCounter {
+
+namespace {
+
+// The interposer's entry points, or all null if the process has none.
+struct Counter {
+  bool (*count_allocations)(bool counting);
+  void (*arm)(bool armed);
+  uint64_t (*allocations)();
+  uint64_t (*allocated_bytes)();
+};
+
+template <typename Function>
+void Resolve(const char* name, Function* function) {
+  *function = reinterpret_cast<Function>(dlsym(RTLD_DEFAULT, name));
+}
+
+const Counter& GetCounter() {
+  static const Counter counter = []() {
+    Counter found;
+    Resolve("universal_gamepad_count_allocations", &found.count_allocations);
+    Resolve("universal_gamepad_arm_allocation_counter", &found.arm);
+    Resolve("universal_gamepad_allocations", &found.allocations);
+    Resolve("universal_gamepad_allocated_bytes", &found.allocated_bytes);
+    if (!found.count_allocations || !found.arm || !found.allocations ||
+        !found.allocated_bytes) {
+      return Counter{};
+    }
+    return found;
+  }();
+  return counter;
+}
+
+}  // namespace
+
+bool Interposed() {
+  const Counter& counter = GetCounter();
+  if (!counter.arm) return false;
+  // Through a volatile pointer, so the compiler can't drop the pair.
+  void* (*volatile allocate)(size_t) = malloc;
+  Scope scope(true);
+  counter.arm(true);
+  free(allocate(16));
+  bool counted = counter.allocations() != 0;
+  counter.arm(false);
+  return counted;
+}
+
+void Arm() {
+  const Counter& counter = GetCounter();
+  if (counter.arm) counter.arm(true);
+}
+
+void Disarm() {
+  const Counter& counter = GetCounter();
+  if (counter.arm) counter.arm(false);
+}
+
+uint64_t Allocations() {
+  const Counter& counter = GetCounter();
+  return counter.allocations ? counter.allocations() : 0;
+}
+
+uint64_t Bytes() {
+  const Counter& counter = GetCounter();
+  return counter.allocated_bytes ? counter.allocated_bytes() : 0;
+}
+
+Scope::Scope(bool counting) : saved_(false) {
+  const Counter& counter = GetCounter();
+  if (counter.count_allocations) saved_ = counter.count_allocations(counting);
+}
+
+Scope::~Scope() {
+  const Counter& counter = GetCounter();
+  if (counter.count_allocations) counter.count_allocations(saved_);
+}
+
+}  // namespace AllocationCounter
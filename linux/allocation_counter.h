@@ -0,0 +1,69 @@
+#ifndef ALLOCATION_COUNTER_H_
+#define ALLOCATION_COUNTER_H_
+
+#include <cstdint>
+
+/// Counts the heap allocations made inside marked scopes, for the example's
+/// allocation check (see AllocationCheck).
+///
+/// The plugin only reads the counts.  The counting malloc lives in the
+/// example runner (example/linux/runner/allocation_interposer.cc), which
+/// interposes the process's allocator and exports a small C interface that
+/// is looked up here with dlsym().  In any other process the lookups fail
+/// and everything below does nothing.
+///
+/// GAMEPAD_COUNT_ALLOCATIONS() marks the pipeline's own work on the worker
+/// and main threads; GAMEPAD_SKIP_ALLOCATIONS() leaves out a nested
+/// hand-off to the engine, which copies every message it is given.  Without
+/// UNIVERSAL_GAMEPAD_TEST_HOOKS both compile to nothing.
+namespace AllocationCounter {
+
+/// Whether the process has the example's counting malloc.  Checked with a
+/// probe allocation; false in apps using the plugin, or if another
+/// library's malloc comes first.
+bool Interposed();
+
+/// Clears the counts and starts counting.
+void Arm();
+
+/// Stops counting; the counts stay readable.
+void Disarm();
+
+/// Allocations counted since Arm(), and the bytes they asked for.
+uint64_t Allocations();
+uint64_t Bytes();
+
+/// Sets whether the calling thread's allocations count while alive.
+class Scope {
+ public:
+  explicit Scope(bool counting);
+  ~Scope();
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+ private:
+  bool saved_;
+};
+
+}  // namespace AllocationCounter
+
+#ifdef UNIVERSAL_GAMEPAD_TEST_HOOKS
+#define GAMEPAD_ALLOCATION_CONCAT_(a, b) a##b
+#define GAMEPAD_ALLOCATION_CONCAT(a, b) GAMEPAD_ALLOCATION_CONCAT_(a, b)
+#define GAMEPAD_COUNT_ALLOCATIONS()                                        \
+  AllocationCounter::Scope GAMEPAD_ALLOCATION_CONCAT(allocation_scope_, \
+                                                     __LINE__)(true)
+#define GAMEPAD_SKIP_ALLOCATIONS()                                         \
+  AllocationCounter::Scope GAMEPAD_ALLOCATION_CONCAT(allocation_scope_, \
+                                                     __LINE__)(false)
+#else
+#define GAMEPAD_COUNT_ALLOCATIONS() \
+  do {                              \
+  } while (false)
+#define GAMEPAD_SKIP_ALLOCATIONS() \
+  do {                             \
+  } while (false)
+#endif
+
+#endif  // ALLOCATION_COUNTER_H_
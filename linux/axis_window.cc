@@ -0,0 +1,35 @@
+#include "axis_window.h"
+
+#include <algorithm>
+
+void AxisWindow::Add(double value, int64_t time_us) {
+  if (!started_) {
+    started_ = true;
+    min_ = max_ = value;
+    displacement_ = 0.0;
+    start_us_ = time_us;
+  } else {
+    if (time_us > last_us_) {
+      displacement_ += last_value_ * (time_us - last_us_) / 1e6;
+    }
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+  }
+  last_value_ = value;
+  last_us_ = std::max(last_us_, time_us);
+}
+
+AxisWindow::Summary AxisWindow::Take(double value) {
+  if (!started_) return {value, value, 0.0, 0};
+
+  Summary summary{min_, max_, displacement_, last_us_ - start_us_};
+  min_ = max_ = last_value_;
+  displacement_ = 0.0;
+  start_us_ = last_us_;
+  return summary;
+}
+
+void AxisWindow::Reset() {
+  started_ = false;
+  last_us_ = 0;
+}
@@ -0,0 +1,59 @@
+#ifndef AXIS_WINDOW_H_
+#define AXIS_WINDOW_H_
+
+#include <cstdint>
+
+/// How the axis samples behind one delivered axis event are summarised.
+/// Wire values of setAxisCoalescing.
+enum class AxisCoalescing : uint8_t {
+  // Only the newest value (the default).
+  kLatest = 0,
+  // Newest value plus the minimum and maximum seen.
+  kEnvelope = 1,
+  // Newest value plus the time-weighted mean.
+  kAverage = 2,
+  // Newest value plus the time integral of the value, in axis-seconds.
+  kDisplacement = 3,
+};
+
+/// Summarises every raw sample of one axis between two queued events, so
+/// coalescing can drop intermediate events without losing a flick that
+/// peaks and returns between two deliveries.
+///
+/// The value is treated as held between samples.  A window spans from the
+/// sample of the previous queued event to the newest sample, so the
+/// displacements of consecutive events add up to the integral over the
+/// whole stream however the events were batched.
+///
+/// Worker thread only.
+class AxisWindow {
+ public:
+  struct Summary {
+    double min;
+    double max;
+    double displacement;
+    int64_t span_us;
+  };
+
+  /// Records a raw sample, including ones the change throttle drops.
+  void Add(double value, int64_t time_us);
+
+  /// Returns the summary since the previous Take() and starts the next
+  /// window at the newest sample.  Without any samples the summary covers
+  /// |value| alone.
+  Summary Take(double value);
+
+  /// Drops every sample so far; the next window starts at the next sample.
+  void Reset();
+
+ private:
+  bool started_ = false;
+  double min_ = 0.0;
+  double max_ = 0.0;
+  double displacement_ = 0.0;
+  double last_value_ = 0.0;
+  int64_t start_us_ = 0;
+  int64_t last_us_ = 0;
+};
+
+#endif  // AXIS_WINDOW_H_
@@ -0,0 +1,185 @@
+#include "battery_monitor.h"
+
+#include <dirent.h>
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <glib-unix.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+constexpr const char* kPowerSupplyDir = "/sys/class/power_supply/";
+
+// First line of |path| without the newline, or "" if it can't be read.
+std::string ReadLine(const std::string& path) {
+  FILE* file = fopen(path.c_str(), "r");
+  if (!file) return "";
+  char line[64];
+  std::string value;
+  if (fgets(line, sizeof(line), file)) {
+    value = line;
+    while (!value.empty() && (value.back() == '\n' || value.back() == ' ')) {
+      value.pop_back();
+    }
+  }
+  fclose(file);
+  return value;
+}
+
+int LevelFromCapacityLevel(const std::string& level) {
+  if (level == "Critical") return 5;
+  if (level == "Low") return 20;
+  if (level == "Normal") return 50;
+  if (level == "High") return 80;
+  if (level == "Full") return 100;
+  return -1;
+}
+
+BatteryState::Status StatusFromString(const std::string& status) {
+  if (status == "Charging") return BatteryState::Status::kCharging;
+  if (status == "Discharging") return BatteryState::Status::kDischarging;
+  if (status == "Full") return BatteryState::Status::kFull;
+  if (status == "Not charging") return BatteryState::Status::kNotCharging;
+  return BatteryState::Status::kUnknown;
+}
+
+}  // namespace
+
+const char* BatteryState::status_name() const {
+  switch (status) {
+    case Status::kCharging:
+      return "charging";
+    case Status::kDischarging:
+      return "discharging";
+    case Status::kFull:
+      return "full";
+    case Status::kNotCharging:
+      return "notCharging";
+    case Status::kUnknown:
+      break;
+  }
+  return "unknown";
+}
+
+FlValue* BatteryState::ToValue() const {
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(
+      map, "level", level >= 0 ? fl_value_new_int(level) : fl_value_new_null());
+  fl_value_set_string_take(map, "status", fl_value_new_string(status_name()));
+  return map;
+}
+
+namespace PowerSupply {
+
+std::string FindBattery(const char* devnode) {
+  const char* base = strrchr(devnode, '/');
+  base = base ? base + 1 : devnode;
+  // The supply hangs off the HID device, the parent of our input node.
+  std::string dir_path = std::string("/sys/class/input/") + base +
+                         "/device/device/power_supply";
+  DIR* dir = opendir(dir_path.c_str());
+  if (!dir) return "";
+  std::string name;
+  struct dirent* entry;
+  while (name.empty() && (entry = readdir(dir)) != nullptr) {
+    if (entry->d_name[0] != '.') name = entry->d_name;
+  }
+  closedir(dir);
+  return name;
+}
+
+bool Read(const std::string& name, BatteryState* state) {
+  std::string dir = kPowerSupplyDir + name + "/";
+  std::string status = ReadLine(dir + "status");
+  std::string capacity = ReadLine(dir + "capacity");
+  if (status.empty() && capacity.empty()) {
+    // Some drivers only have capacity_level; a missing status as well
+    // means the supply is gone.
+    std::string level = ReadLine(dir + "capacity_level");
+    if (level.empty()) return false;
+    state->level = LevelFromCapacityLevel(level);
+    state->status = BatteryState::Status::kUnknown;
+    return true;
+  }
+  state->level = capacity.empty()
+                     ? LevelFromCapacityLevel(ReadLine(dir + "capacity_level"))
+                     : atoi(capacity.c_str());
+  state->status = StatusFromString(status);
+  return true;
+}
+
+}  // namespace PowerSupply
+
+std::unique_ptr<UeventMonitor> UeventMonitor::Create(GMainContext* context,
+                                                     Callback callback) {
+  int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK,
+                  NETLINK_KOBJECT_UEVENT);
+  if (fd < 0) return nullptr;
+  struct sockaddr_nl addr = {};
+  addr.nl_family = AF_NETLINK;
+  // Group 1 carries the kernel's own uevents (udev rebroadcasts on 2).
+  addr.nl_groups = 1;
+  if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+    close(fd);
+    return nullptr;
+  }
+
+  std::unique_ptr<UeventMonitor> monitor(
+      new UeventMonitor(fd, std::move(callback)));
+  monitor->source_ = g_unix_fd_source_new(fd, G_IO_IN);
+  g_source_set_callback(monitor->source_,
+                        reinterpret_cast<GSourceFunc>(OnReadable),
+                        monitor.get(), nullptr);
+  g_source_attach(monitor->source_, context);
+  return monitor;
+}
+
+UeventMonitor::UeventMonitor(int fd, Callback callback)
+    : fd_(fd), callback_(std::move(callback)) {}
+
+UeventMonitor::~UeventMonitor() {
+  if (source_) {
+    g_source_destroy(source_);
+    g_source_unref(source_);
+  }
+  close(fd_);
+}
+
+// static
+gboolean UeventMonitor::OnReadable(gint fd, GIOCondition condition,
+                                   gpointer user_data) {
+  auto* self = static_cast<UeventMonitor*>(user_data);
+  char buffer[8192];
+  while (true) {
+    struct sockaddr_nl sender = {};
+    socklen_t sender_len = sizeof(sender);
+    ssize_t len =
+        recvfrom(fd, buffer, sizeof(buffer) - 1, 0,
+                 reinterpret_cast<struct sockaddr*>(&sender), &sender_len);
+    if (len <= 0) break;
+    // Only the kernel may speak on this group.
+    if (sender.nl_pid != 0) continue;
+    buffer[len] = '\0';
+
+    // "action@devpath\0KEY=value\0KEY=value\0..."
+    bool power_supply = false;
+    const char* devpath = nullptr;
+    for (const char* field = buffer + strlen(buffer) + 1;
+         field < buffer + len; field += strlen(field) + 1) {
+      if (strcmp(field, "SUBSYSTEM=power_supply") == 0) {
+        power_supply = true;
+      } else if (strncmp(field, "DEVPATH=", 8) == 0) {
+        devpath = field + 8;
+      }
+    }
+    if (!power_supply || !devpath) continue;
+    const char* name = strrchr(devpath, '/');
+    self->callback_(name ? name + 1 : devpath);
+  }
+  return G_SOURCE_CONTINUE;
+}
@@ -0,0 +1,77 @@
+#ifndef BATTERY_MONITOR_H_
+#define BATTERY_MONITOR_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+
+/// Charge state of a gamepad battery, read from its power_supply class
+/// device in sysfs.
+struct BatteryState {
+  enum class Status { kUnknown, kCharging, kDischarging, kFull, kNotCharging };
+
+  // Percent, or -1 if the driver reports neither capacity nor
+  // capacity_level.
+  int level = -1;
+  Status status = Status::kUnknown;
+
+  bool operator==(const BatteryState& other) const {
+    return level == other.level && status == other.status;
+  }
+  bool operator!=(const BatteryState& other) const {
+    return !(*this == other);
+  }
+
+  /// Wire name of |status|: "charging", "discharging", "full",
+  /// "notCharging" or "unknown".
+  const char* status_name() const;
+
+  /// Builds {level: int?, status} as used by listGamepads.
+  FlValue* ToValue() const;
+};
+
+/// Helpers for the power_supply class devices pad drivers register
+/// (hid-playstation, hid-nintendo, xpadneo, ...).  Blocking sysfs reads.
+namespace PowerSupply {
+
+/// Returns the power_supply name of the battery belonging to the HID device
+/// behind |devnode| (e.g. /dev/input/event5), or "" if it has none.
+std::string FindBattery(const char* devnode);
+
+/// Reads /sys/class/power_supply/|name|.  Drivers that only report a
+/// capacity_level get a representative percentage for it.  Returns false
+/// if the supply is gone.
+bool Read(const std::string& name, BatteryState* state);
+
+}  // namespace PowerSupply
+
+/// Listens for kernel power_supply uevents on a NETLINK_KOBJECT_UEVENT
+/// socket, dispatched on a GMainContext.
+class UeventMonitor {
+ public:
+  /// Called with the power_supply name of each changed supply.
+  using Callback = std::function<void(const std::string& name)>;
+
+  /// Returns null if the socket cannot be bound (no netlink uevents, e.g.
+  /// in some containers).
+  static std::unique_ptr<UeventMonitor> Create(GMainContext* context,
+                                               Callback callback);
+  ~UeventMonitor();
+
+  UeventMonitor(const UeventMonitor&) = delete;
+  UeventMonitor& operator=(const UeventMonitor&) = delete;
+
+ private:
+  UeventMonitor(int fd, Callback callback);
+
+  static gboolean OnReadable(gint fd, GIOCondition condition,
+                             gpointer user_data);
+
+  int fd_;
+  Callback callback_;
+  GSource* source_ = nullptr;
+};
+
+#endif  // BATTERY_MONITOR_H_
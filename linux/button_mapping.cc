@@ -68,4 +68,48 @@ bool IsHatAxis(uint16_t code) {
   return code == ABS_HAT0X || code == ABS_HAT0Y;
 }
 
+int W3CButtonToEvdev(int index) {
+  switch (index) {
+    case kButtonA:
+      return BTN_SOUTH;
+    case kButtonB:
+      return BTN_EAST;
+    case kButtonX:
+      return BTN_WEST;
+    case kButtonY:
+      return BTN_NORTH;
+    case kLeftShoulder:
+      return BTN_TL;
+    case kRightShoulder:
+      return BTN_TR;
+    case kBack:
+      return BTN_SELECT;
+    case kStart:
+      return BTN_START;
+    case kLeftStickButton:
+      return BTN_THUMBL;
+    case kRightStickButton:
+      return BTN_THUMBR;
+    case kGuide:
+      return BTN_MODE;
+    default:
+      return -1;
+  }
+}
+
+int W3CAxisToEvdev(int index) {
+  switch (index) {
+    case kLeftStickX:
+      return ABS_X;
+    case kLeftStickY:
+      return ABS_Y;
+    case kRightStickX:
+      return ABS_RX;
+    case kRightStickY:
+      return ABS_RY;
+    default:
+      return -1;
+  }
+}
+
 }  // namespace ButtonMapping
@@ -41,12 +41,14 @@ constexpr int kDpadDown = 13;
 constexpr int kDpadLeft = 14;
 constexpr int kDpadRight = 15;
 constexpr int kGuide = 16;
+constexpr int kButtonCount = 17;
 
 // W3C axis indices.
 constexpr int kLeftStickX = 0;
 constexpr int kLeftStickY = 1;
 constexpr int kRightStickX = 2;
 constexpr int kRightStickY = 3;
+constexpr int kAxisCount = 4;
 
 /// Maps an evdev button code to its W3C Standard Gamepad button index.
 /// Returns -1 if the button has no standard mapping.
@@ -66,6 +68,15 @@ int TriggerAxisToButtonIndex(uint16_t code);
 /// Returns true if the given evdev axis is a hat/d-pad axis.
 bool IsHatAxis(uint16_t code);
 
+/// Maps a W3C button index back to the evdev key code a standard pad would
+/// report. Returns -1 for buttons that are not keys on such a pad (the
+/// analog triggers and the d-pad, which are reported as axes).
+int W3CButtonToEvdev(int index);
+
+/// Maps a W3C stick axis index back to its evdev absolute axis code.
+/// Returns -1 if the index is out of range.
+int W3CAxisToEvdev(int index);
+
 }  // namespace ButtonMapping
 
 #endif  // BUTTON_MAPPING_H_
@@ -0,0 +1,181 @@
+#include "device_capabilities.h"
+
+#include <dirent.h>
+#include <linux/input.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "button_mapping.h"
+
+namespace {
+
+// Last whitespace-separated word of the first line of |path|, or "" if it
+// can't be read.  sysfs bitmaps are printed most significant word first,
+// so the last word holds the low bits.
+std::string ReadLastWord(const std::string& path) {
+  FILE* file = fopen(path.c_str(), "r");
+  if (!file) return "";
+  char line[512];
+  std::string word;
+  if (fgets(line, sizeof(line), file)) {
+    char* save = nullptr;
+    for (char* token = strtok_r(line, " \n", &save); token;
+         token = strtok_r(nullptr, " \n", &save)) {
+      word = token;
+    }
+  }
+  fclose(file);
+  return word;
+}
+
+bool HasBit(const std::string& path, int bit) {
+  std::string word = ReadLastWord(path);
+  if (word.empty()) return false;
+  unsigned long long bits = strtoull(word.c_str(), nullptr, 16);
+  return (bits >> bit) & 1ULL;
+}
+
+// Whether |dir| exists and has at least one entry.
+bool HasEntries(const std::string& dir) {
+  DIR* d = opendir(dir.c_str());
+  if (!d) return false;
+  bool found = false;
+  struct dirent* entry;
+  while (!found && (entry = readdir(d)) != nullptr) {
+    found = entry->d_name[0] != '.';
+  }
+  closedir(d);
+  return found;
+}
+
+// Looks at the other input nodes of the HID device behind |devnode| for
+// motion sensors and a touchpad, and at its LED class devices.
+void ProbeSiblings(const char* devnode, DeviceCapabilities& caps) {
+  const char* base = strrchr(devnode, '/');
+  base = base ? base + 1 : devnode;
+  // /sys/class/input/eventN/device is our inputM node; its parent is the
+  // HID device all sibling inputs hang off.
+  std::string parent = std::string("/sys/class/input/") + base +
+                       "/device/device";
+
+  if (HasEntries(parent + "/leds")) caps.leds = true;
+
+  std::string inputs = parent + "/input";
+  DIR* dir = opendir(inputs.c_str());
+  if (!dir) return;
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != nullptr) {
+    if (strncmp(entry->d_name, "input", 5) != 0) continue;
+    std::string node = inputs + "/" + entry->d_name;
+    std::string properties = node + "/properties";
+    if (HasBit(properties, INPUT_PROP_ACCELEROMETER)) {
+      caps.accelerometer = true;
+      // Gyro rates ride on the rotational axes of the same sensor node.
+      if (HasBit(node + "/capabilities/abs", ABS_RX)) caps.gyroscope = true;
+    } else if (HasBit(properties, INPUT_PROP_BUTTONPAD) ||
+               HasBit(node + "/capabilities/abs", ABS_MT_POSITION_X)) {
+      caps.touchpad = true;
+    }
+  }
+  closedir(dir);
+}
+
+}  // namespace
+
+DeviceCapabilities DeviceCapabilities::Probe(struct libevdev* dev,
+                                             const char* devnode) {
+  DeviceCapabilities caps;
+
+  for (int i = 0; i < ButtonMapping::kButtonCount; ++i) {
+    int code = ButtonMapping::W3CButtonToEvdev(i);
+    if (code >= 0 && libevdev_has_event_code(dev, EV_KEY, code)) {
+      caps.buttons |= 1u << i;
+    }
+  }
+  for (int i = 0; i < ButtonMapping::kAxisCount; ++i) {
+    if (libevdev_has_event_code(dev, EV_ABS, ButtonMapping::W3CAxisToEvdev(i))) {
+      caps.axes |= 1u << i;
+    }
+  }
+
+  // Analog triggers win over the digital trigger keys some drivers also
+  // report for them.
+  bool analog = false;
+  for (uint16_t code : {ABS_Z, ABS_RZ}) {
+    if (libevdev_has_event_code(dev, EV_ABS, code)) {
+      caps.buttons |= 1u << ButtonMapping::TriggerAxisToButtonIndex(code);
+      analog = true;
+    }
+  }
+  bool digital = false;
+  if (libevdev_has_event_code(dev, EV_KEY, BTN_TL2)) {
+    caps.buttons |= 1u << ButtonMapping::kLeftTrigger;
+    digital = true;
+  }
+  if (libevdev_has_event_code(dev, EV_KEY, BTN_TR2)) {
+    caps.buttons |= 1u << ButtonMapping::kRightTrigger;
+    digital = true;
+  }
+  caps.triggers = analog    ? Triggers::kAnalog
+                  : digital ? Triggers::kDigital
+                            : Triggers::kNone;
+
+  if (libevdev_has_event_code(dev, EV_ABS, ABS_HAT0X)) {
+    caps.buttons |= (1u << ButtonMapping::kDpadLeft) |
+                    (1u << ButtonMapping::kDpadRight);
+  }
+  if (libevdev_has_event_code(dev, EV_ABS, ABS_HAT0Y)) {
+    caps.buttons |= (1u << ButtonMapping::kDpadUp) |
+                    (1u << ButtonMapping::kDpadDown);
+  }
+
+  caps.rumble = libevdev_has_event_code(dev, EV_FF, FF_RUMBLE);
+  caps.leds = libevdev_has_event_type(dev, EV_LED);
+  caps.accelerometer =
+      libevdev_has_property(dev, INPUT_PROP_ACCELEROMETER);
+  caps.bus_type = static_cast<uint16_t>(libevdev_get_id_bustype(dev));
+  const char* uniq = libevdev_get_uniq(dev);
+  if (uniq) caps.uniq = uniq;
+
+  ProbeSiblings(devnode, caps);
+  return caps;
+}
+
+FlValue* DeviceCapabilities::ToValue() const {
+  const char* trigger_name = "none";
+  if (triggers == Triggers::kAnalog) {
+    trigger_name = "analog";
+  } else if (triggers == Triggers::kDigital) {
+    trigger_name = "digital";
+  }
+  const char* bus = "unknown";
+  switch (bus_type) {
+    case BUS_USB:
+      bus = "usb";
+      break;
+    case BUS_BLUETOOTH:
+      bus = "bluetooth";
+      break;
+    case BUS_VIRTUAL:
+      bus = "virtual";
+      break;
+  }
+
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "buttons", fl_value_new_int(buttons));
+  fl_value_set_string_take(map, "axes", fl_value_new_int(axes));
+  fl_value_set_string_take(map, "triggers", fl_value_new_string(trigger_name));
+  fl_value_set_string_take(map, "accelerometer",
+                           fl_value_new_bool(accelerometer));
+  fl_value_set_string_take(map, "gyroscope", fl_value_new_bool(gyroscope));
+  fl_value_set_string_take(map, "touchpad", fl_value_new_bool(touchpad));
+  fl_value_set_string_take(map, "rumble", fl_value_new_bool(rumble));
+  fl_value_set_string_take(map, "leds", fl_value_new_bool(leds));
+  fl_value_set_string_take(map, "bus", fl_value_new_string(bus));
+  fl_value_set_string_take(map, "uniq",
+                           uniq.empty() ? fl_value_new_null()
+                                        : fl_value_new_string(uniq.c_str()));
+  return map;
+}
@@ -0,0 +1,45 @@
+#ifndef DEVICE_CAPABILITIES_H_
+#define DEVICE_CAPABILITIES_H_
+
+#include <flutter_linux/flutter_linux.h>
+#include <libevdev/libevdev.h>
+
+#include <cstdint>
+#include <string>
+
+/// What a gamepad can report, worked out once when it is probed.
+///
+/// Buttons and axes are bitmaps over the W3C indices in ButtonMapping
+/// (bit i set = button/axis i can fire).  Motion sensors and touchpads are
+/// usually separate evdev nodes of the same HID device (hid-playstation,
+/// hid-nintendo), and LEDs usually live under /sys/class/leds, so those
+/// are looked up through the node's siblings in sysfs.
+struct DeviceCapabilities {
+  enum class Triggers { kNone, kDigital, kAnalog };
+
+  uint32_t buttons = 0;
+  uint32_t axes = 0;
+  Triggers triggers = Triggers::kNone;
+  bool accelerometer = false;
+  bool gyroscope = false;
+  bool touchpad = false;
+  bool rumble = false;
+  bool leds = false;
+  // BUS_* id from linux/input.h.
+  uint16_t bus_type = 0;
+  // Unique id (usually the MAC or serial); empty when the driver has none.
+  std::string uniq;
+
+  /// Inspects |dev|, opened from |devnode| (e.g. /dev/input/event5).
+  /// Blocking sysfs reads; call from the probe path.
+  static DeviceCapabilities Probe(struct libevdev* dev, const char* devnode);
+
+  /// Builds the "capabilities" map of listGamepads:
+  ///
+  ///   {buttons, axes, triggers: "none"|"digital"|"analog", accelerometer,
+  ///    gyroscope, touchpad, rumble, leds,
+  ///    bus: "usb"|"bluetooth"|"virtual"|"unknown", uniq: String?}
+  FlValue* ToValue() const;
+};
+
+#endif  // DEVICE_CAPABILITIES_H_
@@ -0,0 +1,76 @@
+#include "device_identity.h"
+
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// Levels above the input node to look for a USB serial: input -> HID ->
+// USB interface -> USB device.
+constexpr int kSerialSearchDepth = 4;
+
+// First line of |path| without the newline, or "" if it can't be read.
+std::string ReadLine(const std::string& path) {
+  FILE* file = fopen(path.c_str(), "r");
+  if (!file) return "";
+  char line[256];
+  std::string value;
+  if (fgets(line, sizeof(line), file)) {
+    value = line;
+    while (!value.empty() && (value.back() == '\n' || value.back() == ' ')) {
+      value.pop_back();
+    }
+  }
+  fclose(file);
+  return value;
+}
+
+std::string UsbSerial(const char* devnode) {
+  const char* base = strrchr(devnode, '/');
+  base = base ? base + 1 : devnode;
+  std::string link = std::string("/sys/class/input/") + base + "/device";
+  char resolved[PATH_MAX];
+  if (!realpath(link.c_str(), resolved)) return "";
+
+  std::string dir = resolved;
+  for (int level = 0; level < kSerialSearchDepth; ++level) {
+    std::string serial = ReadLine(dir + "/serial");
+    if (!serial.empty()) return serial;
+    size_t slash = dir.rfind('/');
+    if (slash == std::string::npos || slash == 0) break;
+    dir.resize(slash);
+  }
+  return "";
+}
+
+// Drivers without an address report all zeroes rather than nothing.
+bool IsPlaceholder(const char* uniq) {
+  return strspn(uniq, "0:") == strlen(uniq);
+}
+
+}  // namespace
+
+namespace DeviceIdentity {
+
+std::string Key(struct libevdev* dev, const char* devnode) {
+  char prefix[16];
+  snprintf(prefix, sizeof(prefix), "%04x:%04x:", libevdev_get_id_vendor(dev),
+           libevdev_get_id_product(dev));
+  // Sibling nodes of one controller share everything else.
+  const char* name = libevdev_get_name(dev);
+  std::string node = std::string("/") + (name ? name : "");
+
+  const char* uniq = libevdev_get_uniq(dev);
+  if (uniq && *uniq && !IsPlaceholder(uniq)) {
+    return prefix + std::string("uniq:") + uniq + node;
+  }
+  std::string serial = UsbSerial(devnode);
+  if (!serial.empty()) return prefix + std::string("serial:") + serial + node;
+  const char* phys = libevdev_get_phys(dev);
+  if (phys && *phys) return prefix + std::string("phys:") + phys + node;
+  return "";
+}
+
+}  // namespace DeviceIdentity
@@ -0,0 +1,27 @@
+#ifndef DEVICE_IDENTITY_H_
+#define DEVICE_IDENTITY_H_
+
+#include <libevdev/libevdev.h>
+
+#include <string>
+
+/// Identity of a physical gamepad that survives reconnects, so EvdevManager
+/// can hand a pad that drops out and comes back its previous id.
+///
+/// The key is the first of, qualified by vendor and product id:
+///   - uniq, usually the serial number or Bluetooth address;
+///   - the serial attribute of the USB device above the node in sysfs;
+///   - phys, which for USB names the port the pad is plugged into.
+///
+/// The evdev name is appended, because a controller's sibling nodes (the
+/// DualShock 4's "Motion Sensors" node, say) share all of the above and
+/// must not take each other's ids.
+namespace DeviceIdentity {
+
+/// Returns the identity key of the opened |dev| at |devnode|, or "" if it
+/// has nothing stable to go by.
+std::string Key(struct libevdev* dev, const char* devnode);
+
+}  // namespace DeviceIdentity
+
+#endif  // DEVICE_IDENTITY_H_
@@ -1,16 +1,25 @@
 #include "evdev_manager.h"
 
+#include "allocation_counter.h"
 #include "button_mapping.h"
+#include "trace_points.h"
 
-#include <chrono>
+#include <algorithm>
 #include <cmath>
+#include <csignal>
 #include <cstring>
 #include <dirent.h>
 #include <fcntl.h>
+#include <glib-unix.h>
+#include <sys/stat.h>
 #include <unistd.h>
-#include <unordered_set>
 
-EvdevManager::EvdevManager() = default;
+EvdevManager::EvdevManager(std::unique_ptr<PipelineClock> clock)
+    : clock_(clock ? std::move(clock)
+                   : std::make_unique<SystemPipelineClock>()) {
+  pending_events_.reserve(kInitialQueueCapacity);
+  drain_events_.reserve(kInitialQueueCapacity);
+}
 
 EvdevManager::~EvdevManager() { Stop(); }
 
@@ -18,23 +27,57 @@ EvdevManager::~EvdevManager() { Stop(); }
 // Public API (called from main thread)
 // ---------------------------------------------------------------------------
 
-void EvdevManager::Start(EventCallback callback) {
+void EvdevManager::Start(EventCallback callback,
+                         InputCallback input_callback) {
+  started_at_us_ = g_get_monotonic_time();
+  first_event_seen_.clear();
   {
     std::lock_guard<std::mutex> lock(mutex_);
     callback_ = std::move(callback);
+    input_callback_ = std::move(input_callback);
+    probe_log_.clear();
+  }
+
+  if (threading_mode_ == ThreadingMode::kInline) {
+    // Worker and probe work both run on the main context.
+    worker_context_ = g_main_context_ref(g_main_context_default());
+    probe_context_ = g_main_context_ref(worker_context_);
+  } else {
+    // Private GMainContext + GMainLoop for the worker and probe threads.
+    worker_context_ = g_main_context_new();
+    worker_loop_ = g_main_loop_new(worker_context_, FALSE);
+    probe_context_ = g_main_context_new();
+    probe_loop_ = g_main_loop_new(probe_context_, FALSE);
   }
 
-  // Create a private GMainContext + GMainLoop for the worker thread.
-  worker_context_ = g_main_context_new();
-  worker_loop_ = g_main_loop_new(worker_context_, FALSE);
+  metrics_ = {};
+  metrics_.session_start_us = clock_->NowMicros();
 
-  // Push our context as the thread-default so that g_file_monitor and
-  // g_source_attach use it rather than the global default.
+  // Load the config before any input is read, then watch it on the worker.
+  config_path_ = PipelineConfig::DefaultPath();
+  ReloadConfig();
+  ApplyPublishedConfig();
   g_main_context_push_thread_default(worker_context_);
+  GFile* config_file = g_file_new_for_path(config_path_.c_str());
+  config_monitor_ = g_file_monitor_file(config_file, G_FILE_MONITOR_NONE,
+                                        nullptr, nullptr);
+  g_object_unref(config_file);
+  if (config_monitor_) {
+    config_monitor_signal_id_ = g_signal_connect(
+        config_monitor_, "changed", G_CALLBACK(OnConfigChanged), this);
+  }
+  g_main_context_pop_thread_default(worker_context_);
 
+  // Neither thread runs yet, so devices present at startup are probed and
+  // attached right here; ListGamepads() sees them as soon as Start returns.
+  scan_at_us_ = g_get_monotonic_time();
   ScanDevices();
+  scan_us_ = g_get_monotonic_time() - scan_at_us_;
 
-  // Watch /dev/input/ for hotplug.
+  // Watch /dev/input/ for hotplug.  Push the probe context as the
+  // thread-default so that the monitor fires there rather than on the
+  // global default.
+  g_main_context_push_thread_default(probe_context_);
   GFile* dir = g_file_new_for_path("/dev/input");
   GError* error = nullptr;
   dir_monitor_ = g_file_monitor_directory(dir, G_FILE_MONITOR_NONE,
@@ -51,20 +94,55 @@ void EvdevManager::Start(EventCallback callback) {
     if (error) g_error_free(error);
   }
 
-  g_main_context_pop_thread_default(worker_context_);
+  g_main_context_pop_thread_default(probe_context_);
+
+  // Battery changes are picked up on the worker.
+  uevents_ = UeventMonitor::Create(
+      worker_context_,
+      [this](const std::string& name) { RefreshBatteries(name); });
+  if (!uevents_) {
+    battery_poll_ = g_timeout_source_new_seconds(kBatteryPollSeconds);
+    g_source_set_callback(battery_poll_, OnBatteryPoll, this, nullptr);
+    g_source_attach(battery_poll_, worker_context_);
+  }
 
   // Periodic timer on the main thread drains queued events.
   // No cross-thread g_idle_add / g_main_context_wakeup — the worker just
   // pushes to the queue and this timer picks them up at ~60 Hz.
-  drain_timer_ = g_timeout_source_new(16);
-  g_source_set_callback(drain_timer_, DrainEvents, this, nullptr);
-  g_source_attach(drain_timer_, nullptr);  // default (main) context
+  UpdateDrainTimer();
+
+  // SIGUSR2 dumps the flight recorder, so support can grab recent input
+  // from a running kiosk without any app involvement.
+  dump_signal_ = g_unix_signal_source_new(SIGUSR2);
+  g_source_set_callback(dump_signal_, OnDumpSignal, this, nullptr);
+  g_source_attach(dump_signal_, nullptr);
 
   // Start the worker thread — it will run worker_loop_.
-  worker_thread_ = g_thread_new("evdev-worker", ThreadFunc, this);
+  if (threading_mode_ == ThreadingMode::kThreaded) {
+    worker_thread_ = g_thread_new("evdev-worker", ThreadFunc, this);
+    probe_thread_ = g_thread_new("evdev-probe", ProbeThreadFunc, this);
+  }
+  start_us_ = g_get_monotonic_time() - started_at_us_;
 }
 
 void EvdevManager::Stop() {
+  if (burst_timer_id_) {
+    g_source_remove(burst_timer_id_);
+    burst_timer_id_ = 0;
+  }
+  burst_remaining_ = 0;
+  injector_pad_.reset();
+  direct_injector_ = false;
+
+  // Stop the probe thread first so it hands no more devices to the worker.
+  if (probe_loop_) {
+    g_main_loop_quit(probe_loop_);
+  }
+  if (probe_thread_) {
+    g_thread_join(probe_thread_);
+    probe_thread_ = nullptr;
+  }
+
   // Signal the worker loop to quit.
   if (worker_loop_) {
     g_main_loop_quit(worker_loop_);
@@ -74,7 +152,17 @@ void EvdevManager::Stop() {
     worker_thread_ = nullptr;
   }
 
-  // Now single-threaded — safe to clean up without locks.
+  // Now single-threaded — safe to clean up without locks.  Inline tasks
+  // left on the default context would outlive us; cancel them.
+  std::vector<GSource*> inline_tasks;
+  inline_tasks.swap(inline_tasks_);
+  for (GSource* task : inline_tasks) g_source_destroy(task);
+  uevents_.reset();
+  if (battery_poll_) {
+    g_source_destroy(battery_poll_);
+    g_source_unref(battery_poll_);
+    battery_poll_ = nullptr;
+  }
   if (dir_monitor_) {
     if (dir_monitor_signal_id_) {
       g_signal_handler_disconnect(dir_monitor_, dir_monitor_signal_id_);
@@ -84,17 +172,32 @@ void EvdevManager::Stop() {
     g_object_unref(dir_monitor_);
     dir_monitor_ = nullptr;
   }
+  if (config_monitor_) {
+    if (config_monitor_signal_id_) {
+      g_signal_handler_disconnect(config_monitor_, config_monitor_signal_id_);
+      config_monitor_signal_id_ = 0;
+    }
+    g_file_monitor_cancel(config_monitor_);
+    g_object_unref(config_monitor_);
+    config_monitor_ = nullptr;
+  }
 
   for (auto& [path, info] : devices_) {
     if (info.io_source) {
       g_source_destroy(info.io_source);
       g_source_unref(info.io_source);
     }
+    info.virtual_pad.reset();
     libevdev_free(info.evdev);
-    close(info.fd);
+    if (info.fd >= 0) close(info.fd);
+    recorder_.ForgetDevice(info.id);
+    if (!info.identity.empty()) ParkIdentity(info);
   }
   devices_.clear();
+  journal_.reset();
 
+  // Unreffing the worker context destroys any attach task still queued,
+  // which closes its probed device.
   if (worker_loop_) {
     g_main_loop_unref(worker_loop_);
     worker_loop_ = nullptr;
@@ -103,19 +206,55 @@ void EvdevManager::Stop() {
     g_main_context_unref(worker_context_);
     worker_context_ = nullptr;
   }
+  if (probe_loop_) {
+    g_main_loop_unref(probe_loop_);
+    probe_loop_ = nullptr;
+  }
+  if (probe_context_) {
+    g_main_context_unref(probe_context_);
+    probe_context_ = nullptr;
+  }
 
-  if (drain_timer_) {
-    g_source_destroy(drain_timer_);
-    g_source_unref(drain_timer_);
-    drain_timer_ = nullptr;
+  if (drain_timer_id_) {
+    clock_->RemoveTimer(drain_timer_id_);
+    drain_timer_id_ = 0;
+  }
+  if (metrics_timer_id_) {
+    clock_->RemoveTimer(metrics_timer_id_);
+    metrics_timer_id_ = 0;
+  }
+  // One last record, so the end of the session is in the ring.
+  WriteMetrics();
+  metrics_ring_.reset();
+  config_metrics_ring_.reset();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    published_metrics_ring_.reset();
+  }
+  metrics_interval_s_ = 0;
+  if (dump_signal_) {
+    g_source_destroy(dump_signal_);
+    g_source_unref(dump_signal_);
+    dump_signal_ = nullptr;
   }
 
   {
     std::lock_guard<std::mutex> lock(queue_mutex_);
-    for (FlValue* ev : pending_events_) {
-      fl_value_unref(ev);
+    for (const PendingEvent& ev : pending_events_) {
+      if (ev.connection) fl_value_unref(ev.connection);
     }
+    for (size_t i = drain_pos_; i < drain_events_.size(); ++i) {
+      if (drain_events_[i].connection) {
+        fl_value_unref(drain_events_[i].connection);
+      }
+    }
+    drain_events_.clear();
+    drain_pos_ = 0;
+    raw_batches_.clear();
+    drain_raw_.clear();
+    pointers_.clear();
     pending_events_.clear();
+    ++queue_batch_;
   }
   {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -137,6 +276,138 @@ FlValue* EvdevManager::ListGamepads() {
                              fl_value_new_int(info.vendor_id));
     fl_value_set_string_take(map, "productId",
                              fl_value_new_int(info.product_id));
+    if (info.report_rate && info.report_rate->intervals() > 0) {
+      fl_value_set_string_take(
+          map, "reportRateHz",
+          fl_value_new_float(info.report_rate->rate_hz()));
+    }
+    fl_value_set_string_take(map, "capabilities",
+                             info.capabilities.ToValue());
+    if (!info.battery.empty()) {
+      fl_value_set_string_take(map, "battery", info.battery_state.ToValue());
+    }
+    fl_value_append_take(list, map);
+  }
+
+  return list;
+}
+
+FlValue* EvdevManager::GetDiagnostics(int64_t origin_us) {
+  if (origin_us == 0) origin_us = started_at_us_;
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "startAtUs",
+                           fl_value_new_int(started_at_us_ - origin_us));
+  fl_value_set_string_take(map, "startUs", fl_value_new_int(start_us_));
+  fl_value_set_string_take(map, "scanAtUs",
+                           fl_value_new_int(scan_at_us_ - origin_us));
+  fl_value_set_string_take(map, "scanUs", fl_value_new_int(scan_us_));
+
+  FlValue* probes = fl_value_new_list();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const ProbeTiming& timing : probe_log_) {
+      fl_value_append_take(probes, timing.ToValue(origin_us));
+    }
+  }
+  fl_value_set_string_take(map, "probes", probes);
+
+  std::shared_ptr<const PipelineConfig> config;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config = published_config_;
+  }
+  if (config) fl_value_set_string_take(map, "config", config->ToValue());
+  return map;
+}
+
+FlValue* EvdevManager::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  FlValue* list = fl_value_new_list();
+
+  for (const auto& [path, info] : devices_) {
+    if (!info.report_rate) continue;
+    const ReportRateMeter& meter = *info.report_rate;
+    FlValue* map = fl_value_new_map();
+    fl_value_set_string_take(map, "id", fl_value_new_int(info.id));
+    fl_value_set_string_take(map, "reportRateHz",
+                             fl_value_new_float(meter.rate_hz()));
+    fl_value_set_string_take(map, "meanIntervalUs",
+                             fl_value_new_float(meter.mean_interval_us()));
+    fl_value_set_string_take(map, "jitterUs",
+                             fl_value_new_float(meter.jitter_us()));
+    fl_value_set_string_take(
+        map, "intervals",
+        fl_value_new_int(static_cast<int64_t>(meter.intervals())));
+    fl_value_set_string_take(
+        map, "gaps", fl_value_new_int(static_cast<int64_t>(meter.gaps())));
+
+    FlValue* histogram = fl_value_new_list();
+    FlValue* limits = fl_value_new_list();
+    for (int i = 0; i < ReportRateMeter::kBucketCount; ++i) {
+      fl_value_append_take(
+          histogram, fl_value_new_int(static_cast<int64_t>(meter.bucket(i))));
+      if (i < ReportRateMeter::kBucketCount - 1) {
+        fl_value_append_take(
+            limits, fl_value_new_int(ReportRateMeter::kBucketLimitsUs[i]));
+      }
+    }
+    fl_value_set_string_take(map, "jitterHistogram", histogram);
+    fl_value_set_string_take(map, "jitterBucketLimitsUs", limits);
+    fl_value_append_take(list, map);
+  }
+
+  return list;
+}
+
+static_assert(SignalDynamics::kTriggerChannel == ButtonMapping::kAxisCount,
+              "trigger channels follow the W3C axes");
+
+FlValue* EvdevManager::GetGamepadState(int64_t predict_to_us) {
+  int64_t now_us = clock_->NowMicros();
+  std::lock_guard<std::mutex> lock(mutex_);
+  FlValue* list = fl_value_new_list();
+
+  for (const auto& [path, info] : devices_) {
+    if (!info.dynamics) continue;
+    double values[SignalDynamics::kChannelCount];
+    double velocities[SignalDynamics::kChannelCount];
+    double accelerations[SignalDynamics::kChannelCount];
+    for (int i = 0; i < SignalDynamics::kChannelCount; ++i) {
+      SignalDynamics::State state = info.dynamics->Read(i, now_us);
+      values[i] = state.value;
+      velocities[i] = state.velocity;
+      accelerations[i] = state.acceleration;
+    }
+
+    FlValue* map = fl_value_new_map();
+    fl_value_set_string_take(map, "id", fl_value_new_int(info.id));
+    fl_value_set_string_take(map, "timestampUs", fl_value_new_int(now_us));
+    fl_value_set_string_take(
+        map, "values",
+        fl_value_new_float_list(values, SignalDynamics::kChannelCount));
+    fl_value_set_string_take(
+        map, "velocities",
+        fl_value_new_float_list(velocities, SignalDynamics::kChannelCount));
+    fl_value_set_string_take(
+        map, "accelerations",
+        fl_value_new_float_list(accelerations, SignalDynamics::kChannelCount));
+
+    if (predict_to_us != 0) {
+      double predicted[SignalDynamics::kChannelCount];
+      double confidence[SignalDynamics::kChannelCount];
+      for (int i = 0; i < SignalDynamics::kChannelCount; ++i) {
+        SignalDynamics::Prediction prediction =
+            info.dynamics->Predict(i, now_us, predict_to_us);
+        predicted[i] = prediction.value;
+        confidence[i] = prediction.confidence;
+      }
+      fl_value_set_string_take(
+          map, "predicted",
+          fl_value_new_float_list(predicted, SignalDynamics::kChannelCount));
+      fl_value_set_string_take(
+          map, "confidence",
+          fl_value_new_float_list(confidence, SignalDynamics::kChannelCount));
+    }
     fl_value_append_take(list, map);
   }
 
@@ -148,83 +419,728 @@ void EvdevManager::EmitExistingDevices() {
   if (!callback_) return;
 
   for (const auto& [path, info] : devices_) {
-    int64_t ts = NowMillis();
-    // Wire format: [0, gamepadId, timestamp, connected, name, vendorId, productId]
-    FlValue* event = fl_value_new_list();
-    fl_value_append_take(event, fl_value_new_int(0));
-    fl_value_append_take(event, fl_value_new_int(info.id));
-    fl_value_append_take(event, fl_value_new_int(ts));
-    fl_value_append_take(event, fl_value_new_bool(TRUE));
-    fl_value_append_take(event, fl_value_new_string(info.name.c_str()));
-    fl_value_append_take(event, fl_value_new_int(info.vendor_id));
-    fl_value_append_take(event, fl_value_new_int(info.product_id));
+    FlValue* event = NewConnectionEvent(info, true);
     callback_(event);
     fl_value_unref(event);
   }
 }
 
+void EvdevManager::SetForwarding(bool enabled, bool grab) {
+  RunOnWorker([this, enabled, grab]() {
+    forward_enabled_ = enabled;
+    forward_grab_ = grab;
+    for (auto& [path, info] : devices_) {
+      ApplyForwarding(info);
+    }
+  });
+}
+
+bool EvdevManager::StartJournal(const std::string& path) {
+  // Without a worker (e.g. after dispose) nothing would ever be recorded.
+  if (!worker_context_) return false;
+  std::shared_ptr<InputJournalWriter> journal =
+      InputJournalWriter::Open(path);
+  if (!journal) return false;
+  RunOnWorker([this, journal]() {
+    ReleaseJournal(std::move(journal_));
+    journal_ = journal;
+    // Record the pads that are already connected so the journal's first
+    // keyframe knows about them.
+    int64_t now_us = clock_->NowMicros();
+    for (const auto& [path, info] : devices_) {
+      journal_->Append({now_us, info.id, 0, 0, 1.0});
+      for (int i = 0; i < ButtonMapping::kButtonCount; ++i) {
+        journal_->Append(
+            {now_us, info.id, 1, static_cast<uint8_t>(i), info.buttons[i]});
+      }
+      for (int i = 0; i < ButtonMapping::kAxisCount; ++i) {
+        journal_->Append(
+            {now_us, info.id, 2, static_cast<uint8_t>(i), info.axes[i]});
+      }
+    }
+  });
+  return true;
+}
+
+void EvdevManager::StopJournal() {
+  RunOnWorker([this]() { ReleaseJournal(std::move(journal_)); });
+}
+
+void EvdevManager::ReleaseJournal(
+    std::shared_ptr<InputJournalWriter> journal) {
+  // Inline mode is already on the main thread.
+  if (!journal || threading_mode_ == ThreadingMode::kInline) return;
+  g_idle_add_full(
+      G_PRIORITY_DEFAULT_IDLE,
+      [](gpointer data) -> gboolean { return G_SOURCE_REMOVE; },
+      new std::shared_ptr<InputJournalWriter>(std::move(journal)),
+      [](gpointer data) {
+        delete static_cast<std::shared_ptr<InputJournalWriter>*>(data);
+      });
+}
+
+bool EvdevManager::DumpFlightRecorder(const std::string& path,
+                                      int64_t window_ms) {
+  return recorder_.Dump(path, window_ms * 1000, DumpSettings());
+}
+
 // ---------------------------------------------------------------------------
 // Worker thread
 // ---------------------------------------------------------------------------
 
 gpointer EvdevManager::ThreadFunc(gpointer user_data) {
   auto* self = static_cast<EvdevManager*>(user_data);
+  TracePoints::NameThread("evdev-worker");
   g_main_context_push_thread_default(self->worker_context_);
   g_main_loop_run(self->worker_loop_);
   g_main_context_pop_thread_default(self->worker_context_);
   return nullptr;
 }
 
+gpointer EvdevManager::ProbeThreadFunc(gpointer user_data) {
+  auto* self = static_cast<EvdevManager*>(user_data);
+  TracePoints::NameThread("evdev-probe");
+  g_main_context_push_thread_default(self->probe_context_);
+  g_main_loop_run(self->probe_loop_);
+  g_main_context_pop_thread_default(self->probe_context_);
+  return nullptr;
+}
+
 // ---------------------------------------------------------------------------
 // Event forwarding (worker → main thread)
 // ---------------------------------------------------------------------------
 
 void EvdevManager::ForwardEvent(FlValue* event) {
-  fl_value_ref(event);
+  GAMEPAD_TRACE_SCOPE("ForwardEvent");
+  int64_t gamepad_id = fl_value_get_int(fl_value_get_list_value(event, 1));
+  int64_t ts = fl_value_get_int(fl_value_get_list_value(event, 2));
+  if (threading_mode_ == ThreadingMode::kInline) {
+    DeliverNow(event);
+    NoteConnectionDelivered(event);
+    return;
+  }
   std::lock_guard<std::mutex> lock(queue_mutex_);
-  pending_events_.push_back(event);
+  pending_events_.push_back({0, static_cast<int>(gamepad_id), ts, 0, false,
+                             0.0, fl_value_ref(event), {}, 0.0});
+}
+
+void EvdevManager::DeliverNow(FlValue* event) {
+  EventCallback cb;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cb = callback_;
+  }
+  if (cb) cb(event);
+  // Inline mode only, so on the main thread.
+  ++metrics_.events_delivered;
+}
+
+void EvdevManager::DeliverInputNow(const InputWireEvent& event) {
+  EventCallback cb;
+  InputCallback input_cb;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cb = callback_;
+    input_cb = input_callback_;
+  }
+  DeliverInput(event, cb, input_cb);
+  ++metrics_.events_delivered;
+}
+
+// static
+void EvdevManager::DeliverInput(const InputWireEvent& event,
+                                const EventCallback& cb,
+                                const InputCallback& input_cb) {
+  if (input_cb) {
+    input_cb(event);
+  } else if (cb) {
+    FlValue* value = NewInputWireValue(event);
+    cb(value);
+    fl_value_unref(value);
+  }
+}
+
+void EvdevManager::ForwardInput(DeviceInfo& info, int type, int index,
+                                bool pressed, double value) {
+  GAMEPAD_TRACE_SCOPE("ForwardEvent");
+  // State-only tracking while gated; EmitStateSnapshot() catches up.
+  if (input_gated_.load(std::memory_order_relaxed)) return;
+  if (type == 1) {
+    info.delivered_buttons[index] = value;
+  } else {
+    info.delivered_axes[index] = value;
+  }
+
+  int64_t ts = NowMillis();
+  AxisWindow::Summary window{};
+  if (type == 2) window = info.axis_window[index].Take(value);
+
+  if (threading_mode_ == ThreadingMode::kInline) {
+    PendingEvent event{type, info.id, ts, index, pressed, value, nullptr,
+                       window, 0.0};
+    NoteDelivered(info.id);
+    DeliverInputNow(ToWire(
+        event, type == 2 ? axis_coalescing_[index] : AxisCoalescing::kLatest));
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  if (type == 2) {
+    // Coalesce axis events: only the latest value per (gamepad, axis) in a
+    // batch is delivered, at the position of the latest event.  Its window
+    // absorbs the one of the event it supersedes.
+    if (info.pending_axis_batch[index] == queue_batch_) {
+      PendingEvent& superseded = pending_events_[info.pending_axis[index]];
+      superseded.type = kDroppedEvent;
+      window.min = std::min(window.min, superseded.window.min);
+      window.max = std::max(window.max, superseded.window.max);
+      window.displacement += superseded.window.displacement;
+      window.span_us += superseded.window.span_us;
+    }
+    info.pending_axis[index] = pending_events_.size();
+    info.pending_axis_batch[index] = queue_batch_;
+  }
+  pending_events_.push_back(
+      {type, info.id, ts, index, pressed, value, nullptr, window, 0.0});
 }
 
 gboolean EvdevManager::DrainEvents(gpointer user_data) {
+  GAMEPAD_TRACE_SCOPE("DrainEvents");
+  GAMEPAD_COUNT_ALLOCATIONS();
   auto* self = static_cast<EvdevManager*>(user_data);
+  int64_t start_us = self->clock_->NowMicros();
+  int64_t lateness_us = start_us - self->next_drain_due_us_;
+  size_t delivered = self->Drain(start_us);
+  int64_t cost_us = self->clock_->NowMicros() - start_us;
+  self->recorder_.RecordDrain(start_us, lateness_us, cost_us);
+  self->FinishDrain(lateness_us, cost_us, delivered);
+  return G_SOURCE_CONTINUE;
+}
 
-  std::vector<FlValue*> events;
-  {
-    std::lock_guard<std::mutex> lock(self->queue_mutex_);
-    if (self->pending_events_.empty()) return G_SOURCE_CONTINUE;
-    events.swap(self->pending_events_);
-  }
-
-  // Coalesce axis events: keep only the latest per (gamepadId, axisIndex).
-  // Scan in reverse so the first occurrence we see is the newest.
-  // Wire format for axis: [2, gamepadId, timestamp, axisIndex, value]
-  std::unordered_set<uint64_t> seen_axes;
-  for (int i = static_cast<int>(events.size()) - 1; i >= 0; --i) {
-    FlValue* ev = events[i];
-    if (fl_value_get_length(ev) >= 5 &&
-        fl_value_get_int(fl_value_get_list_value(ev, 0)) == 2) {
-      int64_t gid = fl_value_get_int(fl_value_get_list_value(ev, 1));
-      int64_t axis = fl_value_get_int(fl_value_get_list_value(ev, 3));
-      uint64_t key = (static_cast<uint64_t>(gid) << 8) | static_cast<uint64_t>(axis);
-      if (!seen_axes.insert(key).second) {
-        fl_value_unref(ev);
-        events[i] = nullptr;
+size_t EvdevManager::Drain(int64_t start_us) {
+  next_drain_due_us_ =
+      start_us + static_cast<int64_t>(drain_interval_ms_) * 1000;
+  if (config_version_.load(std::memory_order_acquire) !=
+      applied_config_version_) {
+    ApplyPublishedConfig();
+  }
+
+  // A batch cut short by the delivery budget is finished before new events
+  // are taken, so ordering holds.  Swapping keeps both buffers' capacity,
+  // so steady-state draining never reallocates.
+  if (drain_pos_ == drain_events_.size()) {
+    drain_events_.clear();
+    drain_pos_ = 0;
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (pointer_enabled_.load(std::memory_order_relaxed)) {
+      QueuePointerMotion();
+    }
+    if (!pending_events_.empty()) {
+      drain_events_.swap(pending_events_);
+      ++queue_batch_;
+    }
+    drain_raw_.resize(raw_batches_.size());
+    for (size_t i = 0; i < raw_batches_.size(); ++i) {
+      RawBatch& batch = raw_batches_[i];
+      drain_raw_[i].gamepad_id = batch.gamepad_id;
+      drain_raw_[i].records.swap(batch.records);
+    }
+  }
+
+  size_t delivered = 0;
+  if (drain_pos_ < drain_events_.size()) {
+    EventCallback cb;
+    InputCallback input_cb;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      cb = callback_;
+      input_cb = input_callback_;
+    }
+
+    size_t end = drain_events_.size();
+    if (end - drain_pos_ > max_drain_batch_) {
+      end = drain_pos_ + max_drain_batch_;
+    }
+    for (; drain_pos_ < end; ++drain_pos_) {
+      const PendingEvent& ev = drain_events_[drain_pos_];
+      if (ev.type == kDroppedEvent) {
+        ++metrics_.events_coalesced;
+        continue;
+      }
+      ++metrics_.queue_latency[MetricsRing::Bucket(
+          start_us - ev.timestamp * 1000)];
+      ++delivered;
+      if (ev.connection) {
+        if (cb) cb(ev.connection);
+        NoteConnectionDelivered(ev.connection);
+        fl_value_unref(ev.connection);
+        continue;
       }
+      AxisCoalescing mode = ev.type == 2 ? axis_coalescing_[ev.index]
+                                         : AxisCoalescing::kLatest;
+      if (ev.type == 1 || ev.type == 2) NoteDelivered(ev.gamepad_id);
+      DeliverInput(ToWire(ev, mode), cb, input_cb);
     }
   }
 
-  EventCallback cb;
+  if (!drain_raw_.empty()) {
+    EventCallback cb;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      cb = callback_;
+    }
+    for (RawBatch& batch : drain_raw_) {
+      if (batch.records.empty()) continue;
+      FlValue* value = NewRawEvent(batch.gamepad_id, batch.records);
+      if (cb) cb(value);
+      fl_value_unref(value);
+      ++delivered;
+      ++metrics_.raw_batches;
+      batch.records.clear();
+    }
+  }
+
+  return delivered;
+}
+
+void EvdevManager::FinishDrain(int64_t lateness_us, int64_t cost_us,
+                               size_t delivered) {
+  ++metrics_.drain_ticks;
+  metrics_.events_delivered += delivered;
+  ++metrics_.drain_lateness[MetricsRing::Bucket(lateness_us)];
+  ++metrics_.drain_cost[MetricsRing::Bucket(cost_us)];
+  AdaptDelivery(lateness_us, cost_us, delivered);
+}
+
+void EvdevManager::ForwardRaw(DeviceInfo& info) {
+  if (threading_mode_ == ThreadingMode::kInline) {
+    FlValue* event = NewRawEvent(info.id, info.raw_records);
+    DeliverNow(event);
+    fl_value_unref(event);
+    info.raw_records.clear();
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  auto it = std::find_if(
+      raw_batches_.begin(), raw_batches_.end(),
+      [&info](const RawBatch& batch) { return batch.gamepad_id == info.id; });
+  if (it == raw_batches_.end()) {
+    raw_batches_.push_back({info.id, {}});
+    it = raw_batches_.end() - 1;
+  }
+  it->records.insert(it->records.end(), info.raw_records.begin(),
+                     info.raw_records.end());
+  info.raw_records.clear();
+}
+
+FlValue* EvdevManager::NewRawEvent(
+    int gamepad_id, const std::vector<RawInputRecord>& records) {
+  // Wire format: [5, gamepadId, timestamp, Uint8List of RawInputRecords]
+  FlValue* event = fl_value_new_list();
+  fl_value_append_take(event, fl_value_new_int(5));
+  fl_value_append_take(event, fl_value_new_int(gamepad_id));
+  fl_value_append_take(event, fl_value_new_int(NowMillis()));
+  fl_value_append_take(
+      event, fl_value_new_uint8_list(
+                 reinterpret_cast<const uint8_t*>(records.data()),
+                 records.size() * sizeof(RawInputRecord)));
+  return event;
+}
+
+bool EvdevManager::SetRawPassthrough(int gamepad_id, bool enabled) {
   {
-    std::lock_guard<std::mutex> lock(self->mutex_);
-    cb = self->callback_;
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool found = false;
+    for (const auto& [path, info] : devices_) {
+      if (info.id == gamepad_id) found = true;
+    }
+    if (!found) return false;
+  }
+  RunOnWorker([this, gamepad_id, enabled]() {
+    for (auto& [path, info] : devices_) {
+      if (info.id != gamepad_id) continue;
+      info.raw = enabled;
+      info.raw_records.clear();
+    }
+  });
+  return true;
+}
+
+void EvdevManager::QueuePointerMotion() {
+  int64_t now_us = clock_->NowMicros();
+  int64_t ts = NowMillis();
+  for (const auto& [id, pointer] : pointers_) {
+    double dx;
+    double dy;
+    if (!pointer->Take(now_us, pointer_settings_, &dx, &dy)) continue;
+    pending_events_.push_back({3, id, ts, 0, false, dx, nullptr, {}, dy});
+  }
+}
+
+void EvdevManager::SetPointerEmulation(bool enabled,
+                                       const PointerSettings& settings) {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    pointer_settings_ = settings;
+    pointer_settings_.deadzone = std::clamp(settings.deadzone, 0.0, 0.95);
+    if (enabled && !pointer_enabled_.load(std::memory_order_relaxed)) {
+      // Drop motion integrated from samples seen before a previous disable.
+      ResetPointerMotion();
+    }
+    pointer_enabled_.store(enabled, std::memory_order_relaxed);
   }
+  UpdateDrainTimer();
+}
+
+void EvdevManager::ResetPointerMotion() {
+  int64_t now_us = clock_->NowMicros();
+  double dx;
+  double dy;
+  for (const auto& [id, pointer] : pointers_) {
+    pointer->Take(now_us, pointer_settings_, &dx, &dy);
+  }
+}
 
-  for (FlValue* ev : events) {
-    if (!ev) continue;
-    if (cb) cb(ev);
-    fl_value_unref(ev);
+void EvdevManager::SetInputGated(bool gated) {
+  if (input_gated_.exchange(gated, std::memory_order_relaxed) == gated) {
+    return;
+  }
+  UpdateDrainTimer();
+  if (gated) return;
+
+  // Connection and battery events kept queuing while the timer was off;
+  // deliver them now rather than a tick from now.
+  if (drain_timer_id_ && threading_mode_ == ThreadingMode::kThreaded) {
+    DrainEvents(this);
   }
 
+  // The cursor must not jump by whatever the stick did while unfocused,
+  // and coalesced axis events must not summarise it either.
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    ResetPointerMotion();
+  }
+  RunOnWorker([this]() {
+    for (auto& [path, info] : devices_) {
+      for (AxisWindow& window : info.axis_window) window.Reset();
+    }
+    EmitStateSnapshot();
+  });
+}
+
+void EvdevManager::UpdateDrainTimer() {
+  // Inline mode delivers directly and only needs ticks for the pointer.
+  bool wanted = worker_context_ &&
+                !input_gated_.load(std::memory_order_relaxed) &&
+                (threading_mode_ == ThreadingMode::kThreaded ||
+                 pointer_enabled_.load(std::memory_order_relaxed));
+  if (wanted && !drain_timer_id_) {
+    ScheduleDrain(drain_interval_ms_);
+  } else if (!wanted && drain_timer_id_) {
+    clock_->RemoveTimer(drain_timer_id_);
+    drain_timer_id_ = 0;
+  }
+}
+
+void EvdevManager::SetThreadingMode(ThreadingMode mode) {
+  if (mode == threading_mode_) return;
+  if (!worker_context_) {
+    threading_mode_ = mode;
+    return;
+  }
+
+  EventCallback callback;
+  InputCallback input_callback;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callback = callback_;
+    input_callback = input_callback_;
+  }
+  Stop();
+  threading_mode_ = mode;
+  Start(std::move(callback), std::move(input_callback));
+}
+
+void EvdevManager::EmitStateSnapshot() {
+  for (auto& [path, info] : devices_) EmitStateDiff(info);
+}
+
+void EvdevManager::EmitStateDiff(DeviceInfo& info) {
+  for (int i = 0; i < ButtonMapping::kButtonCount; ++i) {
+    if (info.buttons[i] != info.delivered_buttons[i]) {
+      ForwardInput(info, 1, i, info.buttons[i] > 0.5, info.buttons[i]);
+    }
+  }
+  for (int i = 0; i < ButtonMapping::kAxisCount; ++i) {
+    if (info.axes[i] != info.delivered_axes[i]) {
+      ForwardInput(info, 2, i, false, info.axes[i]);
+    }
+  }
+}
+
+void EvdevManager::ScheduleDrain(guint interval_ms) {
+  drain_interval_ms_ = interval_ms;
+  drain_timer_id_ = clock_->AddTimer(interval_ms, DrainEvents, this);
+  next_drain_due_us_ =
+      clock_->NowMicros() + static_cast<int64_t>(interval_ms) * 1000;
+}
+
+void EvdevManager::RescheduleDrain(guint interval_ms) {
+  drain_interval_ms_ = interval_ms;
+  clock_->SetTimerInterval(drain_timer_id_, interval_ms);
+  next_drain_due_us_ =
+      clock_->NowMicros() + static_cast<int64_t>(interval_ms) * 1000;
+}
+
+void EvdevManager::AdaptDelivery(int64_t lateness_us, int64_t cost_us,
+                                 size_t delivered) {
+  auto interval_us = static_cast<int64_t>(drain_interval_ms_) * 1000;
+  int64_t now_us = clock_->NowMicros();
+  if (delivered > 0) {
+    double per_event = static_cast<double>(cost_us) / delivered;
+    event_cost_us_ = event_cost_us_ == 0.0
+                         ? per_event
+                         : event_cost_us_ + (per_event - event_cost_us_) / 8;
+    last_delivery_us_ = now_us;
+  }
+
+  // Late dispatch or expensive delivery means the UI thread is struggling;
+  // drain less often so each tick does more useful work per wakeup.
+  bool overloaded = lateness_us > interval_us / 2 ||
+                    cost_us > interval_us * kDeliveryCostShare;
+  load_factor_ = overloaded ? std::min(load_factor_ * 1.5, kMaxLoadFactor)
+                            : std::max(1.0, load_factor_ * 0.95);
+  if (overloaded) ++metrics_.overloaded_ticks;
+
+  if (event_cost_us_ > 0.0) {
+    auto budget = static_cast<size_t>(interval_us * kDeliveryCostShare /
+                                      event_cost_us_);
+    max_drain_batch_ = std::max(budget, kMinDrainBatch);
+  }
+
+  if (++ticks_since_rate_check_ >= kRateCheckTicks) {
+    ticks_since_rate_check_ = 0;
+    fastest_rate_hz_ = FastestReportRateHz();
+  }
+
+  // Drain at the fastest pad's cadence while input flows; idle at the
+  // upper bound.
+  double target_ms = max_drain_ms_;
+  if (now_us - last_delivery_us_ < kIdleAfterUs && fastest_rate_hz_ > 0.0) {
+    target_ms = 1000.0 / fastest_rate_hz_;
+  }
+  target_ms *= load_factor_;
+  auto next_ms = static_cast<guint>(std::lround(
+      std::clamp(target_ms, static_cast<double>(min_drain_ms_),
+                 static_cast<double>(max_drain_ms_))));
+  if (next_ms != drain_interval_ms_) RescheduleDrain(next_ms);
+}
+
+double EvdevManager::FastestReportRateHz() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  double fastest = 0.0;
+  for (const auto& [path, info] : devices_) {
+    if (info.report_rate) {
+      fastest = std::max(fastest, info.report_rate->rate_hz());
+    }
+  }
+  return fastest;
+}
+
+void EvdevManager::SetAxisCoalescing(int index, AxisCoalescing mode) {
+  if (index < 0 || index >= ButtonMapping::kAxisCount) return;
+  axis_coalescing_[index] = mode;
+}
+
+void EvdevManager::SetDeliveryLatencyBounds(guint min_ms, guint max_ms) {
+  min_drain_ms_ = std::max(min_ms, 1u);
+  max_drain_ms_ = std::max(max_ms, min_drain_ms_);
+  guint interval =
+      std::clamp(drain_interval_ms_, min_drain_ms_, max_drain_ms_);
+  if (drain_timer_id_ && interval != drain_interval_ms_) {
+    RescheduleDrain(interval);
+  } else {
+    drain_interval_ms_ = interval;
+  }
+}
+
+void EvdevManager::ReloadConfig() {
+  auto next = std::make_shared<PipelineConfig>();
+  std::string error;
+  if (!PipelineConfig::Load(config_path_, next.get(), &error)) {
+    g_warning("gamepad: ignoring config %s: %s", config_path_.c_str(),
+              error.c_str());
+    return;
+  }
+  next->version = config_->version + 1;
+  OpenMetricsRing(*next);
+  config_ = next;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    published_config_ = next;
+    published_metrics_ring_ = config_metrics_ring_;
+  }
+  config_version_.store(next->version, std::memory_order_release);
+  // Inline mode has no drain tick to pick it up, and is on the main thread.
+  if (threading_mode_ == ThreadingMode::kInline) ApplyPublishedConfig();
+}
+
+void EvdevManager::OpenMetricsRing(const PipelineConfig& config) {
+  bool unchanged = config_metrics_ring_
+                       ? config_metrics_ring_->path() == config.metrics_file &&
+                             config_metrics_ring_->slot_count() ==
+                                 config.metrics_slots
+                       : config.metrics_file.empty();
+  if (unchanged) return;
+  config_metrics_ring_.reset();
+  if (config.metrics_file.empty()) return;
+  config_metrics_ring_ =
+      MetricsRing::Open(config.metrics_file, config.metrics_slots);
+  if (!config_metrics_ring_) {
+    g_warning("gamepad: cannot map metrics file %s",
+              config.metrics_file.c_str());
+  }
+}
+
+void EvdevManager::ApplyPublishedConfig() {
+  std::shared_ptr<const PipelineConfig> config;
+  std::shared_ptr<MetricsRing> ring;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config = published_config_;
+    ring = published_metrics_ring_;
+  }
+  if (!config) return;
+  applied_config_version_ = config->version;
+  // Only the bounds change here; the next AdaptDelivery() clamps the
+  // running interval to them.
+  if (config->min_drain_ms) min_drain_ms_ = config->min_drain_ms;
+  if (config->max_drain_ms) max_drain_ms_ = config->max_drain_ms;
+  max_drain_ms_ = std::max(max_drain_ms_, min_drain_ms_);
+  ApplyMetricsConfig(*config, std::move(ring));
+}
+
+void EvdevManager::ApplyMetricsConfig(const PipelineConfig& config,
+                                      std::shared_ptr<MetricsRing> ring) {
+  metrics_ring_ = std::move(ring);
+
+  guint interval_s = metrics_ring_ ? config.metrics_interval_s : 0;
+  if (interval_s == metrics_interval_s_) return;
+  if (metrics_timer_id_) {
+    clock_->RemoveTimer(metrics_timer_id_);
+    metrics_timer_id_ = 0;
+  }
+  metrics_interval_s_ = interval_s;
+  if (interval_s) {
+    metrics_timer_id_ =
+        clock_->AddTimer(interval_s * 1000, OnMetricsTick, this);
+  }
+}
+
+gboolean EvdevManager::OnMetricsTick(gpointer user_data) {
+  static_cast<EvdevManager*>(user_data)->WriteMetrics();
+  return G_SOURCE_CONTINUE;
+}
+
+void EvdevManager::WriteMetrics() {
+  if (!metrics_ring_) return;
+  GAMEPAD_TRACE_SCOPE("WriteMetrics");
+  metrics_.wall_time_us = clock_->NowMicros();
+  metrics_.monotonic_us = g_get_monotonic_time();
+  metrics_.config_version = applied_config_version_;
+  metrics_.drain_interval_ms = drain_interval_ms_;
+  metrics_.load_factor = static_cast<float>(load_factor_);
+  metrics_.event_cost_us = static_cast<float>(event_cost_us_);
+
+  int slot = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    metrics_.device_count = static_cast<uint32_t>(devices_.size());
+    for (const auto& [path, info] : devices_) {
+      if (!info.report_rate || slot == MetricsRing::kMaxDevices) continue;
+      const ReportRateMeter& meter = *info.report_rate;
+      MetricsDevice& device = metrics_.devices[slot++];
+      device.gamepad_id = info.id;
+      device.report_rate_hz = static_cast<float>(meter.rate_hz());
+      device.jitter_us = static_cast<float>(meter.jitter_us());
+      device.intervals = meter.intervals();
+      device.gaps = meter.gaps();
+      for (int i = 0; i < ReportRateMeter::kBucketCount; ++i) {
+        device.jitter_buckets[i] = meter.bucket(i);
+      }
+    }
+  }
+  for (; slot < MetricsRing::kMaxDevices; ++slot) {
+    metrics_.devices[slot] = {};
+    metrics_.devices[slot].gamepad_id = -1;
+  }
+  metrics_ring_->Append(metrics_);
+}
+
+void EvdevManager::OnConfigChanged(GFileMonitor* monitor, GFile* file,
+                                   GFile* other,
+                                   GFileMonitorEvent event_type,
+                                   gpointer user_data) {
+  // Worker thread.  Editors save in place or by renaming over the file.
+  switch (event_type) {
+    case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+    case G_FILE_MONITOR_EVENT_CREATED:
+    case G_FILE_MONITOR_EVENT_DELETED:
+    case G_FILE_MONITOR_EVENT_MOVED_IN:
+    case G_FILE_MONITOR_EVENT_RENAMED:
+      static_cast<EvdevManager*>(user_data)->ReloadConfig();
+      break;
+    default:
+      break;
+  }
+}
+
+void EvdevManager::RefreshBatteries(const std::string& changed) {
+  for (auto& [path, info] : devices_) {
+    std::string battery = info.battery;
+    if (battery.empty()) {
+      // The supply may have been registered after the input node.
+      battery = PowerSupply::FindBattery(path.c_str());
+      if (battery.empty()) continue;
+    } else if (!changed.empty() && battery != changed) {
+      continue;
+    }
+
+    BatteryState state;
+    bool present = PowerSupply::Read(battery, &state);
+    if (!present) battery.clear();
+    bool changed_state = present && state != info.battery_state;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      info.battery = battery;
+      if (present) info.battery_state = state;
+    }
+    if (!changed_state) continue;
+
+    FlValue* event = NewBatteryEvent(info);
+    ForwardEvent(event);
+    fl_value_unref(event);
+  }
+}
+
+gboolean EvdevManager::OnBatteryPoll(gpointer user_data) {
+  static_cast<EvdevManager*>(user_data)->RefreshBatteries("");
+  return G_SOURCE_CONTINUE;
+}
+
+gboolean EvdevManager::OnDumpSignal(gpointer user_data) {
+  auto* self = static_cast<EvdevManager*>(user_data);
+  g_autofree gchar* name = g_strdup_printf(
+      "universal_gamepad-flight-%d-%lld.txt", static_cast<int>(getpid()),
+      static_cast<long long>(self->NowMillis()));
+  g_autofree gchar* path = g_build_filename(g_get_tmp_dir(), name, nullptr);
+  if (self->recorder_.Dump(path, kSignalDumpWindowMs * 1000,
+                           self->DumpSettings())) {
+    g_message("gamepad: flight recorder dumped to %s", path);
+  } else {
+    g_warning("gamepad: failed to dump flight recorder to %s", path);
+  }
   return G_SOURCE_CONTINUE;
 }
 
@@ -232,12 +1148,10 @@ gboolean EvdevManager::DrainEvents(gpointer user_data) {
 // Private helpers
 // ---------------------------------------------------------------------------
 
-int64_t EvdevManager::NowMillis() {
-  auto now = std::chrono::system_clock::now();
-  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                now.time_since_epoch())
-                .count();
-  return static_cast<int64_t>(ms);
+void EvdevManager::ResetThrottle(DeviceInfo& info) {
+  // Initialize last-emitted values to NaN so the first event always fires.
+  for (int i = 0; i < 4; ++i) info.last_axis[i] = NAN;
+  for (int i = 0; i < 2; ++i) info.last_trigger[i] = NAN;
 }
 
 bool EvdevManager::IsGamepad(struct libevdev* dev) {
@@ -268,41 +1182,83 @@ void EvdevManager::ScanDevices() {
   closedir(dir);
 }
 
+EvdevManager::ProbedDevice::~ProbedDevice() {
+  libevdev_free(info.evdev);
+  if (info.fd >= 0) close(info.fd);
+}
+
 void EvdevManager::AddDevice(const char* path) {
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (devices_.count(path)) return;
-  }
+  std::unique_ptr<ProbedDevice> probed = ProbeDevice(path);
+  if (probed) AttachDevice(*probed);
+}
+
+std::unique_ptr<EvdevManager::ProbedDevice> EvdevManager::ProbeDevice(
+    const char* path) {
+  // No check against devices_ here: a pad that reconnects onto the same
+  // node is probed while the worker may still hold the old entry.
+  // AttachDevice() sorts the two apart.
+  ProbeTiming timing;
+  timing.path = path;
+  timing.started_at_us = g_get_monotonic_time();
+  int64_t lap_us = timing.started_at_us;
+  auto lap = [&lap_us]() {
+    int64_t now_us = g_get_monotonic_time();
+    int64_t elapsed_us = now_us - lap_us;
+    lap_us = now_us;
+    return elapsed_us;
+  };
 
   int fd = open(path, O_RDONLY | O_NONBLOCK);
-  if (fd < 0) return;
+  timing.open_us = lap();
+  if (fd < 0) {
+    timing.outcome = ProbeTiming::Outcome::kOpenFailed;
+    LogProbe(timing);
+    return nullptr;
+  }
 
   struct libevdev* dev = nullptr;
   int rc = libevdev_new_from_fd(fd, &dev);
+  timing.evdev_init_us = lap();
   if (rc < 0) {
     close(fd);
-    return;
+    timing.outcome = ProbeTiming::Outcome::kEvdevFailed;
+    LogProbe(timing);
+    return nullptr;
   }
 
-  if (!IsGamepad(dev)) {
+  // Skip our own forwarding devices and anything that is not a gamepad.
+  const char* phys = libevdev_get_phys(dev);
+  if ((phys && strcmp(phys, VirtualGamepad::kPhys) == 0) || !IsGamepad(dev)) {
     libevdev_free(dev);
     close(fd);
-    return;
+    timing.classify_us = lap();
+    timing.outcome = ProbeTiming::Outcome::kNotGamepad;
+    LogProbe(timing);
+    return nullptr;
   }
 
-  DeviceInfo info{};
+  auto probed = std::make_unique<ProbedDevice>();
+  probed->path = path;
+  DeviceInfo& info = probed->info;
   info.fd = fd;
   info.evdev = dev;
-  info.id = next_id_++;
 
   const char* name = libevdev_get_name(dev);
   info.name = name ? name : "Unknown Gamepad";
   info.vendor_id = static_cast<uint16_t>(libevdev_get_id_vendor(dev));
   info.product_id = static_cast<uint16_t>(libevdev_get_id_product(dev));
+  info.capabilities = DeviceCapabilities::Probe(dev, path);
+  info.identity = DeviceIdentity::Key(dev, path);
+  info.battery = PowerSupply::FindBattery(path);
+  if (!info.battery.empty()) {
+    PowerSupply::Read(info.battery, &info.battery_state);
+  }
+  info.report_rate = std::make_unique<ReportRateMeter>();
+  info.dynamics = std::make_unique<SignalDynamics>();
+  info.pointer = std::make_unique<PointerEmulator>();
 
-  // Initialize last-emitted values to NaN so the first event always fires.
-  for (int i = 0; i < 4; ++i) info.last_axis[i] = NAN;
-  for (int i = 0; i < 2; ++i) info.last_trigger[i] = NAN;
+  ResetThrottle(info);
+  timing.classify_us = lap();
 
   // Cache abs_info for axis normalization.
   for (unsigned int code = 0; code < ABS_MAX; ++code) {
@@ -313,10 +1269,76 @@ void EvdevManager::AddDevice(const char* path) {
       }
     }
   }
+  timing.abs_info_us = lap();
+  probed->timing = std::move(timing);
+  return probed;
+}
+
+void EvdevManager::NoteFirstEvent(int gamepad_id) {
+  first_event_seen_.insert(gamepad_id);
+  int64_t now_us = g_get_monotonic_time();
+  std::lock_guard<std::mutex> lock(mutex_);
+  // The latest attach of the id; older entries are earlier connections.
+  for (auto it = probe_log_.rbegin(); it != probe_log_.rend(); ++it) {
+    if (it->gamepad_id != gamepad_id) continue;
+    if (!it->first_event_at_us) it->first_event_at_us = now_us;
+    break;
+  }
+}
+
+void EvdevManager::NoteConnectionDelivered(FlValue* event) {
+  // Wire format: [0, gamepadId, timestamp, connected, ...]; battery
+  // events share the queue slot.
+  if (fl_value_get_int(fl_value_get_list_value(event, 0)) != 0 ||
+      fl_value_get_bool(fl_value_get_list_value(event, 3))) {
+    return;
+  }
+  first_event_seen_.erase(
+      static_cast<int>(fl_value_get_int(fl_value_get_list_value(event, 1))));
+}
+
+void EvdevManager::LogProbe(const ProbeTiming& timing) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  probe_log_.push_back(timing);
+  if (probe_log_.size() > kProbeLogSize) probe_log_.pop_front();
+}
+
+void EvdevManager::AttachDevice(ProbedDevice& probed) {
+  ProbeTiming& timing = probed.timing;
+  int64_t attach_start_us = g_get_monotonic_time();
+  timing.handoff_us = attach_start_us - timing.started_at_us -
+                      timing.open_us - timing.evdev_init_us -
+                      timing.classify_us - timing.abs_info_us;
+  int attached_fd = -1;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = devices_.find(probed.path);
+    if (it != devices_.end()) attached_fd = it->second.fd;
+  }
+  if (attached_fd >= 0) {
+    // The entry for the path is stale if the node was recreated since it
+    // was opened (a reconnect whose removal is still queued): retire it
+    // now instead of dropping the new device.
+    struct stat attached_st, probed_st;
+    if (fstat(attached_fd, &attached_st) == 0 &&
+        fstat(probed.info.fd, &probed_st) == 0 &&
+        attached_st.st_dev == probed_st.st_dev &&
+        attached_st.st_ino == probed_st.st_ino) {
+      timing.outcome = ProbeTiming::Outcome::kDropped;
+      LogProbe(timing);
+      return;
+    }
+    RemoveDevice(probed.path.c_str());
+  }
+
+  DeviceInfo info = std::move(probed.info);
+  probed.info.fd = -1;
+  probed.info.evdev = nullptr;
+  info.id = ClaimId(info);
 
   // Attach an IO source to the worker context.
-  GIOChannel* channel = g_io_channel_unix_new(fd);
-  std::string path_str(path);
+  GIOChannel* channel = g_io_channel_unix_new(info.fd);
+  const std::string& path_str = probed.path;
 
   GSource* source = g_io_create_watch(
       channel, static_cast<GIOCondition>(G_IO_IN | G_IO_HUP | G_IO_ERR));
@@ -327,6 +1349,7 @@ void EvdevManager::AddDevice(const char* path) {
     std::string path;
   };
   auto* wd = new WatchData{this, path_str};
+  live_sources_.fetch_add(1, std::memory_order_relaxed);
 
   g_source_set_callback(
       source,
@@ -336,33 +1359,19 @@ void EvdevManager::AddDevice(const char* path) {
             auto* wd = static_cast<WatchData*>(user_data);
             auto* self = wd->self;
 
-            // No mutex_ needed: all worker-thread callbacks (IO, AddDevice,
-            // RemoveDevice) are serialized by the worker GMainLoop. The main
-            // thread only reads devices_ under mutex_ in ListGamepads /
-            // EmitExistingDevices, and concurrent reads are safe.
+            // No mutex_ needed: all worker-thread callbacks (IO,
+            // AttachDevice, RemoveDevice) are serialized by the worker
+            // GMainLoop.  The main thread only reads devices_ under mutex_
+            // in ListGamepads / EmitExistingDevices, and concurrent reads
+            // are safe.
             auto it = self->devices_.find(wd->path);
             if (it == self->devices_.end()) return G_SOURCE_REMOVE;
 
             if (condition & (G_IO_HUP | G_IO_ERR)) {
-              auto* path_copy = new std::string(wd->path);
-              auto* mgr = self;
               // Schedule removal as idle on worker context.
-              GSource* idle = g_idle_source_new();
-              g_source_set_callback(
-                  idle,
-                  [](gpointer data) -> gboolean {
-                    auto* args =
-                        static_cast<std::pair<EvdevManager*, std::string*>*>(
-                            data);
-                    args->first->RemoveDevice(args->second->c_str());
-                    delete args->second;
-                    delete args;
-                    return G_SOURCE_REMOVE;
-                  },
-                  new std::pair<EvdevManager*, std::string*>(mgr, path_copy),
-                  nullptr);
-              g_source_attach(idle, self->worker_context_);
-              g_source_unref(idle);
+              std::string path = wd->path;
+              self->RunOnWorker(
+                  [self, path]() { self->RemoveDevice(path.c_str()); });
               return G_SOURCE_REMOVE;
             }
 
@@ -370,30 +1379,95 @@ void EvdevManager::AddDevice(const char* path) {
             return G_SOURCE_CONTINUE;
           })),
       wd,
-      [](gpointer data) { delete static_cast<WatchData*>(data); });
+      [](gpointer data) {
+        auto* wd = static_cast<WatchData*>(data);
+        wd->self->live_sources_.fetch_sub(1, std::memory_order_relaxed);
+        delete wd;
+      });
 
   g_source_attach(source, worker_context_);
   info.io_source = source;
 
+  ApplyForwarding(info);
+  recorder_.RecordDevice(info.id, info.abs_info);
+  RecordConnection(info, true);
+
   // Build connection event before inserting (we need the info fields).
-  int64_t ts = NowMillis();
-  // Wire format: [0, gamepadId, timestamp, connected, name, vendorId, productId]
-  FlValue* event = fl_value_new_list();
-  fl_value_append_take(event, fl_value_new_int(0));
-  fl_value_append_take(event, fl_value_new_int(info.id));
-  fl_value_append_take(event, fl_value_new_int(ts));
-  fl_value_append_take(event, fl_value_new_bool(TRUE));
-  fl_value_append_take(event, fl_value_new_string(info.name.c_str()));
-  fl_value_append_take(event, fl_value_new_int(info.vendor_id));
-  fl_value_append_take(event, fl_value_new_int(info.product_id));
+  FlValue* event = NewConnectionEvent(info, true);
+
+  if (info.pointer) {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    pointers_.emplace_back(info.id, info.pointer.get());
+  }
+
+  timing.attached_at_us = g_get_monotonic_time();
+  timing.attach_us = timing.attached_at_us - attach_start_us;
+  timing.gamepad_id = info.id;
+  LogProbe(timing);
 
+  bool reconnected = info.reconnected;
+  DeviceInfo* attached_info;
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    devices_[path_str] = std::move(info);
+    attached_info = &(devices_[path_str] = std::move(info));
   }
 
   ForwardEvent(event);
   fl_value_unref(event);
+  // Releases whatever Dart still thinks is held from before the dropout.
+  if (reconnected) EmitStateDiff(*attached_info);
+}
+
+int EvdevManager::ClaimId(DeviceInfo& info) {
+  info.reconnected = false;
+  if (info.identity.empty()) return next_id_++;
+  auto it = identities_.find(info.identity);
+  if (it == identities_.end()) {
+    Identity& identity = identities_[info.identity];
+    identity.id = next_id_++;
+    identity.attached = true;
+    return identity.id;
+  }
+
+  // A second pad with the same key (e.g. two without a uniq on one port)
+  // gets an id of its own.
+  Identity& identity = it->second;
+  if (identity.attached) return next_id_++;
+  identity.attached = true;
+  info.reconnected = true;
+  info.raw = identity.raw;
+  if (identity.report_rate) info.report_rate = std::move(identity.report_rate);
+  std::copy(std::begin(identity.delivered_buttons),
+            std::end(identity.delivered_buttons), info.delivered_buttons);
+  std::copy(std::begin(identity.delivered_axes),
+            std::end(identity.delivered_axes), info.delivered_axes);
+  return identity.id;
+}
+
+void EvdevManager::ParkIdentity(DeviceInfo& info) {
+  auto it = identities_.find(info.identity);
+  if (it == identities_.end() || it->second.id != info.id) return;
+  Identity& identity = it->second;
+  identity.attached = false;
+  identity.parked_at_us = clock_->NowMicros();
+  identity.raw = info.raw;
+  identity.report_rate = std::move(info.report_rate);
+  std::copy(std::begin(info.delivered_buttons),
+            std::end(info.delivered_buttons), identity.delivered_buttons);
+  std::copy(std::begin(info.delivered_axes), std::end(info.delivered_axes),
+            identity.delivered_axes);
+
+  size_t parked = 0;
+  auto oldest = identities_.end();
+  for (auto i = identities_.begin(); i != identities_.end(); ++i) {
+    if (i->second.attached) continue;
+    ++parked;
+    if (oldest == identities_.end() ||
+        i->second.parked_at_us < oldest->second.parked_at_us) {
+      oldest = i;
+    }
+  }
+  if (parked > kMaxParkedIdentities) identities_.erase(oldest);
 }
 
 void EvdevManager::RemoveDevice(const char* path) {
@@ -406,23 +1480,38 @@ void EvdevManager::RemoveDevice(const char* path) {
     devices_.erase(it);
   }
 
+  if (info.pointer) {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    pointers_.erase(
+        std::remove_if(pointers_.begin(), pointers_.end(),
+                       [&info](const std::pair<int, PointerEmulator*>& p) {
+                         return p.second == info.pointer.get();
+                       }),
+        pointers_.end());
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    raw_batches_.erase(
+        std::remove_if(raw_batches_.begin(), raw_batches_.end(),
+                       [&info](const RawBatch& batch) {
+                         return batch.gamepad_id == info.id;
+                       }),
+        raw_batches_.end());
+  }
+
   if (info.io_source) {
     g_source_destroy(info.io_source);
     g_source_unref(info.io_source);
   }
+  info.virtual_pad.reset();
   libevdev_free(info.evdev);
-  close(info.fd);
+  if (info.fd >= 0) close(info.fd);
+  RecordConnection(info, false);
+  recorder_.ForgetDevice(info.id);
 
-  int64_t ts = NowMillis();
-  // Wire format: [0, gamepadId, timestamp, connected, name, vendorId, productId]
-  FlValue* event = fl_value_new_list();
-  fl_value_append_take(event, fl_value_new_int(0));
-  fl_value_append_take(event, fl_value_new_int(info.id));
-  fl_value_append_take(event, fl_value_new_int(ts));
-  fl_value_append_take(event, fl_value_new_bool(FALSE));
-  fl_value_append_take(event, fl_value_new_string(info.name.c_str()));
-  fl_value_append_take(event, fl_value_new_int(info.vendor_id));
-  fl_value_append_take(event, fl_value_new_int(info.product_id));
+  FlValue* event = NewConnectionEvent(info, false);
+  if (!info.identity.empty()) ParkIdentity(info);
 
   ForwardEvent(event);
   fl_value_unref(event);
@@ -433,156 +1522,576 @@ void EvdevManager::RemoveDevice(const char* path) {
 // ---------------------------------------------------------------------------
 
 void EvdevManager::OnInput(DeviceInfo& info) {
+  GAMEPAD_TRACE_SCOPE("OnInput");
+  GAMEPAD_COUNT_ALLOCATIONS();
   struct input_event ev;
   int rc;
+  bool raw = info.raw && !input_gated_.load(std::memory_order_relaxed);
 
   while ((rc = libevdev_next_event(info.evdev, LIBEVDEV_READ_FLAG_NORMAL,
                                     &ev)) == LIBEVDEV_READ_STATUS_SUCCESS) {
-    if (ev.type == EV_KEY) {
-      int w3c_index = ButtonMapping::EvdevButtonToW3C(ev.code);
-      if (w3c_index < 0) continue;
-
-      bool pressed = ev.value != 0;
-      int64_t ts = NowMillis();
-      // Wire format: [1, gamepadId, timestamp, buttonIndex, pressed, value]
-      FlValue* fe = fl_value_new_list();
-      fl_value_append_take(fe, fl_value_new_int(1));
-      fl_value_append_take(fe, fl_value_new_int(info.id));
-      fl_value_append_take(fe, fl_value_new_int(ts));
-      fl_value_append_take(fe, fl_value_new_int(w3c_index));
-      fl_value_append_take(fe, fl_value_new_bool(pressed ? TRUE : FALSE));
-      fl_value_append_take(fe, fl_value_new_float(pressed ? 1.0 : 0.0));
-      ForwardEvent(fe);
-      fl_value_unref(fe);
-
-    } else if (ev.type == EV_ABS) {
-      if (ButtonMapping::IsHatAxis(ev.code)) {
-        int64_t ts = NowMillis();
-        int gid = info.id;
-
-        if (ev.code == ABS_HAT0X) {
-          {
-            // Wire format: [1, gamepadId, timestamp, buttonIndex, pressed, value]
-            FlValue* fe = fl_value_new_list();
-            fl_value_append_take(fe, fl_value_new_int(1));
-            fl_value_append_take(fe, fl_value_new_int(gid));
-            fl_value_append_take(fe, fl_value_new_int(ts));
-            fl_value_append_take(fe, fl_value_new_int(ButtonMapping::kDpadLeft));
-            bool pressed = ev.value < 0;
-            fl_value_append_take(fe, fl_value_new_bool(pressed ? TRUE : FALSE));
-            fl_value_append_take(fe, fl_value_new_float(pressed ? 1.0 : 0.0));
-            ForwardEvent(fe);
-            fl_value_unref(fe);
-          }
-          {
-            FlValue* fe = fl_value_new_list();
-            fl_value_append_take(fe, fl_value_new_int(1));
-            fl_value_append_take(fe, fl_value_new_int(gid));
-            fl_value_append_take(fe, fl_value_new_int(ts));
-            fl_value_append_take(fe, fl_value_new_int(ButtonMapping::kDpadRight));
-            bool pressed = ev.value > 0;
-            fl_value_append_take(fe, fl_value_new_bool(pressed ? TRUE : FALSE));
-            fl_value_append_take(fe, fl_value_new_float(pressed ? 1.0 : 0.0));
-            ForwardEvent(fe);
-            fl_value_unref(fe);
-          }
-        } else if (ev.code == ABS_HAT0Y) {
-          {
-            FlValue* fe = fl_value_new_list();
-            fl_value_append_take(fe, fl_value_new_int(1));
-            fl_value_append_take(fe, fl_value_new_int(gid));
-            fl_value_append_take(fe, fl_value_new_int(ts));
-            fl_value_append_take(fe, fl_value_new_int(ButtonMapping::kDpadUp));
-            bool pressed = ev.value < 0;
-            fl_value_append_take(fe, fl_value_new_bool(pressed ? TRUE : FALSE));
-            fl_value_append_take(fe, fl_value_new_float(pressed ? 1.0 : 0.0));
-            ForwardEvent(fe);
-            fl_value_unref(fe);
-          }
-          {
-            FlValue* fe = fl_value_new_list();
-            fl_value_append_take(fe, fl_value_new_int(1));
-            fl_value_append_take(fe, fl_value_new_int(gid));
-            fl_value_append_take(fe, fl_value_new_int(ts));
-            fl_value_append_take(fe, fl_value_new_int(ButtonMapping::kDpadDown));
-            bool pressed = ev.value > 0;
-            fl_value_append_take(fe, fl_value_new_bool(pressed ? TRUE : FALSE));
-            fl_value_append_take(fe, fl_value_new_float(pressed ? 1.0 : 0.0));
-            ForwardEvent(fe);
-            fl_value_unref(fe);
-          }
-        }
+    int64_t time_us = static_cast<int64_t>(ev.input_event_sec) * 1000000 +
+                      ev.input_event_usec;
+    recorder_.RecordRaw(info.id, time_us, ev, raw);
+    if (raw) {
+      info.raw_records.push_back({time_us, ev.value, ev.type, ev.code});
+    }
+    ProcessEvent(info, ev, time_us);
+  }
+
+  // Handle SYN_DROPPED: re-sync the device.  Raw readers get the
+  // synthesized state deltas so their view stays in step.
+  if (rc == LIBEVDEV_READ_STATUS_SYNC) {
+    while ((rc = libevdev_next_event(info.evdev, LIBEVDEV_READ_FLAG_SYNC,
+                                      &ev)) == LIBEVDEV_READ_STATUS_SYNC) {
+      if (raw) {
+        int64_t time_us = static_cast<int64_t>(ev.input_event_sec) * 1000000 +
+                          ev.input_event_usec;
+        info.raw_records.push_back({time_us, ev.value, ev.type, ev.code});
+      }
+    }
+  }
 
-      } else if (ButtonMapping::IsTriggerAxis(ev.code)) {
-        int button_index = ButtonMapping::TriggerAxisToButtonIndex(ev.code);
-        if (button_index < 0) continue;
+  if (!info.raw_records.empty()) ForwardRaw(info);
+}
 
-        const struct input_absinfo& ai = info.abs_info[ev.code];
-        double range = ai.maximum - ai.minimum;
-        double value = (range != 0)
-                           ? static_cast<double>(ev.value - ai.minimum) / range
-                           : 0.0;
+void EvdevManager::ProcessEvent(DeviceInfo& info,
+                                const struct input_event& ev,
+                                int64_t time_us) {
+  if (ev.type == EV_SYN && ev.code == SYN_REPORT) {
+    if (info.report_rate) info.report_rate->OnReport(time_us);
+    // End of a device report: push everything it changed to the virtual
+    // pad in one write.
+    if (info.virtual_pad) info.virtual_pad->Sync();
+
+  } else if (ev.type == EV_KEY) {
+    int w3c_index = ButtonMapping::EvdevButtonToW3C(ev.code);
+    if (w3c_index < 0) return;
+
+    bool pressed = ev.value != 0;
+    EmitButton(info, w3c_index, pressed, pressed ? 1.0 : 0.0, time_us);
+
+  } else if (ev.type == EV_ABS) {
+    if (ButtonMapping::IsHatAxis(ev.code)) {
+      if (ev.code == ABS_HAT0X) {
+        EmitButton(info, ButtonMapping::kDpadLeft, ev.value < 0,
+                   ev.value < 0 ? 1.0 : 0.0, time_us);
+        EmitButton(info, ButtonMapping::kDpadRight, ev.value > 0,
+                   ev.value > 0 ? 1.0 : 0.0, time_us);
+      } else if (ev.code == ABS_HAT0Y) {
+        EmitButton(info, ButtonMapping::kDpadUp, ev.value < 0,
+                   ev.value < 0 ? 1.0 : 0.0, time_us);
+        EmitButton(info, ButtonMapping::kDpadDown, ev.value > 0,
+                   ev.value > 0 ? 1.0 : 0.0, time_us);
+      }
 
-        // Throttle: skip if value hasn't changed meaningfully.
-        int trigger_idx = (ev.code == ABS_Z) ? 0 : 1;
-        if (!std::isnan(info.last_trigger[trigger_idx]) &&
-            std::fabs(value - info.last_trigger[trigger_idx]) < kAxisEpsilon) {
+    } else if (ButtonMapping::IsTriggerAxis(ev.code)) {
+      int button_index = ButtonMapping::TriggerAxisToButtonIndex(ev.code);
+      if (button_index < 0) return;
+
+      const struct input_absinfo& ai = info.abs_info[ev.code];
+      double range = ai.maximum - ai.minimum;
+      double value = (range != 0)
+                         ? static_cast<double>(ev.value - ai.minimum) / range
+                         : 0.0;
+      int trigger_idx = (ev.code == ABS_Z) ? 0 : 1;
+      if (info.dynamics) {
+        info.dynamics->Add(SignalDynamics::kTriggerChannel + trigger_idx,
+                           value, time_us);
+      }
+
+      const PipelineConfig& config = *config_;
+      value = PipelineConfig::ApplyDeadzone(value, config.trigger_deadzone);
+
+      // Throttle: skip if value hasn't changed meaningfully.
+      if (!std::isnan(info.last_trigger[trigger_idx]) &&
+          std::fabs(value - info.last_trigger[trigger_idx]) <
+              config.trigger_epsilon) {
+        return;
+      }
+      info.last_trigger[trigger_idx] = value;
+
+      EmitButton(info, button_index, value > 0.5, value, time_us);
+
+    } else {
+      int w3c_index = ButtonMapping::EvdevAxisToW3C(ev.code);
+      if (w3c_index < 0) return;
+
+      const struct input_absinfo& ai = info.abs_info[ev.code];
+      double range = ai.maximum - ai.minimum;
+      double value = (range != 0)
+                         ? 2.0 * (ev.value - ai.minimum) / range - 1.0
+                         : 0.0;
+      info.axis_window[w3c_index].Add(value, time_us);
+      if (info.dynamics) info.dynamics->Add(w3c_index, value, time_us);
+      if (info.pointer && pointer_enabled_.load(std::memory_order_relaxed) &&
+          !input_gated_.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        info.pointer->OnAxis(w3c_index, value, time_us, pointer_settings_);
+      }
+
+      const PipelineConfig& config = *config_;
+      value = PipelineConfig::ApplyDeadzone(value, config.stick_deadzone);
+
+      // Throttle: skip if value hasn't changed meaningfully.
+      if (!std::isnan(info.last_axis[w3c_index]) &&
+          std::fabs(value - info.last_axis[w3c_index]) <
+              config.axis_epsilon) {
+        return;
+      }
+      info.last_axis[w3c_index] = value;
+
+      EmitAxis(info, w3c_index, value, time_us);
+    }
+  }
+}
+
+void EvdevManager::EmitButton(DeviceInfo& info, int index, bool pressed,
+                              double value, int64_t time_us) {
+  if (config_->dedupe_buttons && info.buttons[index] == value) return;
+  info.buttons[index] = value;
+  if (info.virtual_pad) info.virtual_pad->SetButton(index, value);
+  recorder_.RecordProcessed(info.id, time_us, 1, static_cast<uint8_t>(index),
+                            value);
+  if (journal_) {
+    journal_->Append({time_us, info.id, 1, static_cast<uint8_t>(index), value});
+  }
+
+  ForwardInput(info, 1, index, pressed, value);
+}
+
+void EvdevManager::EmitAxis(DeviceInfo& info, int index, double value,
+                            int64_t time_us) {
+  info.axes[index] = value;
+  if (info.virtual_pad) info.virtual_pad->SetAxis(index, value);
+  recorder_.RecordProcessed(info.id, time_us, 2, static_cast<uint8_t>(index),
+                            value);
+  if (journal_) {
+    journal_->Append({time_us, info.id, 2, static_cast<uint8_t>(index), value});
+  }
+
+  ForwardInput(info, 2, index, false, value);
+}
+
+void EvdevManager::RecordConnection(const DeviceInfo& info,
+                                    bool connected) {
+  int64_t time_us = clock_->NowMicros();
+  double value = connected ? 1.0 : 0.0;
+  recorder_.RecordProcessed(info.id, time_us, 0, 0, value);
+  if (journal_) journal_->Append({time_us, info.id, 0, 0, value});
+}
+
+FlValue* EvdevManager::NewConnectionEvent(const DeviceInfo& info,
+                                          bool connected) {
+  int64_t ts = NowMillis();
+  // Wire format: [0, gamepadId, timestamp, connected, name, vendorId,
+  //               productId, reconnected]
+  FlValue* event = fl_value_new_list();
+  fl_value_append_take(event, fl_value_new_int(0));
+  fl_value_append_take(event, fl_value_new_int(info.id));
+  fl_value_append_take(event, fl_value_new_int(ts));
+  fl_value_append_take(event, fl_value_new_bool(connected ? TRUE : FALSE));
+  fl_value_append_take(event, fl_value_new_string(info.name.c_str()));
+  fl_value_append_take(event, fl_value_new_int(info.vendor_id));
+  fl_value_append_take(event, fl_value_new_int(info.product_id));
+  fl_value_append_take(
+      event, fl_value_new_bool(connected && info.reconnected ? TRUE : FALSE));
+  return event;
+}
+
+FlValue* EvdevManager::NewBatteryEvent(const DeviceInfo& info) {
+  const BatteryState& battery = info.battery_state;
+  // Wire format: [4, gamepadId, timestamp, level, status]
+  FlValue* event = fl_value_new_list();
+  fl_value_append_take(event, fl_value_new_int(4));
+  fl_value_append_take(event, fl_value_new_int(info.id));
+  fl_value_append_take(event, fl_value_new_int(NowMillis()));
+  fl_value_append_take(event, battery.level >= 0
+                                  ? fl_value_new_int(battery.level)
+                                  : fl_value_new_null());
+  fl_value_append_take(event, fl_value_new_string(battery.status_name()));
+  return event;
+}
+
+// static
+InputWireEvent EvdevManager::ToWire(const PendingEvent& event,
+                                    AxisCoalescing mode) {
+  InputWireEvent wire{event.type,  event.gamepad_id, event.timestamp,
+                      event.index, event.pressed,    event.value,
+                      event.delta_y, mode, 0.0, 0.0, 0.0, 0.0};
+  if (event.type != 2 || mode == AxisCoalescing::kLatest) return wire;
+
+  // Coalesced axis: the window summary behind the value.
+  const AxisWindow::Summary& w = event.window;
+  wire.min = w.min;
+  wire.max = w.max;
+  wire.average =
+      w.span_us > 0 ? w.displacement * 1e6 / w.span_us : event.value;
+  wire.displacement = w.displacement;
+  return wire;
+}
+
+// ---------------------------------------------------------------------------
+// Replay in simulated time (calling thread)
+// ---------------------------------------------------------------------------
+
+// static
+bool EvdevManager::ReplayFlightRecord(const std::string& path,
+                                      const EventCallback& callback) {
+  std::vector<std::string> settings;
+  std::vector<FlightRecorder::AbsRange> ranges;
+  std::vector<FlightRecorder::RawRecord> raw;
+  std::vector<FlightRecorder::DrainRecord> drains;
+  if (!FlightRecorder::ReadDump(path, &settings, &ranges, &raw, &drains)) {
+    return false;
+  }
+  if (raw.empty()) return true;
+
+  auto clock = std::make_unique<SimulatedPipelineClock>(raw.front().time_us);
+  SimulatedPipelineClock* sim = clock.get();
+  EvdevManager manager(std::move(clock));
+  manager.callback_ = callback;
+  manager.ApplyDumpSettings(settings);
+
+  // Recorded drain ticks run at the times they ran live, with the lateness
+  // and cost they had there, so adaptive delivery makes the same decisions
+  // (simulated time costs nothing).  The drain timer takes over after the
+  // last of them, or from the start for dumps without any.
+  auto drain = std::lower_bound(
+      drains.begin(), drains.end(), raw.front().time_us,
+      [](const FlightRecorder::DrainRecord& tick, int64_t time_us) {
+        return tick.time_us < time_us;
+      });
+  if (drain == drains.end()) manager.ScheduleDrain(manager.drain_interval_ms_);
+  auto advance_to = [&](int64_t time_us) {
+    while (drain != drains.end() && drain->time_us <= time_us) {
+      sim->AdvanceTo(drain->time_us);
+      size_t delivered = manager.Drain(drain->time_us);
+      manager.FinishDrain(drain->lateness_us, drain->cost_us, delivered);
+      if (++drain == drains.end()) {
+        manager.ScheduleDrain(manager.drain_interval_ms_);
+      }
+    }
+    // Fire every timer drain that would have run before |time_us|.
+    sim->AdvanceTo(time_us);
+  };
+
+  for (const FlightRecorder::RawRecord& record : raw) {
+    advance_to(record.time_us);
+
+    std::string key = std::to_string(record.gamepad_id);
+    auto it = manager.devices_.find(key);
+    if (it == manager.devices_.end()) {
+      DeviceInfo info{};
+      info.fd = -1;
+      info.id = record.gamepad_id;
+      info.name = "Replay " + key;
+      info.report_rate = std::make_unique<ReportRateMeter>();
+      info.dynamics = std::make_unique<SignalDynamics>();
+      ResetThrottle(info);
+      for (const FlightRecorder::AbsRange& range : ranges) {
+        if (range.gamepad_id != info.id || range.code >= ABS_MAX) continue;
+        info.abs_info[range.code].minimum = range.minimum;
+        info.abs_info[range.code].maximum = range.maximum;
+      }
+
+      FlValue* event = manager.NewConnectionEvent(info, true);
+      manager.ForwardEvent(event);
+      fl_value_unref(event);
+      it = manager.devices_.emplace(key, std::move(info)).first;
+    }
+
+    DeviceInfo& info = it->second;
+    if (record.streamed) {
+      info.raw_records.push_back({record.time_us, record.ev.value,
+                                  record.ev.type, record.ev.code});
+    }
+    manager.ProcessEvent(info, record.ev, record.time_us);
+    if (!info.raw_records.empty()) manager.ForwardRaw(info);
+  }
+
+  // Deliver whatever the last batches still hold.
+  advance_to(drains.empty() ? sim->NowMicros() : drains.back().time_us);
+  for (;;) {
+    sim->AdvanceTo(sim->NowMicros() +
+                   static_cast<int64_t>(manager.drain_interval_ms_) * 1000);
+    if (manager.drain_pos_ < manager.drain_events_.size()) continue;
+    std::lock_guard<std::mutex> lock(manager.queue_mutex_);
+    if (manager.pending_events_.empty()) break;
+  }
+  return true;
+}
+
+std::vector<std::string> EvdevManager::DumpSettings() {
+  std::shared_ptr<const PipelineConfig> config;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config = published_config_;
+  }
+  std::vector<std::string> settings;
+  if (config) {
+    for (const std::string& line : config->ToKeyValues()) {
+      settings.push_back("pipeline " + line);
+    }
+  }
+
+  gchar load[G_ASCII_DTOSTR_BUF_SIZE];
+  gchar cost[G_ASCII_DTOSTR_BUF_SIZE];
+  gchar rate[G_ASCII_DTOSTR_BUF_SIZE];
+  g_autofree gchar* drain = g_strdup_printf(
+      "drain %u %u %u %s %s %s", min_drain_ms_, max_drain_ms_,
+      drain_interval_ms_, g_ascii_dtostr(load, sizeof(load), load_factor_),
+      g_ascii_dtostr(cost, sizeof(cost), event_cost_us_),
+      g_ascii_dtostr(rate, sizeof(rate), fastest_rate_hz_));
+  settings.push_back(drain);
+
+  std::string coalescing = "coalescing";
+  for (AxisCoalescing mode : axis_coalescing_) {
+    coalescing += " " + std::to_string(static_cast<int>(mode));
+  }
+  settings.push_back(coalescing);
+  return settings;
+}
+
+void EvdevManager::ApplyDumpSettings(
+    const std::vector<std::string>& settings) {
+  std::string pipeline = "[pipeline]\n";
+  for (const std::string& setting : settings) {
+    gchar** fields = g_strsplit(setting.c_str(), " ", -1);
+    guint count = g_strv_length(fields);
+    if (count == 2 && strcmp(fields[0], "pipeline") == 0) {
+      pipeline += fields[1];
+      pipeline += '\n';
+    } else if (count == 7 && strcmp(fields[0], "drain") == 0) {
+      SetDeliveryLatencyBounds(
+          static_cast<guint>(g_ascii_strtoull(fields[1], nullptr, 10)),
+          static_cast<guint>(g_ascii_strtoull(fields[2], nullptr, 10)));
+      drain_interval_ms_ = std::clamp(
+          static_cast<guint>(g_ascii_strtoull(fields[3], nullptr, 10)),
+          min_drain_ms_, max_drain_ms_);
+      load_factor_ = std::clamp(g_ascii_strtod(fields[4], nullptr), 1.0,
+                                kMaxLoadFactor);
+      event_cost_us_ = std::max(g_ascii_strtod(fields[5], nullptr), 0.0);
+      fastest_rate_hz_ = std::max(g_ascii_strtod(fields[6], nullptr), 0.0);
+    } else if (count == 1 + ButtonMapping::kAxisCount &&
+               strcmp(fields[0], "coalescing") == 0) {
+      for (int i = 0; i < ButtonMapping::kAxisCount; ++i) {
+        guint64 mode = g_ascii_strtoull(fields[i + 1], nullptr, 10);
+        if (mode > static_cast<guint64>(AxisCoalescing::kDisplacement)) {
           continue;
         }
-        info.last_trigger[trigger_idx] = value;
-
-        bool pressed = value > 0.5;
-        int64_t ts = NowMillis();
-        // Wire format: [1, gamepadId, timestamp, buttonIndex, pressed, value]
-        FlValue* fe = fl_value_new_list();
-        fl_value_append_take(fe, fl_value_new_int(1));
-        fl_value_append_take(fe, fl_value_new_int(info.id));
-        fl_value_append_take(fe, fl_value_new_int(ts));
-        fl_value_append_take(fe, fl_value_new_int(button_index));
-        fl_value_append_take(fe, fl_value_new_bool(pressed ? TRUE : FALSE));
-        fl_value_append_take(fe, fl_value_new_float(value));
-        ForwardEvent(fe);
-        fl_value_unref(fe);
+        SetAxisCoalescing(i, static_cast<AxisCoalescing>(mode));
+      }
+    }
+    g_strfreev(fields);
+  }
+
+  // The drain line above already holds the bounds in effect, config
+  // overrides included; the config shapes the processing on the worker.
+  auto config = std::make_shared<PipelineConfig>();
+  std::string error;
+  if (!PipelineConfig::Parse(pipeline, config.get(), &error)) {
+    g_warning("gamepad: replaying with the default config: %s",
+              error.c_str());
+    return;
+  }
+  config_ = config;
+}
+
+// ---------------------------------------------------------------------------
+// Benchmark injector (main thread)
+// ---------------------------------------------------------------------------
+
+const char* EvdevManager::StartInjector() {
+  if (injector_pad_) return "uinput";
+  if (direct_injector_) return "direct";
+
+  // Real path: a uinput pad that the worker discovers through hotplug and
+  // reads like any other device.
+  injector_pad_ = VirtualGamepad::Create(kInjectorName, 0, 0,
+                                         VirtualGamepad::kInjectorPhys);
+  if (injector_pad_) return "uinput";
+
+  // Fallback: a device without an fd whose events are produced on the
+  // worker, skipping only the kernel and the evdev read.
+  direct_injector_ = true;
+  RunOnWorker([this]() {
+    DeviceInfo info{};
+    info.fd = -1;
+    info.id = next_id_++;
+    info.name = kInjectorName;
+    ResetThrottle(info);
+    RecordConnection(info, true);
+    FlValue* event = NewConnectionEvent(info, true);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      devices_[kDirectInjectorPath] = std::move(info);
+    }
+    ForwardEvent(event);
+    fl_value_unref(event);
+  });
+  return "direct";
+}
 
+void EvdevManager::StopInjector() {
+  if (burst_timer_id_) {
+    g_source_remove(burst_timer_id_);
+    burst_timer_id_ = 0;
+  }
+  burst_remaining_ = 0;
+  injector_pad_.reset();
+  if (direct_injector_) {
+    direct_injector_ = false;
+    RunOnWorker([this]() { RemoveDevice(kDirectInjectorPath); });
+  }
+}
+
+void EvdevManager::Inject(int type, int index, double value) {
+  if (type == 1 && (index < 0 || index >= ButtonMapping::kButtonCount)) return;
+  if (type == 2 && (index < 0 || index >= ButtonMapping::kAxisCount)) return;
+  if (type != 1 && type != 2) return;
+
+  if (injector_pad_) {
+    if (type == 1) {
+      injector_pad_->SetButton(index, value);
+    } else {
+      injector_pad_->SetAxis(index, value);
+    }
+    injector_pad_->Sync();
+  } else if (direct_injector_) {
+    RunOnWorker([this, type, index, value]() {
+      auto it = devices_.find(kDirectInjectorPath);
+      if (it == devices_.end()) return;
+      // What OnInput() would count for a real device.
+      GAMEPAD_COUNT_ALLOCATIONS();
+      int64_t time_us = clock_->NowMicros();
+      if (type == 1) {
+        EmitButton(it->second, index, value > 0.5, value, time_us);
       } else {
-        int w3c_index = ButtonMapping::EvdevAxisToW3C(ev.code);
-        if (w3c_index < 0) continue;
-
-        const struct input_absinfo& ai = info.abs_info[ev.code];
-        double range = ai.maximum - ai.minimum;
-        double value = (range != 0)
-                           ? 2.0 * (ev.value - ai.minimum) / range - 1.0
-                           : 0.0;
-
-        // Throttle: skip if value hasn't changed meaningfully.
-        if (w3c_index < 4 &&
-            !std::isnan(info.last_axis[w3c_index]) &&
-            std::fabs(value - info.last_axis[w3c_index]) < kAxisEpsilon) {
-          continue;
-        }
-        if (w3c_index < 4) info.last_axis[w3c_index] = value;
-
-        int64_t ts = NowMillis();
-        // Wire format: [2, gamepadId, timestamp, axisIndex, value]
-        FlValue* fe = fl_value_new_list();
-        fl_value_append_take(fe, fl_value_new_int(2));
-        fl_value_append_take(fe, fl_value_new_int(info.id));
-        fl_value_append_take(fe, fl_value_new_int(ts));
-        fl_value_append_take(fe, fl_value_new_int(w3c_index));
-        fl_value_append_take(fe, fl_value_new_float(value));
-        ForwardEvent(fe);
-        fl_value_unref(fe);
+        EmitAxis(it->second, index, value, time_us);
       }
+    });
+  }
+}
+
+void EvdevManager::InjectBurst(int index, int count) {
+  if (index < 0 || index >= ButtonMapping::kButtonCount || count <= 0) return;
+
+  if (direct_injector_) {
+    RunOnWorker([this, index, count]() {
+      auto it = devices_.find(kDirectInjectorPath);
+      if (it == devices_.end()) return;
+      for (int i = 0; i < count; ++i) {
+        bool pressed = i % 2 == 0;
+        EmitButton(it->second, index, pressed, pressed ? 1.0 : 0.0,
+                   clock_->NowMicros());
+      }
+    });
+    return;
+  }
+  if (!injector_pad_) return;
+
+  burst_index_ = index;
+  burst_remaining_ += count;
+  if (!burst_timer_id_) {
+    burst_pressed_ = false;
+    InjectBurstChunk(this);
+    if (burst_remaining_ > 0) {
+      burst_timer_id_ = g_timeout_add(1, InjectBurstChunk, this);
     }
   }
+}
 
-  // Handle SYN_DROPPED: re-sync the device.
-  if (rc == LIBEVDEV_READ_STATUS_SYNC) {
-    while ((rc = libevdev_next_event(info.evdev, LIBEVDEV_READ_FLAG_SYNC,
-                                      &ev)) == LIBEVDEV_READ_STATUS_SYNC) {
-      // Drain sync events.
+// static
+gboolean EvdevManager::InjectBurstChunk(gpointer user_data) {
+  auto* self = static_cast<EvdevManager*>(user_data);
+  int chunk = std::min(self->burst_remaining_, kBurstChunk);
+  for (int i = 0; i < chunk; ++i) {
+    self->burst_pressed_ = !self->burst_pressed_;
+    self->injector_pad_->SetButton(self->burst_index_,
+                                   self->burst_pressed_ ? 1.0 : 0.0);
+    self->injector_pad_->Sync();
+  }
+  self->burst_remaining_ -= chunk;
+  if (self->burst_remaining_ > 0) return G_SOURCE_CONTINUE;
+  self->burst_timer_id_ = 0;
+  return G_SOURCE_REMOVE;
+}
+
+// ---------------------------------------------------------------------------
+// Forwarding to uinput (worker thread)
+// ---------------------------------------------------------------------------
+
+void EvdevManager::ApplyForwarding(DeviceInfo& info) {
+  // The direct injector has no source device to grab or mirror.
+  if (!info.evdev) return;
+  bool want_grab = forward_enabled_ && forward_grab_;
+  if (info.grabbed != want_grab) {
+    int rc = libevdev_grab(info.evdev,
+                           want_grab ? LIBEVDEV_GRAB : LIBEVDEV_UNGRAB);
+    if (rc < 0) {
+      g_warning("evdev: failed to %s %s: %s", want_grab ? "grab" : "ungrab",
+                info.name.c_str(), strerror(-rc));
+    } else {
+      info.grabbed = want_grab;
     }
   }
+
+  if (!forward_enabled_) {
+    info.virtual_pad.reset();
+    return;
+  }
+  if (info.virtual_pad) return;
+
+  info.virtual_pad =
+      VirtualGamepad::Create(info.name, info.vendor_id, info.product_id);
+  if (!info.virtual_pad) return;
+
+  // Seed the new pad with the current state so it does not start out of
+  // sync with the physical device.
+  for (int i = 0; i < ButtonMapping::kButtonCount; ++i) {
+    info.virtual_pad->SetButton(i, info.buttons[i]);
+  }
+  for (int i = 0; i < ButtonMapping::kAxisCount; ++i) {
+    info.virtual_pad->SetAxis(i, info.axes[i]);
+  }
+  info.virtual_pad->Sync();
+}
+
+void EvdevManager::RunOnWorker(std::function<void()> task) {
+  if (!worker_context_) return;
+
+  // The destroy notify frees the task whether it ran or the context was
+  // torn down first.
+  struct Task {
+    EvdevManager* self;
+    GSource* source;
+    std::function<void()> run;
+  };
+  live_sources_.fetch_add(1, std::memory_order_relaxed);
+  GSource* idle = g_idle_source_new();
+  bool track = threading_mode_ == ThreadingMode::kInline;
+  g_source_set_callback(
+      idle,
+      [](gpointer data) -> gboolean {
+        static_cast<Task*>(data)->run();
+        return G_SOURCE_REMOVE;
+      },
+      new Task{this, track ? idle : nullptr, std::move(task)},
+      [](gpointer data) {
+        auto* task = static_cast<Task*>(data);
+        EvdevManager* self = task->self;
+        if (task->source) {
+          auto& tasks = self->inline_tasks_;
+          tasks.erase(std::remove(tasks.begin(), tasks.end(), task->source),
+                      tasks.end());
+        }
+        self->live_sources_.fetch_sub(1, std::memory_order_relaxed);
+        delete task;
+      });
+  if (track) inline_tasks_.push_back(idle);
+  g_source_attach(idle, worker_context_);
+  g_source_unref(idle);
 }
 
 void EvdevManager::OnDirectoryChanged(GFileMonitor* monitor, GFile* file,
@@ -597,9 +2106,16 @@ void EvdevManager::OnDirectoryChanged(GFileMonitor* monitor, GFile* file,
   g_autofree gchar* basename = g_file_get_basename(file);
   if (!basename || strncmp(basename, "event", 5) != 0) return;
 
+  // Runs on the probe thread: the blocking open and ioctls happen here, and
+  // only the finished record is handed to the worker.  Removals go through
+  // the same worker queue, so they stay ordered after a pending attach.
   if (event_type == G_FILE_MONITOR_EVENT_CREATED) {
-    self->AddDevice(path);
+    std::shared_ptr<ProbedDevice> probed = self->ProbeDevice(path);
+    if (!probed) return;
+    self->RunOnWorker([self, probed]() { self->AttachDevice(*probed); });
   } else if (event_type == G_FILE_MONITOR_EVENT_DELETED) {
-    self->RemoveDevice(path);
+    std::string removed(path);
+    self->RunOnWorker(
+        [self, removed]() { self->RemoveDevice(removed.c_str()); });
   }
 }
@@ -5,39 +5,324 @@
 #include <libevdev/libevdev.h>
 #include <linux/input.h>
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "button_mapping.h"
+#include "device_capabilities.h"
+#include "device_identity.h"
+#include "flight_recorder.h"
+#include "axis_window.h"
+#include "battery_monitor.h"
+#include "input_journal.h"
+#include "input_wire.h"
+#include "metrics_ring.h"
+#include "pipeline_clock.h"
+#include "pipeline_config.h"
+#include "pointer_emulator.h"
+#include "probe_timing.h"
+#include "report_rate_meter.h"
+#include "signal_dynamics.h"
+#include "virtual_gamepad.h"
+
+/// One evdev event as streamed by raw passthrough: 16 bytes, native
+/// (little-endian) byte order.
+struct RawInputRecord {
+  int64_t time_us;
+  int32_t value;
+  uint16_t type;
+  uint16_t code;
+};
+static_assert(sizeof(RawInputRecord) == 16, "raw records are 16 bytes");
+
+/// How EvdevManager spreads its work over threads.
+enum class ThreadingMode {
+  // Reader and probe threads; events reach the main thread through a
+  // batched queue (the default).
+  kThreaded,
+  // Everything on the main context, every event delivered as it is read.
+  // Cheapest on single-core devices.
+  kInline,
+};
+
 /// Manages gamepad lifecycle via direct evdev on a dedicated GLib thread.
 ///
-/// Device scanning, hotplug monitoring, and event reading all happen on a
-/// private GMainLoop running in its own thread.  Finished events are queued
-/// and drained by a 16 ms periodic timer on the main GMainContext so that
+/// Event reading happens on a private GMainLoop running in its own thread.
+/// Hotplugged devices are opened and classified on a second, probe thread,
+/// so a slow open() or ioctl sequence on a flaky device never delays input
+/// from pads already connected; the probe thread hands fully initialized
+/// device records to the reader.  Finished events are queued
+/// and drained by a periodic timer on the main GMainContext so that
 /// FlValue/EventChannel calls stay on the main thread.  No cross-thread
 /// g_idle_add / g_main_context_wakeup is used — the worker just pushes to
 /// the queue.
 ///
+/// In ThreadingMode::kInline there are no threads: device IO sources,
+/// hotplug and probing run on the default main context, and events are
+/// handed to the callback as soon as they are processed, with no queue,
+/// coalescing or drain timer (the timer only runs for pointer emulation,
+/// which needs periodic ticks).
+///
+/// The drain interval adapts within SetDeliveryLatencyBounds(): it follows
+/// the fastest connected pad's measured report rate, falls back to the
+/// upper bound when no input has arrived for a while, and backs off when
+/// the timer fires late or delivery takes a large share of the interval
+/// (the UI thread is overloaded).  Each drain also has a time budget; a
+/// batch that exceeds it is finished on the next tick.
+///
 /// Axis events are throttled: a new value is only forwarded when it differs
-/// from the previous value by more than kAxisEpsilon.  Duplicate axis events
-/// in the same drain batch are coalesced to the latest value.
+/// from the previous value by more than the configured epsilon.  Duplicate
+/// axis events in the same drain batch are coalesced to the latest value.
+/// Every raw sample, throttled or not, also feeds a per-axis AxisWindow, and
+/// SetAxisCoalescing() can make an axis deliver its envelope, mean or
+/// displacement alongside the latest value.
+///
+/// Thresholds, deadzones, button dedupe and the drain bounds come from an
+/// optional PipelineConfig file, watched on the worker.  A change is parsed
+/// there into a new immutable snapshot that replaces the worker's between
+/// two dispatches, so every report is processed under one snapshot and the
+/// per-event path takes no lock; the main thread picks up a bumped
+/// version on its next drain tick.
+///
+/// Button and axis events are queued as plain PendingEvent records in two
+/// swapped vectors that keep their capacity, and coalescing is tracked per
+/// device, so the steady-state input path does not allocate.  A drain
+/// hands each one to the input callback as an InputWireEvent, which the
+/// stream handler encodes without FlValues; only without an input callback
+/// are wire lists built for the event callback.  The example's allocation
+/// check (AllocationCheck) holds this path to zero allocations.
+///
+/// Raw passthrough (SetRawPassthrough) additionally streams every evdev
+/// event of selected devices, unmapped and unthrottled, as packed
+/// RawInputRecord arrays: one raw batch event (type 5) per device per drain,
+/// or per read in inline mode.
+///
+/// Optionally the processed state can be re-emitted through one uinput
+/// VirtualGamepad per physical pad ("forwarding"), written from the worker
+/// in the same pass that read the input, so non-Flutter applications see the
+/// same mapped input.
+///
+/// Battery level and charge status come from the power_supply class device
+/// of each pad's HID device.  They are re-read on the worker when the
+/// kernel sends a power_supply uevent (or, where netlink uevents are not
+/// available, on a coarse worker timer), and a battery event (type 4) is
+/// queued only when the level or status actually changed.
+///
+/// Processed events can also be journaled to disk (see InputJournalWriter);
+/// encoding happens on the worker and file writes on the journal's own
+/// thread.
+///
+/// Every raw and processed event is also kept in an always-on FlightRecorder
+/// that can be dumped by DumpFlightRecorder() or by sending SIGUSR2 to the
+/// process.
+///
+/// All timestamps and the drain timer go through a PipelineClock.  With a
+/// SimulatedPipelineClock, ReplayFlightRecord() runs a recorded session
+/// through the same processing, coalescing and drain batching on the calling
+/// thread, at full CPU speed.
 class EvdevManager {
  public:
   using EventCallback = std::function<void(FlValue* event)>;
+  using InputCallback = std::function<void(const InputWireEvent& event)>;
 
-  EvdevManager();
+  /// Uses a SystemPipelineClock when |clock| is null.
+  explicit EvdevManager(std::unique_ptr<PipelineClock> clock = nullptr);
   ~EvdevManager();
 
-  void Start(EventCallback callback);
+  /// Replays the raw events of a flight recorder dump through a private
+  /// pipeline in simulated time and passes every event it delivers to
+  /// |callback|, synchronously.  The pipeline runs with the config,
+  /// delivery bounds, adaptive drain state and axis coalescing recorded in
+  /// the dump.  Drains run at the recorded drain ticks and adapt to their
+  /// recorded lateness and cost, and raw events streamed live are streamed
+  /// again, so the replay delivers what the live pipeline did.  Returns
+  /// false if |path| cannot be read.
+  static bool ReplayFlightRecord(const std::string& path,
+                                 const EventCallback& callback);
+
+  /// Starts a synthetic input source for latency benchmarks: a uinput pad
+  /// that is read back like any physical device or, if uinput is not
+  /// available, a device fed straight into the worker.  Returns the source
+  /// used, "uinput" or "direct".  Main thread only.
+  const char* StartInjector();
+
+  /// Removes the injector device.  Main thread only.
+  void StopInjector();
+
+  /// Injects a button (|type| 1) or stick axis (|type| 2) change through the
+  /// injector.  Main thread only.
+  void Inject(int type, int index, double value);
+
+  /// Injects |count| alternating presses and releases of button |index|,
+  /// starting with a press, for throughput benchmarks.  The direct injector
+  /// takes them all in one worker task.  The uinput pad takes
+  /// kBurstChunk of them per main-loop millisecond, which keeps the
+  /// worker's evdev buffer from overflowing, so its throughput is bounded
+  /// by that rate.  Main thread only.
+  void InjectBurst(int index, int count);
+
+  /// Starts monitoring.  Button, axis and pointer events go to
+  /// |input_callback| if set and to |callback| as wire lists otherwise;
+  /// every other event goes to |callback|.  Both run on the main thread.
+  void Start(EventCallback callback, InputCallback input_callback = nullptr);
   void Stop();
+
+  /// Returns every connected device as a list of maps: id, name, vendorId,
+  /// productId, reportRateHz once measured, "capabilities" and, for pads
+  /// with a battery, "battery" ({level, status}).
   FlValue* ListGamepads();
   void EmitExistingDevices();
 
+  /// Returns the measured report cadence of every connected device as a
+  /// list of maps: id, reportRateHz, meanIntervalUs, jitterUs, intervals,
+  /// gaps, jitterHistogram and jitterBucketLimitsUs.
+  FlValue* GetStats();
+
+  /// Returns the analog state of every connected device as a list of maps:
+  /// id, timestampUs, and values, velocities and accelerations as float
+  /// lists of the four W3C axes followed by the two triggers.  Derivatives
+  /// are per second, computed on the worker from raw samples.  When
+  /// |predict_to_us| (wall clock, like the kernel timestamps) is non-zero,
+  /// "predicted" and "confidence" lists extrapolate each signal to it.
+  FlValue* GetGamepadState(int64_t predict_to_us);
+
+  /// Returns where startup and hotplug time went: Start() and its initial
+  /// scan, and the phases of the last kProbeLogSize device probes
+  /// (attached or rejected) with each attached pad's first delivered
+  /// input event.  Times are microseconds; points in time are relative to
+  /// |origin_us| (GLib monotonic time, e.g. plugin registration), or to
+  /// Start() if it is 0:
+  ///
+  ///   {startAtUs, startUs, scanAtUs, scanUs, probes: [ProbeTiming map]}
+  ///
+  /// Main thread only.
+  FlValue* GetDiagnostics(int64_t origin_us);
+
+  /// Bounds the adaptive drain interval, i.e. the extra latency the main
+  /// thread batching may add.  Main thread only.
+  void SetDeliveryLatencyBounds(guint min_ms, guint max_ms);
+
+  /// Selects how axis |index| (W3C) summarises the samples coalesced into
+  /// each delivered event.  Applies from the next drain.  Main thread only.
+  void SetAxisCoalescing(int index, AxisCoalescing mode);
+
+  /// Enables or disables stick pointer emulation.  While enabled, each
+  /// device's stick is integrated on the worker from every raw sample and
+  /// each drain queues a pointer event (type 3) per device with the motion
+  /// since the previous drain.  Main thread only.
+  void SetPointerEmulation(bool enabled, const PointerSettings& settings);
+
+  /// Enables or disables raw passthrough for the device |gamepad_id|.
+  /// Returns false if no such device is connected.  Main thread only.
+  bool SetRawPassthrough(int gamepad_id, bool enabled);
+
+  /// Gates input delivery, e.g. while the app window is unfocused.  While
+  /// gated the worker keeps reading and tracking device state (and feeding
+  /// forwarding, the journal and the flight recorder) but queues no input
+  /// events, and the drain timer is stopped.  Connection and battery
+  /// events still queue and are delivered as soon as the gate opens.
+  /// Ungating also starts every axis window afresh, so no coalesced event
+  /// summarises the gated period, and queues one event per control whose
+  /// state differs from what was last delivered, so Dart catches up in a
+  /// single batch.  Main thread only.
+  void SetInputGated(bool gated);
+
+  /// Selects the threading mode.  Takes effect at the next Start(); when
+  /// already running, the manager restarts, so devices are re-announced
+  /// (with their previous ids where they have a stable identity) and
+  /// forwarding, journaling and the injector are reset.
+  /// Main thread only.
+  void SetThreadingMode(ThreadingMode mode);
+
+  /// Enables or disables forwarding of processed state to uinput virtual
+  /// gamepads.  When |grab| is true the physical devices are grabbed with
+  /// EVIOCGRAB while forwarding so other readers only see the virtual pad.
+  void SetForwarding(bool enabled, bool grab);
+
+  /// Starts journaling processed events to |path|, replacing any journal
+  /// already running.  Returns false if the manager is not running or the
+  /// file cannot be created.
+  bool StartJournal(const std::string& path);
+
+  /// Stops journaling and flushes the journal file.
+  void StopJournal();
+
+  /// Writes the last |window_ms| of recorded input to |path| as text.
+  /// Safe to call while input is being read.
+  bool DumpFlightRecorder(const std::string& path, int64_t window_ms);
+
+  /// Number of per-device watches and worker tasks whose GSource has not
+  /// been destroyed yet.  Should return to its baseline once hotplug
+  /// settles; used by the soak harness.
+  int live_sources() const {
+    return live_sources_.load(std::memory_order_relaxed);
+  }
+
+  /// The contexts of the worker and probe threads (both the default main
+  /// context in inline mode), null while stopped.  Lets the soak harness
+  /// count what is really attached to them.
+  GMainContext* worker_context() const { return worker_context_; }
+  GMainContext* probe_context() const { return probe_context_; }
+
  private:
-  static constexpr double kAxisEpsilon = 0.005;
+  static constexpr int64_t kSignalDumpWindowMs = 30000;
+  static constexpr guint kDefaultMinDrainMs = 4;
+  static constexpr guint kDefaultMaxDrainMs = 16;
+  // No input for this long counts as idle and drains at the upper bound.
+  static constexpr int64_t kIdleAfterUs = 1000000;
+  // Share of the drain interval delivery may take before it counts as
+  // overload, and the per-tick delivery budget.
+  static constexpr double kDeliveryCostShare = 0.25;
+  static constexpr double kMaxLoadFactor = 4.0;
+  // Smallest per-tick batch, so a slow tick never stalls delivery.
+  static constexpr size_t kMinDrainBatch = 32;
+  // Drain ticks between re-reading the devices' report rates.
+  static constexpr int kRateCheckTicks = 16;
+  static constexpr size_t kProbeLogSize = 64;
+  // Battery re-read interval where no uevents arrive.
+  static constexpr guint kBatteryPollSeconds = 60;
+  // Disconnected identities remembered before the oldest is forgotten.
+  static constexpr size_t kMaxParkedIdentities = 32;
+  static constexpr const char* kInjectorName = "Universal Gamepad Injector";
+  // devices_ key of the direct (non-uinput) injector.
+  static constexpr const char* kDirectInjectorPath = "injector:direct";
+  // Button toggles the uinput injector writes per burst tick: 32 events
+  // with their reports, half the smallest evdev client buffer.
+  static constexpr int kBurstChunk = 16;
+  // Initial capacity of each event queue buffer; covers a busy pad at 1 kHz
+  // for a couple of drain periods before the buffers ever have to grow.
+  static constexpr size_t kInitialQueueCapacity = 256;
+  // PendingEvent::type of an axis event superseded later in its batch.
+  static constexpr int kDroppedEvent = -1;
+
+  /// A queued event.  Button and axis events are plain data; connection
+  /// and battery events (rare) carry a prebuilt FlValue.
+  struct PendingEvent {
+    // Wire format type tag: 0 = connection, 1 = button, 2 = axis,
+    // 3 = pointer (value is dx).
+    int type;
+    int gamepad_id;
+    int64_t timestamp;
+    int index;
+    bool pressed;
+    double value;
+    // Owned reference, connection events only.
+    FlValue* connection;
+    // Axis events only: summary of the raw samples since the previous
+    // delivered event of the axis.
+    AxisWindow::Summary window;
+    // Pointer events only.
+    double delta_y;
+  };
 
   struct DeviceInfo {
     int fd;
@@ -46,49 +331,426 @@ class EvdevManager {
     std::string name;
     uint16_t vendor_id;
     uint16_t product_id;
+    // Fixed at probe time; reported by ListGamepads.
+    DeviceCapabilities capabilities;
+    // DeviceIdentity key, "" if the pad has none.  |reconnected| is set when
+    // it came back under the id it had before.
+    std::string identity;
+    bool reconnected;
+    // power_supply name of the pad's battery ("" if none found yet) and
+    // its last read state.  Written by the worker under mutex_.
+    std::string battery;
+    BatteryState battery_state;
     struct input_absinfo abs_info[ABS_MAX];
     GSource* io_source;
     // Last emitted axis values for throttling (indexed by W3C axis).
     double last_axis[4];
     // Last emitted trigger values for throttling (indexed by W3C button).
     double last_trigger[2];
+    // Processed state (indexed by W3C button / axis).
+    double buttons[ButtonMapping::kButtonCount];
+    double axes[ButtonMapping::kAxisCount];
+    // Forwarding target, present only while forwarding is enabled.
+    std::unique_ptr<VirtualGamepad> virtual_pad;
+    bool grabbed;
+    // Report cadence, fed from SYN_REPORT kernel timestamps.
+    std::unique_ptr<ReportRateMeter> report_rate;
+    // Analog values and their derivatives, fed from every raw sample.
+    std::unique_ptr<SignalDynamics> dynamics;
+    // Last value queued for delivery, per W3C button / axis.
+    double delivered_buttons[ButtonMapping::kButtonCount];
+    double delivered_axes[ButtonMapping::kAxisCount];
+    // Stick-to-cursor integration; registered in pointers_.
+    std::unique_ptr<PointerEmulator> pointer;
+    // Position of the last queued event of each axis in pending_events_,
+    // valid while pending_axis_batch matches queue_batch_.  Protected by
+    // queue_mutex_.
+    size_t pending_axis[ButtonMapping::kAxisCount];
+    uint64_t pending_axis_batch[ButtonMapping::kAxisCount];
+    // Raw samples since the last queued event, per W3C axis.
+    AxisWindow axis_window[ButtonMapping::kAxisCount];
+    // Raw passthrough: enabled flag and records of the current read.
+    // Worker only.
+    bool raw;
+    std::vector<RawInputRecord> raw_records;
   };
 
-  static int64_t NowMillis();
+  /// A device opened and classified by ProbeDevice(), waiting to be
+  /// attached by the worker.  Releases the fd and libevdev handle if it is
+  /// dropped before then.
+  struct ProbedDevice {
+    std::string path;
+    DeviceInfo info{};
+    ProbeTiming timing;
+    ~ProbedDevice();
+  };
+
+  int64_t NowMillis() { return clock_->NowMillis(); }
+
+  /// Resets the throttling state of |info| so the next value always fires.
+  static void ResetThrottle(DeviceInfo& info);
+
+  /// The settings a flight recorder dump needs to replay the same way:
+  ///
+  ///   pipeline <key>=<value>   (PipelineConfig::ToKeyValues())
+  ///   drain <min_ms> <max_ms> <interval_ms> <load_factor> <event_cost_us>
+  ///         <fastest_rate_hz>
+  ///   coalescing <AxisCoalescing of each W3C axis>
+  ///
+  /// Main thread only.
+  std::vector<std::string> DumpSettings();
+
+  /// Applies settings written by DumpSettings() to a replay pipeline
+  /// before its first drain is scheduled.  Unknown lines are skipped.
+  void ApplyDumpSettings(const std::vector<std::string>& settings);
+
   bool IsGamepad(struct libevdev* dev);
   void ScanDevices();
   void AddDevice(const char* path);
+
+  /// Opens |path| and builds its device record if it is a gamepad.
+  /// Blocking; probe thread, or any thread before the worker starts.
+  std::unique_ptr<ProbedDevice> ProbeDevice(const char* path);
+
+  /// Takes over |probed|, starts reading it and announces the connection.
+  /// Dropped if the same node is already attached; an entry left for an
+  /// earlier node at the path is removed first.  Worker thread only.
+  void AttachDevice(ProbedDevice& probed);
+
+  /// Picks the id of |info|: the one its identity had before, with the
+  /// state parked when it went away restored into |info|, or a new one.
+  /// Worker thread only.
+  int ClaimId(DeviceInfo& info);
+
+  /// Parks the state of the disconnecting |info| with its identity for
+  /// ClaimId().  Worker thread only.
+  void ParkIdentity(DeviceInfo& info);
+
+  /// Adds |timing| to the probe log.  Any thread.
+  void LogProbe(const ProbeTiming& timing);
+
+  /// Notes the delivery of an input event of |gamepad_id|.  The first one
+  /// since the device connected is stamped into its probe log entry.  Main
+  /// thread only.
+  void NoteDelivered(int gamepad_id) {
+    if (first_event_seen_.count(gamepad_id)) return;
+    NoteFirstEvent(gamepad_id);
+  }
+  void NoteFirstEvent(int gamepad_id);
+
+  /// Forgets the first event of the gamepad of |event| if it is a
+  /// disconnection.  Main thread only.
+  void NoteConnectionDelivered(FlValue* event);
   void RemoveDevice(const char* path);
   void OnInput(DeviceInfo& info);
 
-  /// Queue an event for delivery on the next timer tick.
+  /// Maps one evdev event of |info| to W3C button/axis events.  |time_us|
+  /// is the kernel timestamp of the event.
+  void ProcessEvent(DeviceInfo& info, const struct input_event& ev,
+                    int64_t time_us);
+
+  /// Updates the processed state of |info| and queues a button/axis event.
+  /// |time_us| is the kernel timestamp of the evdev event.
+  void EmitButton(DeviceInfo& info, int index, bool pressed, double value,
+                  int64_t time_us);
+  void EmitAxis(DeviceInfo& info, int index, double value, int64_t time_us);
+
+  /// Records a connection change of |info| in the flight recorder and, if
+  /// journaling, the journal.
+  void RecordConnection(const DeviceInfo& info, bool connected);
+
+  /// Builds a connection event for |info|.  Caller owns the returned value.
+  FlValue* NewConnectionEvent(const DeviceInfo& info, bool connected);
+
+  /// Builds a battery event for |info|.  Caller owns the returned value.
+  FlValue* NewBatteryEvent(const DeviceInfo& info);
+
+  /// Re-reads the battery of every device whose power_supply is |changed|
+  /// (all devices if empty), looking up batteries registered after their
+  /// pad, and queues a battery event for each one that changed.  Worker
+  /// thread only.
+  void RefreshBatteries(const std::string& changed);
+
+  /// Wire fields of a queued button, axis or pointer event, with the
+  /// window summary of axis events for |mode|.
+  static InputWireEvent ToWire(const PendingEvent& event,
+                               AxisCoalescing mode);
+
+  /// Creates or tears down the virtual pad and grab of |info| to match the
+  /// current forwarding settings.  Devices without an evdev handle (the
+  /// direct injector) are left alone.  Worker thread only.
+  void ApplyForwarding(DeviceInfo& info);
+
+  /// Writes the next chunk of a uinput burst.  GSourceFunc on the main
+  /// loop.
+  static gboolean InjectBurstChunk(gpointer user_data);
+
+  /// Runs |task| on the worker thread on its next loop iteration.
+  void RunOnWorker(std::function<void()> task);
+
+  /// Hands the worker's reference to |journal| to an idle source on the
+  /// main context, so the writer is destroyed on the main thread: its
+  /// destructor waits for the last chunks to reach the disk, and the
+  /// worker must not block on that.  Worker thread only.
+  void ReleaseJournal(std::shared_ptr<InputJournalWriter> journal);
+
+  /// Queue a connection or battery event for delivery on the next timer
+  /// tick.
   void ForwardEvent(FlValue* event);
 
-  /// Main-thread timer callback that drains pending_events_.
+  /// Queue a button (type 1) or axis (type 2) event of |info| for delivery
+  /// on the next timer tick, superseding an axis event still queued for the
+  /// same axis.
+  void ForwardInput(DeviceInfo& info, int type, int index, bool pressed,
+                    double value);
+
+  /// Hands the raw records of |info| over for delivery.  Worker only.
+  void ForwardRaw(DeviceInfo& info);
+
+  /// Builds the wire format of a raw batch.  Caller owns the returned
+  /// value.
+  FlValue* NewRawEvent(int gamepad_id,
+                       const std::vector<RawInputRecord>& records);
+
+  /// Queues a pointer event for every device whose emulated cursor moved
+  /// since the previous call.  queue_mutex_ must be held.
+  void QueuePointerMotion();
+
+  /// Discards cursor motion integrated so far.  queue_mutex_ must be held.
+  void ResetPointerMotion();
+
+  /// Starts or stops the drain timer to match the current mode, gating and
+  /// pointer emulation.  Main thread only.
+  void UpdateDrainTimer();
+
+  /// Hands |event| to the callback right away (inline mode).
+  void DeliverNow(FlValue* event);
+  void DeliverInputNow(const InputWireEvent& event);
+
+  /// Passes |event| to |input_cb|, or as a wire list to |cb| when there is
+  /// no input callback.
+  static void DeliverInput(const InputWireEvent& event,
+                           const EventCallback& cb,
+                           const InputCallback& input_cb);
+
+  /// Queues the controls whose state differs from what was last delivered.
+  /// Worker thread only.
+  void EmitStateSnapshot();
+  void EmitStateDiff(DeviceInfo& info);
+
+  /// Main-thread timer callback that drains pending_events_ and records
+  /// the tick in the flight recorder.
   static gboolean DrainEvents(gpointer user_data);
 
+  /// Delivers the next batch for a tick that started at |start_us| and
+  /// returns how many events it delivered.  Main thread only.
+  size_t Drain(int64_t start_us);
+
+  /// Books a finished tick in the metrics and adapts delivery to it.
+  void FinishDrain(int64_t lateness_us, int64_t cost_us, size_t delivered);
+
+  /// Starts the drain timer with |interval_ms|.  Main thread only.
+  void ScheduleDrain(guint interval_ms);
+
+  /// Moves the running drain timer to |interval_ms|, keeping its source so
+  /// adapting the cadence allocates nothing.  Main thread only.
+  void RescheduleDrain(guint interval_ms);
+
+  /// Updates the drain interval and batch budget after a tick that started
+  /// |lateness_us| behind schedule and spent |cost_us| delivering
+  /// |delivered| events.
+  void AdaptDelivery(int64_t lateness_us, int64_t cost_us, size_t delivered);
+
+  /// Highest measured report rate among connected devices, 0 if none.
+  double FastestReportRateHz();
+
+  /// Loads the config file into a new snapshot for the worker and
+  /// publishes it, along with the metrics ring it names.  Keeps the
+  /// current snapshot if the file is malformed.  Worker thread only (or
+  /// before it starts).
+  void ReloadConfig();
+
+  /// Opens, reopens or closes config_metrics_ring_ to match |config|, so
+  /// the file is created and sized off the main thread.  Worker thread
+  /// only (or before it starts).
+  void OpenMetricsRing(const PipelineConfig& config);
+
+  /// Applies the published snapshot's main-thread settings (the drain
+  /// bounds and the metrics ring).  Main thread only.
+  void ApplyPublishedConfig();
+
+  /// Takes over |ring| from the worker and sets the metrics timer to
+  /// |config|'s interval.  Main thread only.
+  void ApplyMetricsConfig(const PipelineConfig& config,
+                          std::shared_ptr<MetricsRing> ring);
+
+  /// Appends the current counters and device cadences to the metrics ring.
+  /// Main thread only.
+  void WriteMetrics();
+
+  static gboolean OnMetricsTick(gpointer user_data);
+
+  static void OnConfigChanged(GFileMonitor* monitor, GFile* file,
+                              GFile* other, GFileMonitorEvent event_type,
+                              gpointer user_data);
+
+  /// Worker timer re-reading batteries where uevents are unavailable.
+  static gboolean OnBatteryPoll(gpointer user_data);
+
+  /// Main-thread SIGUSR2 handler that dumps the flight recorder.
+  static gboolean OnDumpSignal(gpointer user_data);
+
   static void OnDirectoryChanged(GFileMonitor* monitor, GFile* file,
                                   GFile* other, GFileMonitorEvent event_type,
                                   gpointer user_data);
   static gpointer ThreadFunc(gpointer user_data);
+  static gpointer ProbeThreadFunc(gpointer user_data);
+
+  // Set at construction; NowMicros() is safe from any thread, timers are
+  // main thread only.
+  std::unique_ptr<PipelineClock> clock_;
+
+  // Probe thread state — the directory monitor fires on probe_context_.
+  GMainContext* probe_context_ = nullptr;
+  GMainLoop* probe_loop_ = nullptr;
+  GThread* probe_thread_ = nullptr;
+  GFileMonitor* dir_monitor_ = nullptr;
+  gulong dir_monitor_signal_id_ = 0;
 
   // Worker thread state — accessed only from the worker thread.
   GMainContext* worker_context_ = nullptr;
   GMainLoop* worker_loop_ = nullptr;
   GThread* worker_thread_ = nullptr;
-  GFileMonitor* dir_monitor_ = nullptr;
-  gulong dir_monitor_signal_id_ = 0;
   std::unordered_map<std::string, DeviceInfo> devices_;
   int next_id_ = 0;
+  bool forward_enabled_ = false;
+  bool forward_grab_ = false;
+  std::shared_ptr<InputJournalWriter> journal_;
+  // Battery change sources on worker_context_; one of them is set while
+  // running.
+  std::unique_ptr<UeventMonitor> uevents_;
+  GSource* battery_poll_ = nullptr;
+  // Snapshot read per event, without locking; replaced only by
+  // ReloadConfig().  The file monitor fires on worker_context_.
+  std::shared_ptr<const PipelineConfig> config_ =
+      std::make_shared<const PipelineConfig>();
+  // The metrics ring opened for config_; the main thread appends to it once
+  // it has been published.
+  std::shared_ptr<MetricsRing> config_metrics_ring_;
+  std::string config_path_;
+  GFileMonitor* config_monitor_ = nullptr;
+  gulong config_monitor_signal_id_ = 0;
+
+  // Ids by DeviceIdentity key, kept across reconnects and restarts.  While
+  // a pad is away its measured cadence, raw passthrough setting and the
+  // state Dart last saw are parked here.
+  struct Identity {
+    int id;
+    bool attached;
+    int64_t parked_at_us;
+    bool raw;
+    std::unique_ptr<ReportRateMeter> report_rate;
+    double delivered_buttons[ButtonMapping::kButtonCount];
+    double delivered_axes[ButtonMapping::kAxisCount];
+  };
+  std::unordered_map<std::string, Identity> identities_;
+
+  // GSources created per device or per worker task and not yet destroyed.
+  std::atomic<int> live_sources_{0};
+
+  // Benchmark injector — main thread only.
+  std::unique_ptr<VirtualGamepad> injector_pad_;
+  bool direct_injector_ = false;
+  // Pending uinput burst of InjectBurst().
+  guint burst_timer_id_ = 0;
+  int burst_index_ = 0;
+  int burst_remaining_ = 0;
+  bool burst_pressed_ = false;
+
+  // Written by the worker, dumped from the main thread; lock-free.
+  FlightRecorder recorder_;
+  GSource* dump_signal_ = nullptr;
 
   // Shared state — protected by mutex_.
   std::mutex mutex_;
   EventCallback callback_;
+  InputCallback input_callback_;
+  std::deque<ProbeTiming> probe_log_;
+  std::shared_ptr<const PipelineConfig> published_config_;
+  std::shared_ptr<MetricsRing> published_metrics_ring_;
+  // Version of published_config_ (lock-free), checked every drain against
+  // the version the main thread last applied (main thread only).
+  std::atomic<uint64_t> config_version_{0};
+  uint64_t applied_config_version_ = 0;
+
+  // Startup timings (monotonic us), and the connected gamepad ids whose
+  // first input event has been delivered — main thread only.
+  int64_t started_at_us_ = 0;
+  int64_t start_us_ = 0;
+  int64_t scan_at_us_ = 0;
+  int64_t scan_us_ = 0;
+  std::unordered_set<int> first_event_seen_;
 
-  // Event queue — protected by queue_mutex_.
+  // Event queue — protected by queue_mutex_.  queue_batch_ is bumped every
+  // time the queue is swapped out, invalidating DeviceInfo::pending_axis.
   std::mutex queue_mutex_;
-  std::vector<FlValue*> pending_events_;
-  GSource* drain_timer_ = nullptr;
+  std::vector<PendingEvent> pending_events_;
+  uint64_t queue_batch_ = 1;
+  guint drain_timer_id_ = 0;
+
+  // Pointer emulation — protected by queue_mutex_, which the worker only
+  // takes for it while pointer_enabled_ is set.
+  std::atomic<bool> pointer_enabled_{false};
+  PointerSettings pointer_settings_;
+  std::vector<std::pair<int, PointerEmulator*>> pointers_;
+
+  // Raw passthrough batches, one per device that has had raw passthrough
+  // since it connected.  Each drain swaps the records of raw_batches_ with
+  // the emptied ones of drain_raw_, so both keep their capacity and raw
+  // mode does not reallocate per tick.  Protected by queue_mutex_;
+  // drain_raw_ is main thread only.
+  struct RawBatch {
+    int gamepad_id;
+    std::vector<RawInputRecord> records;
+  };
+  std::vector<RawBatch> raw_batches_;
+  std::vector<RawBatch> drain_raw_;
+
+  // Set from the main thread, read by the worker.
+  std::atomic<bool> input_gated_{false};
+
+  // Fixed while running.  In inline mode the worker and probe contexts
+  // are the default main context, whose pending worker tasks are tracked
+  // in inline_tasks_ so Stop() can cancel them.
+  ThreadingMode threading_mode_ = ThreadingMode::kThreaded;
+  std::vector<GSource*> inline_tasks_;
+
+  // Batch being delivered and how far delivery got — main thread only.
+  std::vector<PendingEvent> drain_events_;
+  size_t drain_pos_ = 0;
+
+  // Adaptive delivery — main thread only.
+  guint min_drain_ms_ = kDefaultMinDrainMs;
+  guint max_drain_ms_ = kDefaultMaxDrainMs;
+  guint drain_interval_ms_ = kDefaultMaxDrainMs;
+  int64_t next_drain_due_us_ = 0;
+  int64_t last_delivery_us_ = 0;
+  double load_factor_ = 1.0;
+  double event_cost_us_ = 0.0;
+  size_t max_drain_batch_ = SIZE_MAX;
+  double fastest_rate_hz_ = 0.0;
+  int ticks_since_rate_check_ = 0;
+
+  // Per W3C axis — main thread only.
+  AxisCoalescing axis_coalescing_[ButtonMapping::kAxisCount] = {};
+
+  // Metrics ring — main thread only.  metrics_ accumulates the counters
+  // and histograms of the session; WriteMetrics() fills in the rest and
+  // appends it.
+  std::shared_ptr<MetricsRing> metrics_ring_;
+  guint metrics_timer_id_ = 0;
+  guint metrics_interval_s_ = 0;
+  MetricsSnapshot metrics_ = {};
 };
 
 #endif  // EVDEV_MANAGER_H_
@@ -0,0 +1,285 @@
+#include "flight_recorder.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+constexpr uint64_t kTimeMask = (uint64_t{1} << 48) - 1;
+constexpr int kGamepadShift = 48;
+constexpr uint64_t kGamepadMask = 0x7fff;
+constexpr uint64_t kProcessedBit = uint64_t{1} << 63;
+constexpr uint64_t kStreamedBit = uint64_t{1} << 63;
+
+const char* ProcessedName(uint8_t type) {
+  switch (type) {
+    case 0:
+      return "connection";
+    case 1:
+      return "button";
+    case 2:
+      return "axis";
+    default:
+      return "unknown";
+  }
+}
+
+int64_t NowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+FlightRecorder::FlightRecorder()
+    : base_us_(NowMicros()),
+      slots_(new Slot[kCapacity]),
+      drain_slots_(new Slot[kDrainCapacity]) {
+  for (size_t i = 0; i < kCapacity; ++i) {
+    slots_[i].sequence.store(0, std::memory_order_relaxed);
+    slots_[i].header.store(0, std::memory_order_relaxed);
+    slots_[i].payload.store(0, std::memory_order_relaxed);
+  }
+  for (size_t i = 0; i < kDrainCapacity; ++i) {
+    drain_slots_[i].sequence.store(0, std::memory_order_relaxed);
+    drain_slots_[i].header.store(0, std::memory_order_relaxed);
+    drain_slots_[i].payload.store(0, std::memory_order_relaxed);
+  }
+}
+
+FlightRecorder::~FlightRecorder() = default;
+
+void FlightRecorder::RecordRaw(int gamepad_id, int64_t time_us,
+                               const struct input_event& ev, bool streamed) {
+  uint64_t payload = (streamed ? kStreamedBit : 0) |
+                     (static_cast<uint64_t>(ev.type & 0x7fff) << 48) |
+                     (static_cast<uint64_t>(ev.code) << 32) |
+                     static_cast<uint32_t>(ev.value);
+  Record(gamepad_id, time_us, false, payload);
+}
+
+void FlightRecorder::RecordProcessed(int gamepad_id, int64_t time_us,
+                                     uint8_t type, uint8_t index,
+                                     double value) {
+  float f = static_cast<float>(value);
+  uint32_t bits;
+  memcpy(&bits, &f, sizeof(bits));
+  uint64_t payload = (static_cast<uint64_t>(type) << 56) |
+                     (static_cast<uint64_t>(index) << 48) | bits;
+  Record(gamepad_id, time_us, true, payload);
+}
+
+void FlightRecorder::RecordDrain(int64_t time_us, int64_t lateness_us,
+                                 int64_t cost_us) {
+  int64_t rel = time_us - base_us_;
+  uint64_t header = static_cast<uint64_t>(rel < 0 ? 0 : rel) & kTimeMask;
+  uint64_t payload =
+      (static_cast<uint64_t>(static_cast<uint32_t>(lateness_us)) << 32) |
+      static_cast<uint32_t>(cost_us);
+  Store(drain_slots_.get(), kDrainCapacity, drain_head_, header, payload);
+}
+
+void FlightRecorder::Record(int gamepad_id, int64_t time_us, bool processed,
+                            uint64_t payload) {
+  int64_t rel = time_us - base_us_;
+  uint64_t header = (static_cast<uint64_t>(rel < 0 ? 0 : rel) & kTimeMask) |
+                    ((static_cast<uint64_t>(gamepad_id) & kGamepadMask)
+                     << kGamepadShift) |
+                    (processed ? kProcessedBit : 0);
+  Store(slots_.get(), kCapacity, head_, header, payload);
+}
+
+// static
+void FlightRecorder::Store(Slot* slots, size_t capacity,
+                           std::atomic<uint64_t>& head, uint64_t header,
+                           uint64_t payload) {
+  uint64_t pos = head.load(std::memory_order_relaxed);
+  Slot& slot = slots[pos & (capacity - 1)];
+  slot.sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.header.store(header, std::memory_order_relaxed);
+  slot.payload.store(payload, std::memory_order_relaxed);
+  slot.sequence.store(pos + 1, std::memory_order_release);
+  head.store(pos + 1, std::memory_order_release);
+}
+
+// static
+std::vector<std::pair<uint64_t, uint64_t>> FlightRecorder::Snapshot(
+    const Slot* slots, size_t capacity, const std::atomic<uint64_t>& head) {
+  uint64_t end = head.load(std::memory_order_acquire);
+  uint64_t begin = end > capacity ? end - capacity : 0;
+
+  // A record is kept only if its slot held its sequence both before and
+  // after the copy; otherwise the writer reused the slot meanwhile.
+  std::vector<std::pair<uint64_t, uint64_t>> records;
+  records.reserve(end - begin);
+  for (uint64_t i = begin; i < end; ++i) {
+    const Slot& slot = slots[i & (capacity - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != i + 1) continue;
+    uint64_t header = slot.header.load(std::memory_order_relaxed);
+    uint64_t payload = slot.payload.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != i + 1) continue;
+    records.emplace_back(header, payload);
+  }
+  return records;
+}
+
+void FlightRecorder::RecordDevice(
+    int gamepad_id, const struct input_absinfo (&abs_info)[ABS_MAX]) {
+  std::lock_guard<std::mutex> lock(devices_mutex_);
+  PruneDevices();
+  DeviceRanges& device = ranges_[gamepad_id];
+  device.ranges.clear();
+  device.forgotten_at = 0;
+  for (uint16_t code = 0; code < ABS_MAX; ++code) {
+    const struct input_absinfo& ai = abs_info[code];
+    if (ai.minimum == ai.maximum) continue;
+    device.ranges.push_back({gamepad_id, code, ai.minimum, ai.maximum});
+  }
+}
+
+void FlightRecorder::ForgetDevice(int gamepad_id) {
+  std::lock_guard<std::mutex> lock(devices_mutex_);
+  auto it = ranges_.find(gamepad_id);
+  if (it != ranges_.end()) {
+    // Never 0, which marks a connected gamepad.
+    it->second.forgotten_at = head_.load(std::memory_order_relaxed) + 1;
+  }
+  PruneDevices();
+}
+
+void FlightRecorder::PruneDevices() {
+  uint64_t head = head_.load(std::memory_order_relaxed);
+  for (auto it = ranges_.begin(); it != ranges_.end();) {
+    uint64_t forgotten_at = it->second.forgotten_at;
+    // The last record of the gamepad has index forgotten_at - 2, and is
+    // overwritten once kCapacity more have been written.
+    if (forgotten_at && head + 1 >= forgotten_at + kCapacity) {
+      it = ranges_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+bool FlightRecorder::Dump(const std::string& path, int64_t window_us,
+                          const std::vector<std::string>& settings) const {
+  uint64_t end = head_.load(std::memory_order_acquire);
+  std::vector<std::pair<uint64_t, uint64_t>> records =
+      Snapshot(slots_.get(), kCapacity, head_);
+  std::vector<std::pair<uint64_t, uint64_t>> drains =
+      Snapshot(drain_slots_.get(), kDrainCapacity, drain_head_);
+
+  FILE* file = fopen(path.c_str(), "w");
+  if (!file) return false;
+
+  int64_t now = NowMicros();
+  fprintf(file, "# universal_gamepad flight recorder\n");
+  fprintf(file, "# dumped_at_us %lld window_us %lld total_records %llu\n",
+          static_cast<long long>(now), static_cast<long long>(window_us),
+          static_cast<unsigned long long>(end));
+  if (!records.empty()) {
+    fprintf(file, "# oldest_us %lld\n",
+            static_cast<long long>(
+                base_us_ +
+                static_cast<int64_t>(records.front().first & kTimeMask)));
+  }
+  for (const std::string& setting : settings) {
+    fprintf(file, "# set %s\n", setting.c_str());
+  }
+  {
+    std::lock_guard<std::mutex> lock(devices_mutex_);
+    for (const auto& [id, device] : ranges_) {
+      for (const AbsRange& range : device.ranges) {
+        fprintf(file, "# abs %d %u %d %d\n", range.gamepad_id, range.code,
+                range.minimum, range.maximum);
+      }
+    }
+  }
+
+  int64_t cutoff = now - window_us;
+  for (size_t i = 0; i < records.size(); ++i) {
+    uint64_t header = records[i].first;
+    uint64_t payload = records[i].second;
+    int64_t time_us = base_us_ + static_cast<int64_t>(header & kTimeMask);
+    if (time_us < cutoff) continue;
+    int gamepad = static_cast<int>((header >> kGamepadShift) & kGamepadMask);
+
+    if (header & kProcessedBit) {
+      auto type = static_cast<uint8_t>(payload >> 56);
+      auto index = static_cast<uint8_t>(payload >> 48);
+      auto bits = static_cast<uint32_t>(payload);
+      float value;
+      memcpy(&value, &bits, sizeof(value));
+      fprintf(file, "%lld %d %s %u %.4f\n", static_cast<long long>(time_us),
+              gamepad, ProcessedName(type), index, value);
+    } else {
+      fprintf(file, "%lld %d raw %u %u %d%s\n",
+              static_cast<long long>(time_us), gamepad,
+              static_cast<unsigned>((payload >> 48) & 0x7fff),
+              static_cast<unsigned>((payload >> 32) & 0xffff),
+              static_cast<int32_t>(static_cast<uint32_t>(payload)),
+              (payload & kStreamedBit) ? " streamed" : "");
+    }
+  }
+  for (const auto& [header, payload] : drains) {
+    int64_t time_us = base_us_ + static_cast<int64_t>(header & kTimeMask);
+    if (time_us < cutoff) continue;
+    fprintf(file, "%lld drain %d %d\n", static_cast<long long>(time_us),
+            static_cast<int32_t>(static_cast<uint32_t>(payload >> 32)),
+            static_cast<int32_t>(static_cast<uint32_t>(payload)));
+  }
+
+  bool ok = ferror(file) == 0;
+  fclose(file);
+  return ok;
+}
+
+// static
+bool FlightRecorder::ReadDump(const std::string& path,
+                              std::vector<std::string>* settings,
+                              std::vector<AbsRange>* ranges,
+                              std::vector<RawRecord>* raw,
+                              std::vector<DrainRecord>* drains) {
+  FILE* file = fopen(path.c_str(), "r");
+  if (!file) return false;
+
+  char line[256];
+  while (fgets(line, sizeof(line), file)) {
+    int gamepad;
+    unsigned type, code;
+    int32_t minimum, maximum, value, lateness, cost;
+    int64_t time_us;
+    int consumed = 0;
+    if (strncmp(line, "# set ", 6) == 0) {
+      std::string setting(line + 6);
+      while (!setting.empty() && setting.back() == '\n') setting.pop_back();
+      settings->push_back(std::move(setting));
+    } else if (sscanf(line, "# abs %d %u %" SCNd32 " %" SCNd32, &gamepad, &code,
+               &minimum, &maximum) == 4) {
+      ranges->push_back(
+          {gamepad, static_cast<uint16_t>(code), minimum, maximum});
+    } else if (sscanf(line, "%" SCNd64 " %d raw %u %u %" SCNd32 "%n",
+                      &time_us, &gamepad, &type, &code, &value,
+                      &consumed) == 5) {
+      RawRecord record{};
+      record.time_us = time_us;
+      record.gamepad_id = gamepad;
+      record.ev.type = static_cast<uint16_t>(type);
+      record.ev.code = static_cast<uint16_t>(code);
+      record.ev.value = value;
+      record.streamed = strncmp(line + consumed, " streamed", 9) == 0;
+      raw->push_back(record);
+    } else if (sscanf(line, "%" SCNd64 " drain %" SCNd32 " %" SCNd32,
+                      &time_us, &lateness, &cost) == 3) {
+      drains->push_back({time_us, lateness, cost});
+    }
+  }
+
+  fclose(file);
+  return true;
+}
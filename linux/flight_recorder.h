@@ -0,0 +1,173 @@
+#ifndef FLIGHT_RECORDER_H_
+#define FLIGHT_RECORDER_H_
+
+#include <linux/input.h>
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// Always-on, fixed-size ring of the most recent raw and processed input.
+///
+/// A single writer (the evdev worker) records each event with a handful of
+/// atomic stores and no locks or allocation.  Each slot carries the
+/// sequence of the record in it, cleared before and set after the record
+/// is stored, as in MetricsRing::Append().  Dump() may run concurrently on
+/// any thread: it snapshots the ring and discards every record whose slot
+/// did not hold its sequence both before and after the copy.
+///
+/// The ring holds a fixed kCapacity records, not a fixed time span: how far
+/// back a dump reaches depends on the input rate, and a dump asked for a
+/// longer window than the ring covers says so in its header.
+///
+/// A second, smaller ring keeps the main thread's drain ticks: when each
+/// started, how late it was and how long it took, which replays need to
+/// make the adaptive delivery decisions the live pipeline made.
+///
+/// Dumps are plain text, one record per line:
+///
+///   <time_us> <gamepad> raw <type> <code> <value> [streamed]
+///   <time_us> <gamepad> button|axis <index> <value>
+///   <time_us> <gamepad> connection 0 <1|0>
+///   <time_us> drain <lateness_us> <cost_us>
+///
+/// "streamed" marks raw events that raw passthrough delivered.
+///
+/// preceded by a "# oldest_us <time_us>" line giving the oldest record
+/// still in the ring, one "# set <setting>" line per pipeline setting the
+/// caller passes, and one "# abs <gamepad> <code> <min> <max>" line per
+/// absolute axis of every gamepad seen, so ReadDump() can hand a replay
+/// everything it needs to run the raw events through the pipeline again.
+class FlightRecorder {
+ public:
+  /// Range of one absolute axis of a recorded gamepad.
+  struct AbsRange {
+    int gamepad_id;
+    uint16_t code;
+    int32_t minimum;
+    int32_t maximum;
+  };
+
+  /// A raw evdev event read back from a dump.
+  struct RawRecord {
+    int64_t time_us;
+    int gamepad_id;
+    struct input_event ev;
+    // Whether raw passthrough delivered the event.
+    bool streamed;
+  };
+
+  /// A drain tick read back from a dump.
+  struct DrainRecord {
+    int64_t time_us;
+    int64_t lateness_us;
+    int64_t cost_us;
+  };
+
+  /// Ring size in records (24 bytes each, 1.5 MiB in all).  At a 1 kHz pad
+  /// reporting ~6 changes per report this holds roughly five seconds of
+  /// raw + processed input; typical Bluetooth pads keep far more.
+  static constexpr size_t kCapacity = size_t{1} << 16;
+
+  /// Drain ring size in ticks: 16 seconds at the fastest (1 ms) drain
+  /// interval, longer than the record ring covers at that rate.
+  static constexpr size_t kDrainCapacity = size_t{1} << 14;
+
+  FlightRecorder();
+  ~FlightRecorder();
+
+  FlightRecorder(const FlightRecorder&) = delete;
+  FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+  /// Records an evdev event as read from the device, and whether raw
+  /// passthrough streamed it.  Writer thread only.
+  void RecordRaw(int gamepad_id, int64_t time_us,
+                 const struct input_event& ev, bool streamed);
+
+  /// Records a processed event (wire format type tag and W3C index).
+  /// Writer thread only.
+  void RecordProcessed(int gamepad_id, int64_t time_us, uint8_t type,
+                       uint8_t index, double value);
+
+  /// Records a drain tick that started at |time_us|.  Drain thread only
+  /// (the main thread, which is not the writer of the record ring).
+  void RecordDrain(int64_t time_us, int64_t lateness_us, int64_t cost_us);
+
+  /// Remembers the absolute axis ranges of a newly connected gamepad for
+  /// the dump header, replacing any kept for |gamepad_id| before.  Hotplug
+  /// only; takes a lock.
+  void RecordDevice(int gamepad_id,
+                    const struct input_absinfo (&abs_info)[ABS_MAX]);
+
+  /// Marks |gamepad_id| as disconnected.  Its ranges are dropped once the
+  /// ring has wrapped past its last record.  Writer thread only (or while
+  /// it is stopped); takes a lock.
+  void ForgetDevice(int gamepad_id);
+
+  /// Writes |settings|, one line each, and the records of the last
+  /// |window_us| microseconds to |path|.  Returns false if the file cannot
+  /// be written.
+  bool Dump(const std::string& path, int64_t window_us,
+            const std::vector<std::string>& settings) const;
+
+  /// Reads the settings, axis ranges, raw events and drain ticks of a dump
+  /// written by Dump().  Processed records are skipped.  Returns false if
+  /// |path| cannot be read.
+  static bool ReadDump(const std::string& path,
+                       std::vector<std::string>* settings,
+                       std::vector<AbsRange>* ranges,
+                       std::vector<RawRecord>* raw,
+                       std::vector<DrainRecord>* drains);
+
+ private:
+  struct Slot {
+    // Index of the record + 1; 0 while it is being written or unused.
+    std::atomic<uint64_t> sequence;
+    // Bits 0-47: time since base_us_; bits 48-62: gamepad id; bit 63: set
+    // for processed records.
+    std::atomic<uint64_t> header;
+    // Raw: streamed(1) type(15) code(16) value(32).  Processed: type(8)
+    // index(8) unused(16) float value(32).  Drain: lateness(32) cost(32).
+    std::atomic<uint64_t> payload;
+  };
+
+  /// Axis ranges of one gamepad, and the record count when it was
+  /// forgotten (0 while connected).
+  struct DeviceRanges {
+    std::vector<AbsRange> ranges;
+    uint64_t forgotten_at = 0;
+  };
+
+  void Record(int gamepad_id, int64_t time_us, bool processed,
+              uint64_t payload);
+
+  /// Stores one record in a ring of |capacity| slots.
+  static void Store(Slot* slots, size_t capacity,
+                    std::atomic<uint64_t>& head, uint64_t header,
+                    uint64_t payload);
+
+  /// Copies the records of a ring that were not overwritten meanwhile.
+  static std::vector<std::pair<uint64_t, uint64_t>> Snapshot(
+      const Slot* slots, size_t capacity, const std::atomic<uint64_t>& head);
+
+  /// Drops the ranges of forgotten gamepads that no record in the ring
+  /// refers to any more.  Requires devices_mutex_.
+  void PruneDevices();
+
+  const int64_t base_us_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<uint64_t> head_{0};
+  std::unique_ptr<Slot[]> drain_slots_;
+  std::atomic<uint64_t> drain_head_{0};
+
+  // Axis ranges by gamepad id, of every gamepad with records in the ring —
+  // protected by devices_mutex_.
+  mutable std::mutex devices_mutex_;
+  std::map<int, DeviceRanges> ranges_;
+};
+
+#endif  // FLIGHT_RECORDER_H_
@@ -0,0 +1,73 @@
+#include "focus_gate.h"
+
+FocusGate::FocusGate(FlView* view, Callback callback)
+    : view_(GTK_WIDGET(g_object_ref(view))), callback_(std::move(callback)) {
+  hierarchy_id_ = g_signal_connect(view_, "hierarchy-changed",
+                                   G_CALLBACK(OnHierarchyChanged), this);
+  Attach();
+}
+
+FocusGate::~FocusGate() {
+  Detach();
+  g_signal_handler_disconnect(view_, hierarchy_id_);
+  g_object_unref(view_);
+}
+
+void FocusGate::Attach() {
+  GtkWidget* toplevel = gtk_widget_get_toplevel(view_);
+  if (!gtk_widget_is_toplevel(toplevel) || !GTK_IS_WINDOW(toplevel)) return;
+
+  window_ = GTK_WINDOW(g_object_ref(toplevel));
+  active_id_ = g_signal_connect(window_, "notify::is-active",
+                                G_CALLBACK(OnActiveChanged), this);
+  state_id_ = g_signal_connect(window_, "window-state-event",
+                               G_CALLBACK(OnWindowState), this);
+  iconified_ = false;
+  Update();
+}
+
+void FocusGate::Detach() {
+  if (!window_) return;
+  g_signal_handler_disconnect(window_, active_id_);
+  g_signal_handler_disconnect(window_, state_id_);
+  g_object_unref(window_);
+  window_ = nullptr;
+}
+
+void FocusGate::Update() {
+  // Without a window, or before it was ever active, there is nothing to
+  // gate on.
+  bool active = !window_ || (gtk_window_is_active(window_) && !iconified_);
+  if (active && window_) been_active_ = true;
+  if (!been_active_) active = true;
+  if (active == active_) return;
+  active_ = active;
+  callback_(active);
+}
+
+// static
+void FocusGate::OnHierarchyChanged(GtkWidget* widget, GtkWidget* previous,
+                                   gpointer user_data) {
+  auto* self = static_cast<FocusGate*>(user_data);
+  self->Detach();
+  self->Attach();
+  if (!self->window_) self->Update();
+}
+
+// static
+void FocusGate::OnActiveChanged(GObject* object, GParamSpec* pspec,
+                                gpointer user_data) {
+  static_cast<FocusGate*>(user_data)->Update();
+}
+
+// static
+gboolean FocusGate::OnWindowState(GtkWidget* widget,
+                                  GdkEventWindowState* event,
+                                  gpointer user_data) {
+  auto* self = static_cast<FocusGate*>(user_data);
+  self->iconified_ = (event->new_window_state &
+                      (GDK_WINDOW_STATE_ICONIFIED |
+                       GDK_WINDOW_STATE_WITHDRAWN)) != 0;
+  self->Update();
+  return FALSE;
+}
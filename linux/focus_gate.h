@@ -0,0 +1,57 @@
+#ifndef FOCUS_GATE_H_
+#define FOCUS_GATE_H_
+
+#include <flutter_linux/flutter_linux.h>
+#include <gtk/gtk.h>
+
+#include <functional>
+
+/// Follows whether the Flutter view's toplevel window is focused and
+/// visible.
+///
+/// Watches the window's "is-active" property and its iconified/withdrawn
+/// state, attaching once the view has been put into a window, and reports
+/// every change of the combined state.  Until the window has been active
+/// once it counts as active, so a window that never gets focus (kiosk
+/// sessions without a window manager) is not gated.  Main thread only.
+class FocusGate {
+ public:
+  /// |callback| receives true when the window becomes focused and visible
+  /// and false when it loses either.
+  using Callback = std::function<void(bool active)>;
+
+  FocusGate(FlView* view, Callback callback);
+  ~FocusGate();
+
+  FocusGate(const FocusGate&) = delete;
+  FocusGate& operator=(const FocusGate&) = delete;
+
+  bool active() const { return active_; }
+
+ private:
+  /// Connects to the view's current toplevel, if it is a window.
+  void Attach();
+  void Detach();
+  void Update();
+
+  static void OnHierarchyChanged(GtkWidget* widget, GtkWidget* previous,
+                                 gpointer user_data);
+  static void OnActiveChanged(GObject* object, GParamSpec* pspec,
+                              gpointer user_data);
+  static gboolean OnWindowState(GtkWidget* widget,
+                                GdkEventWindowState* event,
+                                gpointer user_data);
+
+  GtkWidget* view_;
+  Callback callback_;
+  gulong hierarchy_id_ = 0;
+
+  GtkWindow* window_ = nullptr;
+  gulong active_id_ = 0;
+  gulong state_id_ = 0;
+  bool iconified_ = false;
+  bool active_ = true;
+  bool been_active_ = false;
+};
+
+#endif  // FOCUS_GATE_H_
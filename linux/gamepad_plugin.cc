@@ -2,60 +2,393 @@
 
 #include "gamepad_stream_handler.h"
 #include "evdev_manager.h"
+#include "focus_gate.h"
+#include "input_journal.h"
+#include "trace_points.h"
+#ifdef UNIVERSAL_GAMEPAD_TEST_HOOKS
+#include "allocation_check.h"
+#include "idle_benchmark.h"
+#include "soak_harness.h"
+#endif
 
+#include <cmath>
 #include <cstring>
 #include <memory>
 
+// The stream handler sends input events on this name itself.
+static constexpr char kEventChannelName[] = "dev.universal_gamepad/events";
+
 // Plugin state, allocated once per registration and freed on teardown.
 struct GamepadPlugin {
   std::unique_ptr<GamepadStreamHandler> stream_handler;
   std::unique_ptr<EvdevManager> manager;
   FlMethodChannel* method_channel;
   FlEventChannel* event_channel;
+  // Declared last so it is destroyed before the manager it gates.
+  std::unique_ptr<FocusGate> focus_gate;
+  // Opt-in: apps that never call setFocusGating keep receiving input.
+  bool focus_gating = false;
+  // GLib monotonic time registration started, and how long it took.
+  int64_t registered_at_us = 0;
+  int64_t registration_us = 0;
 };
 
+// Parses "threaded" / "inline" into |mode|.  Returns false for anything else.
+static bool parse_threading_mode(const gchar* name, ThreadingMode* mode) {
+  if (g_strcmp0(name, "threaded") == 0) {
+    *mode = ThreadingMode::kThreaded;
+  } else if (g_strcmp0(name, "inline") == 0) {
+    *mode = ThreadingMode::kInline;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Gates the manager while focus gating is on and the window is unfocused
+// or minimized.
+static void apply_focus_gating(GamepadPlugin* plugin) {
+  bool active = !plugin->focus_gate || plugin->focus_gate->active();
+  plugin->manager->SetInputGated(plugin->focus_gating && !active);
+}
+
 static GamepadPlugin* g_plugin = nullptr;
 
 // ---------------------------------------------------------------------------
 // MethodChannel handler
 // ---------------------------------------------------------------------------
 
+// Reads a bool from a method-call argument map, or |fallback| if absent.
+static bool get_bool_arg(FlValue* args, const char* key, bool fallback) {
+  if (!args || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) return fallback;
+  FlValue* value = fl_value_lookup_string(args, key);
+  if (!value || fl_value_get_type(value) != FL_VALUE_TYPE_BOOL) {
+    return fallback;
+  }
+  return fl_value_get_bool(value);
+}
+
+// Reads a string from a method-call argument map, or nullptr if absent.
+static const gchar* get_string_arg(FlValue* args, const char* key) {
+  if (!args || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) return nullptr;
+  FlValue* value = fl_value_lookup_string(args, key);
+  if (!value || fl_value_get_type(value) != FL_VALUE_TYPE_STRING) {
+    return nullptr;
+  }
+  return fl_value_get_string(value);
+}
+
+// Reads an int from a method-call argument map, or |fallback| if absent.
+static int64_t get_int_arg(FlValue* args, const char* key, int64_t fallback) {
+  if (!args || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) return fallback;
+  FlValue* value = fl_value_lookup_string(args, key);
+  if (!value || fl_value_get_type(value) != FL_VALUE_TYPE_INT) {
+    return fallback;
+  }
+  return fl_value_get_int(value);
+}
+
+// Reads a double from a method-call argument map, or |fallback| if absent.
+static double get_double_arg(FlValue* args, const char* key,
+                             double fallback) {
+  if (!args || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) return fallback;
+  FlValue* value = fl_value_lookup_string(args, key);
+  if (!value) return fallback;
+  if (fl_value_get_type(value) == FL_VALUE_TYPE_FLOAT) {
+    return fl_value_get_float(value);
+  }
+  if (fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+    return static_cast<double>(fl_value_get_int(value));
+  }
+  return fallback;
+}
+
+// Converts a journal event to an event-channel wire-format list.
+static FlValue* journal_event_value(const JournalEvent& ev) {
+  FlValue* fe = fl_value_new_list();
+  fl_value_append_take(fe, fl_value_new_int(ev.type));
+  fl_value_append_take(fe, fl_value_new_int(ev.gamepad_id));
+  fl_value_append_take(fe, fl_value_new_int(ev.timestamp_us / 1000));
+  if (ev.type == 0) {
+    // Journals don't store names or ids; Dart fills in defaults.
+    fl_value_append_take(fe, fl_value_new_bool(ev.value != 0.0));
+    fl_value_append_take(fe, fl_value_new_null());
+    fl_value_append_take(fe, fl_value_new_null());
+    fl_value_append_take(fe, fl_value_new_null());
+  } else if (ev.type == 1) {
+    fl_value_append_take(fe, fl_value_new_int(ev.index));
+    fl_value_append_take(fe, fl_value_new_bool(ev.value > 0.5));
+    fl_value_append_take(fe, fl_value_new_float(ev.value));
+  } else {
+    fl_value_append_take(fe, fl_value_new_int(ev.index));
+    fl_value_append_take(fe, fl_value_new_float(ev.value));
+  }
+  return fe;
+}
+
+// Decodes the journal state at |from_ms| followed by up to |max_events|
+// journal events at or after it into a list of event-channel wire-format
+// lists.  The state is a connection event for every pad connected at
+// |from_ms| and all of its buttons and axes; it does not count towards
+// |max_events|.  Returns nullptr if the journal cannot be read.
+static FlValue* read_journal(const gchar* path, int64_t from_ms,
+                             int64_t max_events) {
+  InputJournalReader reader;
+  if (!reader.Open(path)) return nullptr;
+
+  FlValue* list = fl_value_new_list();
+  if (!reader.Seek(from_ms * 1000)) return list;
+
+  std::vector<JournalEvent> state;
+  reader.SeekState(&state);
+  for (const JournalEvent& ev : state) {
+    fl_value_append_take(list, journal_event_value(ev));
+  }
+  JournalEvent ev;
+  for (int64_t n = 0; n < max_events && reader.Next(&ev); ++n) {
+    fl_value_append_take(list, journal_event_value(ev));
+  }
+  return list;
+}
+
+// Replays the raw input of a flight recorder dump in simulated time.
+// Returns a map with the first |max_events| delivered events, the delivered
+// count, the recorded span and the wall time the replay took, or nullptr if
+// the dump cannot be read.
+static FlValue* replay_flight_record(const gchar* path, int64_t max_events) {
+  FlValue* events = fl_value_new_list();
+  int64_t delivered = 0;
+  int64_t first_ms = 0;
+  int64_t last_ms = 0;
+  int64_t start_us = g_get_monotonic_time();
+  bool ok = EvdevManager::ReplayFlightRecord(path, [&](FlValue* event) {
+    int64_t ts = fl_value_get_int(fl_value_get_list_value(event, 2));
+    if (delivered == 0) first_ms = ts;
+    last_ms = ts;
+    if (delivered < max_events) fl_value_append(events, event);
+    ++delivered;
+  });
+  int64_t elapsed_us = g_get_monotonic_time() - start_us;
+  if (!ok) {
+    fl_value_unref(events);
+    return nullptr;
+  }
+
+  FlValue* result = fl_value_new_map();
+  fl_value_set_string_take(result, "events", events);
+  fl_value_set_string_take(result, "delivered", fl_value_new_int(delivered));
+  fl_value_set_string_take(result, "recordedMs",
+                           fl_value_new_int(last_ms - first_ms));
+  fl_value_set_string_take(result, "elapsedUs", fl_value_new_int(elapsed_us));
+  return result;
+}
+
 static void method_call_cb(FlMethodChannel* channel,
                            FlMethodCall* method_call,
                            gpointer user_data) {
   auto* plugin = static_cast<GamepadPlugin*>(user_data);
   const gchar* method = fl_method_call_get_name(method_call);
+  FlValue* args = fl_method_call_get_args(method_call);
 
+  g_autoptr(FlMethodResponse) response = nullptr;
   if (strcmp(method, "listGamepads") == 0) {
     FlValue* result = plugin->manager->ListGamepads();
-    g_autoptr(FlMethodResponse) response =
-        FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
     fl_value_unref(result);
-    g_autoptr(GError) error = nullptr;
-    fl_method_call_respond(method_call, response, &error);
-    if (error) {
-      g_warning("gamepad: failed to respond to listGamepads: %s",
-                error->message);
+  } else if (strcmp(method, "getStats") == 0) {
+    FlValue* result = plugin->manager->GetStats();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    fl_value_unref(result);
+  } else if (strcmp(method, "getDiagnostics") == 0) {
+    FlValue* result =
+        plugin->manager->GetDiagnostics(plugin->registered_at_us);
+    fl_value_set_string_take(result, "registrationUs",
+                             fl_value_new_int(plugin->registration_us));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    fl_value_unref(result);
+  } else if (strcmp(method, "getGamepadState") == 0) {
+    FlValue* result = plugin->manager->GetGamepadState(
+        get_int_arg(args, "presentationTimeUs", 0));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    fl_value_unref(result);
+  } else if (strcmp(method, "setDeliveryLatencyBounds") == 0) {
+    plugin->manager->SetDeliveryLatencyBounds(
+        static_cast<guint>(get_int_arg(args, "minMs", 4)),
+        static_cast<guint>(get_int_arg(args, "maxMs", 16)));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (strcmp(method, "setPointerEmulation") == 0) {
+    PointerSettings settings;
+    settings.x_axis = get_bool_arg(args, "rightStick", true) ? 2 : 0;
+    settings.speed = get_double_arg(args, "speed", settings.speed);
+    settings.deadzone = get_double_arg(args, "deadzone", settings.deadzone);
+    settings.curve = get_double_arg(args, "curve", settings.curve);
+    // A curve of zero or less makes every deflection full speed or worse,
+    // and a NaN anywhere poisons the cursor for good.
+    if (!std::isfinite(settings.speed) || settings.speed < 0 ||
+        !std::isfinite(settings.curve) || settings.curve <= 0 ||
+        !(settings.deadzone >= 0 && settings.deadzone < 1)) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "invalid_args",
+          "Pointer speed must be finite and non-negative, curve finite and "
+          "positive, and deadzone in [0, 1)",
+          nullptr));
+    } else {
+      plugin->manager->SetPointerEmulation(
+          get_bool_arg(args, "enabled", false), settings);
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
+  } else if (strcmp(method, "setRawPassthrough") == 0) {
+    if (plugin->manager->SetRawPassthrough(
+            static_cast<int>(get_int_arg(args, "id", -1)),
+            get_bool_arg(args, "enabled", false))) {
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    } else {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "raw_error", "No such gamepad", nullptr));
+    }
+  } else if (strcmp(method, "setFocusGating") == 0) {
+    plugin->focus_gating = get_bool_arg(args, "enabled", false);
+    apply_focus_gating(plugin);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (strcmp(method, "setAxisCoalescing") == 0) {
+    int64_t mode = get_int_arg(args, "mode", 0);
+    auto last = static_cast<int64_t>(AxisCoalescing::kDisplacement);
+    if (mode < 0 || mode > last) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "coalescing_error", "Unknown axis coalescing mode", nullptr));
+    } else {
+      plugin->manager->SetAxisCoalescing(
+          static_cast<int>(get_int_arg(args, "axis", 0)),
+          static_cast<AxisCoalescing>(mode));
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
     }
   } else if (strcmp(method, "dispose") == 0) {
     plugin->manager->Stop();
-    g_autoptr(FlMethodResponse) response =
-        FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
-    g_autoptr(GError) error = nullptr;
-    fl_method_call_respond(method_call, response, &error);
-    if (error) {
-      g_warning("gamepad: failed to respond to dispose: %s",
-                error->message);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (strcmp(method, "setForwarding") == 0) {
+    plugin->manager->SetForwarding(get_bool_arg(args, "enabled", false),
+                                   get_bool_arg(args, "grab", false));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (strcmp(method, "startJournal") == 0) {
+    const gchar* path = get_string_arg(args, "path");
+    if (path && plugin->manager->StartJournal(path)) {
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    } else {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "journal_error", "Cannot create journal file", nullptr));
     }
-  } else {
-    g_autoptr(FlMethodResponse) response =
-        FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
-    g_autoptr(GError) error = nullptr;
-    fl_method_call_respond(method_call, response, &error);
-    if (error) {
-      g_warning("gamepad: failed to respond with not-implemented: %s",
-                error->message);
+  } else if (strcmp(method, "stopJournal") == 0) {
+    plugin->manager->StopJournal();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (strcmp(method, "readJournal") == 0) {
+    const gchar* path = get_string_arg(args, "path");
+    FlValue* result =
+        path ? read_journal(path, get_int_arg(args, "from", 0),
+                            get_int_arg(args, "maxEvents", 1000))
+             : nullptr;
+    if (result) {
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+      fl_value_unref(result);
+    } else {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "journal_error", "Cannot read journal file", nullptr));
+    }
+  } else if (strcmp(method, "dumpFlightRecorder") == 0) {
+    const gchar* path = get_string_arg(args, "path");
+    if (path && plugin->manager->DumpFlightRecorder(
+                    path, get_int_arg(args, "windowMs", 30000))) {
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    } else {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "recorder_error", "Cannot write flight recorder dump", nullptr));
     }
+  } else if (strcmp(method, "replayFlightRecord") == 0) {
+    const gchar* path = get_string_arg(args, "path");
+    FlValue* result =
+        path ? replay_flight_record(path, get_int_arg(args, "maxEvents", 1000))
+             : nullptr;
+    if (result) {
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+      fl_value_unref(result);
+    } else {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "recorder_error", "Cannot read flight recorder dump", nullptr));
+    }
+#ifdef UNIVERSAL_GAMEPAD_TEST_HOOKS
+  } else if (strcmp(method, "startInjector") == 0) {
+    const char* source = plugin->manager->StartInjector();
+    g_autoptr(FlValue) result = fl_value_new_string(source);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (strcmp(method, "setThreadingMode") == 0) {
+    ThreadingMode mode;
+    if (parse_threading_mode(get_string_arg(args, "mode"), &mode)) {
+      plugin->manager->SetThreadingMode(mode);
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    } else {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "threading_error", "Unknown threading mode", nullptr));
+    }
+  } else if (strcmp(method, "stopInjector") == 0) {
+    plugin->manager->StopInjector();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (strcmp(method, "inject") == 0) {
+    // Responds with the wall-clock time of the injection in microseconds,
+    // the clock of Dart's DateTime, so the benchmark can time the pipeline
+    // without the method call.
+    int64_t injected_at_us = g_get_real_time();
+    plugin->manager->Inject(static_cast<int>(get_int_arg(args, "type", 2)),
+                            static_cast<int>(get_int_arg(args, "index", 0)),
+                            get_double_arg(args, "value", 0.0));
+    g_autoptr(FlValue) result = fl_value_new_int(injected_at_us);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (strcmp(method, "injectBurst") == 0) {
+    // Responds with the wall-clock time the burst started, as for inject.
+    int64_t injected_at_us = g_get_real_time();
+    plugin->manager->InjectBurst(
+        static_cast<int>(get_int_arg(args, "index", 0)),
+        static_cast<int>(get_int_arg(args, "count", 0)));
+    g_autoptr(FlValue) result = fl_value_new_int(injected_at_us);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (strcmp(method, "measureIdle") == 0) {
+    // Responds on its own once the measurement window has passed.
+    IdleBenchmark::Start(
+        method_call,
+        static_cast<int>(get_int_arg(args, "durationMs", 10000)),
+        static_cast<int>(get_int_arg(args, "idleDevices", 0)));
+    return;
+  } else if (strcmp(method, "runSoak") == 0) {
+    // Responds on its own once every cycle has run.
+    SoakHarness::Start(
+        method_call, plugin->manager.get(),
+        static_cast<int>(get_int_arg(args, "cycles", 1000)),
+        static_cast<int>(get_int_arg(args, "eventsPerCycle", 100)));
+    return;
+  } else if (strcmp(method, "runAllocationCheck") == 0) {
+    // Responds on its own once the counted rounds have been delivered.
+    AllocationCheck::Start(method_call, plugin->manager.get(),
+                           static_cast<int>(get_int_arg(args, "rounds", 500)));
+    return;
+#endif  // UNIVERSAL_GAMEPAD_TEST_HOOKS
+  } else if (strcmp(method, "setTracing") == 0) {
+    TracePoints::SetEnabled(get_bool_arg(args, "enabled", false));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (strcmp(method, "exportTrace") == 0) {
+    const gchar* path = get_string_arg(args, "path");
+    if (path && TracePoints::ExportChromeTrace(path)) {
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    } else {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "trace_error", "Cannot write trace file", nullptr));
+    }
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  g_autoptr(GError) error = nullptr;
+  fl_method_call_respond(method_call, response, &error);
+  if (error) {
+    g_warning("gamepad: failed to respond to %s: %s", method,
+              error->message);
   }
 }
 
@@ -65,13 +398,18 @@ static void method_call_cb(FlMethodChannel* channel,
 
 void gamepad_plugin_register_with_registrar(
     FlPluginRegistrar* registrar) {
+  int64_t registered_at_us = g_get_monotonic_time();
+
   // Clean up any previous registration (defensive).
   if (g_plugin) {
     delete g_plugin;
     g_plugin = nullptr;
   }
 
+  TracePoints::NameThread("platform");
+
   g_plugin = new GamepadPlugin();
+  g_plugin->registered_at_us = registered_at_us;
   g_plugin->stream_handler = std::make_unique<GamepadStreamHandler>();
   g_plugin->manager = std::make_unique<EvdevManager>();
 
@@ -88,17 +426,40 @@ void gamepad_plugin_register_with_registrar(
 
   // Set up the EventChannel.
   g_plugin->event_channel = fl_event_channel_new(
-      messenger, "dev.universal_gamepad/events", FL_METHOD_CODEC(codec));
-  g_plugin->stream_handler->SetChannel(g_plugin->event_channel);
+      messenger, kEventChannelName, FL_METHOD_CODEC(codec));
+  g_plugin->stream_handler->SetChannel(g_plugin->event_channel, messenger,
+                                       kEventChannelName);
 
   // Start monitoring eagerly so that listGamepads() works before the Dart
   // event stream is subscribed to. SendEvent safely no-ops when not listening.
   GamepadStreamHandler* handler = g_plugin->stream_handler.get();
   EvdevManager* manager = g_plugin->manager.get();
 
-  manager->Start([handler](FlValue* event) {
-    handler->SendEvent(event);
-  });
+  // UNIVERSAL_GAMEPAD_THREADING=inline runs everything on the main thread,
+  // which wins on single-core devices.
+  const gchar* threading = g_getenv("UNIVERSAL_GAMEPAD_THREADING");
+  ThreadingMode mode;
+  if (threading && parse_threading_mode(threading, &mode)) {
+    manager->SetThreadingMode(mode);
+  } else if (threading) {
+    g_warning("gamepad: unknown UNIVERSAL_GAMEPAD_THREADING \"%s\"",
+              threading);
+  }
+
+  manager->Start(
+      [handler](FlValue* event) { handler->SendEvent(event); },
+      [handler](const InputWireEvent& event) { handler->SendInput(event); });
+
+  // Once focus gating is enabled, stop delivering input while the window is
+  // unfocused or minimized; the manager catches Dart up with a state
+  // snapshot on refocus.
+  FlView* view = fl_plugin_registrar_get_view(registrar);
+  if (view) {
+    GamepadPlugin* plugin = g_plugin;
+    plugin->focus_gate = std::make_unique<FocusGate>(
+        view, [plugin](bool) { apply_focus_gating(plugin); });
+    apply_focus_gating(plugin);
+  }
 
   // When Dart starts listening, emit connection events for already-connected
   // gamepads. On cancel, do nothing — the monitor keeps running so
@@ -109,4 +470,5 @@ void gamepad_plugin_register_with_registrar(
           manager->EmitExistingDevices();
         }
       });
+  g_plugin->registration_us = g_get_monotonic_time() - registered_at_us;
 }
@@ -1,16 +1,24 @@
 #include "gamepad_stream_handler.h"
 
+#include "allocation_counter.h"
+#include "trace_points.h"
+
 GamepadStreamHandler::GamepadStreamHandler() = default;
 
 GamepadStreamHandler::~GamepadStreamHandler() = default;
 
-void GamepadStreamHandler::SetChannel(FlEventChannel* channel) {
+void GamepadStreamHandler::SetChannel(FlEventChannel* channel,
+                                      FlBinaryMessenger* messenger,
+                                      const gchar* name) {
   channel_ = channel;
+  messenger_ = messenger;
+  name_ = name;
   fl_event_channel_set_stream_handlers(
       channel_, OnListenCb, OnCancelCb, this, nullptr);
 }
 
 void GamepadStreamHandler::SendEvent(FlValue* event) {
+  GAMEPAD_TRACE_SCOPE("SendEvent");
   if (channel_ && listening_) {
     g_autoptr(GError) error = nullptr;
     fl_event_channel_send(channel_, event, nullptr, &error);
@@ -20,6 +28,18 @@ void GamepadStreamHandler::SendEvent(FlValue* event) {
   }
 }
 
+void GamepadStreamHandler::SendInput(const InputWireEvent& event) {
+  GAMEPAD_TRACE_SCOPE("SendEvent");
+  if (!channel_ || !listening_) return;
+  // The message fl_event_channel_send() would build for the event's wire
+  // list.  Without a reply callback the engine copies it before this
+  // returns, which is what lets the encoder reuse its buffer.
+  GBytes* message = encoder_.Encode(event);
+  GAMEPAD_SKIP_ALLOCATIONS();
+  fl_binary_messenger_send_on_channel(messenger_, name_, message, nullptr,
+                                      nullptr, nullptr);
+}
+
 bool GamepadStreamHandler::HasListener() const { return listening_; }
 
 void GamepadStreamHandler::SetListenCallback(ListenCallback callback) {
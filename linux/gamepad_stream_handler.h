@@ -5,25 +5,37 @@
 
 #include <functional>
 
+#include "input_wire.h"
+
 /// Stream handler that bridges native gamepad events to the Dart EventChannel.
 ///
 /// Wraps an FlEventChannel and registers listen/cancel callbacks. When Dart
 /// starts listening, the handler notifies the caller via a callback.
 /// When Dart cancels, the caller is notified again.
+///
+/// Button, axis and pointer events are encoded by an InputWireEncoder and
+/// sent on the channel's messenger directly, so they reach Dart as the same
+/// lists without an FlValue being built per event.
 class GamepadStreamHandler {
  public:
   GamepadStreamHandler();
   ~GamepadStreamHandler();
 
-  /// Attaches this handler to the given event channel. Must be called once
-  /// during plugin registration. Takes ownership of nothing; the channel
-  /// must outlive this handler.
-  void SetChannel(FlEventChannel* channel);
+  /// Attaches this handler to the given event channel, which was created
+  /// on |messenger| as |name|. Must be called once during plugin
+  /// registration. Takes ownership of nothing; the channel, messenger and
+  /// name must outlive this handler.
+  void SetChannel(FlEventChannel* channel, FlBinaryMessenger* messenger,
+                  const gchar* name);
 
   /// Sends an event (FlValue map) to the Dart side. No-op if nobody is
   /// listening. The caller retains ownership of |event|.
   void SendEvent(FlValue* event);
 
+  /// Sends a button, axis or pointer event to the Dart side without
+  /// allocating. No-op if nobody is listening.
+  void SendInput(const InputWireEvent& event);
+
   /// Returns true if a Dart listener is currently active.
   bool HasListener() const;
 
@@ -37,6 +49,13 @@ class GamepadStreamHandler {
   /// The FlEventChannel used to send events to Dart.
   FlEventChannel* channel_ = nullptr;
 
+  /// Where SendInput() sends its messages: the channel's messenger and
+  /// name.
+  FlBinaryMessenger* messenger_ = nullptr;
+  const gchar* name_ = nullptr;
+
+  InputWireEncoder encoder_;
+
   /// Whether the Dart side is currently listening.
   bool listening_ = false;
 
@@ -0,0 +1,213 @@
+#include "idle_benchmark.h"
+
+#include "virtual_gamepad.h"
+
+#include <dirent.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace IdleBenchmark {
+
+namespace {
+
+// Time given to the evdev worker to discover the idle pads before the
+// measurement window opens.
+constexpr guint kSettleMs = 500;
+
+struct ThreadSample {
+  std::string name;
+  unsigned long long utime_ticks = 0;
+  unsigned long long stime_ticks = 0;
+  unsigned long long voluntary = 0;
+  unsigned long long involuntary = 0;
+};
+
+struct Sample {
+  std::map<int, ThreadSample> threads;
+  struct rusage usage;
+  int64_t time_us;
+};
+
+bool ReadThread(int tid, ThreadSample* sample) {
+  char path[64];
+  snprintf(path, sizeof(path), "/proc/self/task/%d/stat", tid);
+  FILE* file = fopen(path, "r");
+  if (!file) return false;
+  char line[1024];
+  bool ok = fgets(line, sizeof(line), file) != nullptr;
+  fclose(file);
+  if (!ok) return false;
+
+  // "tid (comm) state ..." — comm may contain spaces and parentheses, so
+  // split on the last ')'.
+  char* open = strchr(line, '(');
+  char* close = strrchr(line, ')');
+  if (!open || !close || close < open) return false;
+  sample->name.assign(open + 1, close);
+  // Fields after comm start at 3 (state); utime and stime are 14 and 15.
+  if (sscanf(close + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu",
+             &sample->utime_ticks, &sample->stime_ticks) != 2) {
+    return false;
+  }
+
+  snprintf(path, sizeof(path), "/proc/self/task/%d/status", tid);
+  file = fopen(path, "r");
+  if (!file) return false;
+  while (fgets(line, sizeof(line), file)) {
+    sscanf(line, "voluntary_ctxt_switches: %llu", &sample->voluntary);
+    sscanf(line, "nonvoluntary_ctxt_switches: %llu", &sample->involuntary);
+  }
+  fclose(file);
+  return true;
+}
+
+Sample TakeSample() {
+  Sample sample;
+  DIR* dir = opendir("/proc/self/task");
+  if (dir) {
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+      int tid = atoi(entry->d_name);
+      if (tid <= 0) continue;
+      ThreadSample thread;
+      if (ReadThread(tid, &thread)) sample.threads[tid] = thread;
+    }
+    closedir(dir);
+  }
+  getrusage(RUSAGE_SELF, &sample.usage);
+  sample.time_us = g_get_monotonic_time();
+  return sample;
+}
+
+double TimevalMs(const struct timeval& tv) {
+  return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+FlValue* BuildReport(const Sample& before, const Sample& after,
+                     int idle_devices) {
+  double ms_per_tick = 1000.0 / sysconf(_SC_CLK_TCK);
+  double seconds = (after.time_us - before.time_us) / 1e6;
+
+  FlValue* process = fl_value_new_map();
+  fl_value_set_string_take(
+      process, "userMs",
+      fl_value_new_float(TimevalMs(after.usage.ru_utime) -
+                         TimevalMs(before.usage.ru_utime)));
+  fl_value_set_string_take(
+      process, "systemMs",
+      fl_value_new_float(TimevalMs(after.usage.ru_stime) -
+                         TimevalMs(before.usage.ru_stime)));
+  fl_value_set_string_take(
+      process, "voluntarySwitches",
+      fl_value_new_int(after.usage.ru_nvcsw - before.usage.ru_nvcsw));
+  fl_value_set_string_take(
+      process, "involuntarySwitches",
+      fl_value_new_int(after.usage.ru_nivcsw - before.usage.ru_nivcsw));
+
+  FlValue* threads = fl_value_new_list();
+  for (const auto& [tid, end] : after.threads) {
+    auto it = before.threads.find(tid);
+    if (it == before.threads.end()) continue;
+    const ThreadSample& start = it->second;
+    auto wakeups = static_cast<int64_t>(end.voluntary - start.voluntary);
+
+    FlValue* thread = fl_value_new_map();
+    fl_value_set_string_take(thread, "tid", fl_value_new_int(tid));
+    fl_value_set_string_take(thread, "name",
+                             fl_value_new_string(end.name.c_str()));
+    fl_value_set_string_take(
+        thread, "userMs",
+        fl_value_new_float((end.utime_ticks - start.utime_ticks) *
+                           ms_per_tick));
+    fl_value_set_string_take(
+        thread, "systemMs",
+        fl_value_new_float((end.stime_ticks - start.stime_ticks) *
+                           ms_per_tick));
+    fl_value_set_string_take(thread, "wakeups", fl_value_new_int(wakeups));
+    fl_value_set_string_take(
+        thread, "wakeupsPerSecond",
+        fl_value_new_float(seconds > 0 ? wakeups / seconds : 0.0));
+    fl_value_set_string_take(
+        thread, "involuntarySwitches",
+        fl_value_new_int(
+            static_cast<int64_t>(end.involuntary - start.involuntary)));
+    fl_value_append_take(threads, thread);
+  }
+
+  FlValue* report = fl_value_new_map();
+  fl_value_set_string_take(report, "idleDevices",
+                           fl_value_new_int(idle_devices));
+  fl_value_set_string_take(
+      report, "durationMs",
+      fl_value_new_int((after.time_us - before.time_us) / 1000));
+  fl_value_set_string_take(report, "process", process);
+  fl_value_set_string_take(report, "threads", threads);
+  return report;
+}
+
+// State of one run, owned by its pending GLib timeout.
+struct Run {
+  FlMethodCall* method_call;
+  guint duration_ms;
+  int idle_devices;
+  std::vector<std::unique_ptr<VirtualGamepad>> pads;
+  Sample before;
+};
+
+gboolean OnWindowEnd(gpointer user_data) {
+  std::unique_ptr<Run> run(static_cast<Run*>(user_data));
+  Sample after = TakeSample();
+  g_autoptr(FlValue) report =
+      BuildReport(run->before, after, run->idle_devices);
+  run->pads.clear();
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond_success(run->method_call, report, &error)) {
+    g_warning("gamepad: failed to respond to idle benchmark: %s",
+              error->message);
+  }
+  g_object_unref(run->method_call);
+  return G_SOURCE_REMOVE;
+}
+
+gboolean OnSettled(gpointer user_data) {
+  auto* run = static_cast<Run*>(user_data);
+  run->before = TakeSample();
+  g_timeout_add(run->duration_ms, OnWindowEnd, run);
+  return G_SOURCE_REMOVE;
+}
+
+}  // namespace
+
+void Start(FlMethodCall* method_call, int duration_ms, int idle_devices) {
+  auto* run = new Run();
+  run->method_call = FL_METHOD_CALL(g_object_ref(method_call));
+  run->duration_ms = static_cast<guint>(duration_ms > 0 ? duration_ms : 0);
+  run->idle_devices = 0;
+
+  for (int i = 0; i < idle_devices; ++i) {
+    g_autofree gchar* name =
+        g_strdup_printf("Universal Gamepad Idle %d", i + 1);
+    auto pad =
+        VirtualGamepad::Create(name, 0, 0, VirtualGamepad::kInjectorPhys);
+    if (!pad) break;
+    run->pads.push_back(std::move(pad));
+    ++run->idle_devices;
+  }
+
+  if (run->pads.empty()) {
+    OnSettled(run);
+  } else {
+    g_timeout_add(kSettleMs, OnSettled, run);
+  }
+}
+
+}  // namespace IdleBenchmark
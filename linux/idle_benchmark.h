@@ -0,0 +1,31 @@
+#ifndef IDLE_BENCHMARK_H_
+#define IDLE_BENCHMARK_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+/// Measures what the plugin costs while no input arrives.
+///
+/// A run optionally creates |idle_devices| uinput pads that never send
+/// anything (EvdevManager picks them up like physical pads), lets hotplug
+/// settle, and then samples every thread of the process from
+/// /proc/self/task/<tid>/{stat,status} plus getrusage() at the start and end
+/// of a |duration_ms| window.  Voluntary context switches stand in for
+/// wakeups: an idle thread only switches voluntarily when it is woken and
+/// goes back to sleep.
+///
+/// The main loop keeps running during the window, so the drain timer and any
+/// other main-context source are measured as they really behave.  The
+/// result map is sent as the response to |method_call|:
+///
+///   {idleDevices, durationMs,
+///    process: {userMs, systemMs, voluntarySwitches, involuntarySwitches},
+///    threads: [{tid, name, userMs, systemMs, wakeups, wakeupsPerSecond,
+///               involuntarySwitches}]}
+namespace IdleBenchmark {
+
+/// Starts a run that responds to |method_call| when done.  Main thread only.
+void Start(FlMethodCall* method_call, int duration_ms, int idle_devices);
+
+}  // namespace IdleBenchmark
+
+#endif  // IDLE_BENCHMARK_H_
@@ -0,0 +1,438 @@
+#include "input_journal.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr char kFileMagic[4] = {'U', 'G', 'J', '1'};
+constexpr char kChunkMagic[4] = {'U', 'G', 'J', 'C'};
+constexpr uint32_t kVersion = 1;
+constexpr double kScale = 32767.0;
+
+constexpr uint8_t kIndexMask = 0x1f;
+constexpr int kTypeShift = 5;
+constexpr uint8_t kTypeMask = 0x3;
+constexpr uint8_t kNewGamepadBit = 0x80;
+
+void PutU32(uint8_t* out, uint32_t v) {
+  for (int i = 0; i < 4; ++i) out[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+void PutI64(uint8_t* out, int64_t v) {
+  auto u = static_cast<uint64_t>(v);
+  for (int i = 0; i < 8; ++i) out[i] = static_cast<uint8_t>(u >> (8 * i));
+}
+
+uint32_t GetU32(const uint8_t* in) {
+  uint32_t v = 0;
+  for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(in[i]) << (8 * i);
+  return v;
+}
+
+int64_t GetI64(const uint8_t* in) {
+  uint64_t v = 0;
+  for (int i = 0; i < 8; ++i) v |= static_cast<uint64_t>(in[i]) << (8 * i);
+  return static_cast<int64_t>(v);
+}
+
+void PutVarint(std::vector<uint8_t>& out, uint64_t v) {
+  while (v >= 0x80) {
+    out.push_back(static_cast<uint8_t>(v) | 0x80);
+    v >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(v));
+}
+
+void PutZigzag(std::vector<uint8_t>& out, int64_t v) {
+  PutVarint(out, (static_cast<uint64_t>(v) << 1) ^
+                     static_cast<uint64_t>(v >> 63));
+}
+
+bool GetVarint(const std::vector<uint8_t>& in, size_t& pos, uint64_t* v) {
+  uint64_t result = 0;
+  for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+    uint8_t byte = in[pos++];
+    result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      *v = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool GetZigzag(const std::vector<uint8_t>& in, size_t& pos, int64_t* v) {
+  uint64_t u;
+  if (!GetVarint(in, pos, &u)) return false;
+  *v = static_cast<int64_t>(u >> 1) ^ -static_cast<int64_t>(u & 1);
+  return true;
+}
+
+// Index into PadState::controls for a button/axis event, or -1.
+int ControlSlot(uint8_t type, uint8_t index) {
+  if (type == 1 && index < ButtonMapping::kButtonCount) return index;
+  if (type == 2 && index < ButtonMapping::kAxisCount) {
+    return ButtonMapping::kButtonCount + index;
+  }
+  return -1;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// InputJournalWriter
+// ---------------------------------------------------------------------------
+
+std::unique_ptr<InputJournalWriter> InputJournalWriter::Open(
+    const std::string& path) {
+  FILE* file = fopen(path.c_str(), "wb");
+  if (!file) return nullptr;
+
+  uint8_t header[8];
+  memcpy(header, kFileMagic, 4);
+  PutU32(header + 4, kVersion);
+  if (fwrite(header, 1, sizeof(header), file) != sizeof(header)) {
+    fclose(file);
+    return nullptr;
+  }
+  return std::unique_ptr<InputJournalWriter>(new InputJournalWriter(file));
+}
+
+InputJournalWriter::InputJournalWriter(FILE* file) : file_(file) {
+  chunk_.reserve(kChunkBytes + 256);
+  flush_thread_ = std::thread(&InputJournalWriter::FlushLoop, this);
+}
+
+InputJournalWriter::~InputJournalWriter() {
+  {
+    std::lock_guard<std::mutex> lock(encoder_mutex_);
+    SealChunk();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_one();
+  flush_thread_.join();
+  fclose(file_);
+}
+
+void InputJournalWriter::Append(const JournalEvent& event) {
+  std::lock_guard<std::mutex> encoder_lock(encoder_mutex_);
+  ++appended_;
+  if (!chunk_open_) {
+    BeginChunk(event.timestamp_us);
+  } else if (event.timestamp_us - chunk_first_us_ >= kKeyframeIntervalUs ||
+             chunk_.size() >= kChunkBytes) {
+    SealChunk();
+    BeginChunk(event.timestamp_us);
+  }
+
+  InputJournal::PadState& pad = pads_[event.gamepad_id];
+  int32_t q = static_cast<int32_t>(std::lround(event.value * kScale));
+  int slot = ControlSlot(event.type, event.index);
+  int32_t previous = 0;
+  if (slot >= 0) {
+    previous = pad.controls[slot];
+    pad.controls[slot] = q;
+  } else {
+    previous = pad.connected ? 1 : 0;
+    q = event.value != 0.0 ? 1 : 0;
+    pad.connected = q != 0;
+  }
+
+  // Timestamps only move forward inside a chunk; a wall-clock step back is
+  // recorded as a zero delta.
+  int64_t ts = event.timestamp_us < prev_us_ ? prev_us_ : event.timestamp_us;
+  PutVarint(chunk_, static_cast<uint64_t>(ts - prev_us_));
+  prev_us_ = ts;
+
+  uint8_t tag = static_cast<uint8_t>((event.index & kIndexMask) |
+                                     ((event.type & kTypeMask) << kTypeShift));
+  bool new_gamepad = event.gamepad_id != prev_gamepad_;
+  if (new_gamepad) tag |= kNewGamepadBit;
+  chunk_.push_back(tag);
+  if (new_gamepad) {
+    PutZigzag(chunk_, event.gamepad_id);
+    prev_gamepad_ = event.gamepad_id;
+  }
+  PutZigzag(chunk_, static_cast<int64_t>(q) - previous);
+  ++chunk_events_;
+}
+
+void InputJournalWriter::BeginChunk(int64_t timestamp_us) {
+  chunk_.clear();
+  chunk_.resize(InputJournal::kHeaderBytes);
+  chunk_first_us_ = timestamp_us;
+  prev_us_ = timestamp_us;
+  prev_gamepad_ = -1;
+  chunk_events_ = 0;
+  chunk_open_ = true;
+
+  PutVarint(chunk_, pads_.size());
+  for (const auto& [id, pad] : pads_) {
+    PutZigzag(chunk_, id);
+    chunk_.push_back(pad.connected ? 1 : 0);
+    for (int32_t q : pad.controls) PutZigzag(chunk_, q);
+  }
+}
+
+void InputJournalWriter::SealChunk() {
+  if (!chunk_open_) return;
+  chunk_open_ = false;
+
+  uint8_t* header = chunk_.data();
+  memcpy(header, kChunkMagic, 4);
+  PutU32(header + 4,
+         static_cast<uint32_t>(chunk_.size() - InputJournal::kHeaderBytes));
+  PutI64(header + 8, chunk_first_us_);
+  PutI64(header + 16, prev_us_);
+  PutU32(header + 24, chunk_events_);
+  PutU32(header + 28, 0);
+
+  std::vector<uint8_t> next;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sealed_.push_back(std::move(chunk_));
+    if (!spare_.empty()) {
+      next = std::move(spare_.back());
+      spare_.pop_back();
+    }
+  }
+  cv_.notify_one();
+
+  chunk_ = std::move(next);
+  chunk_.clear();
+  chunk_.reserve(kChunkBytes + 256);
+}
+
+void InputJournalWriter::FlushLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    if (!cv_.wait_for(lock, std::chrono::microseconds(kKeyframeIntervalUs),
+                      [this] { return stopping_ || !sealed_.empty(); })) {
+      // SealChunk() takes mutex_ under encoder_mutex_.
+      lock.unlock();
+      SealIfIdle();
+      lock.lock();
+      continue;
+    }
+    if (sealed_.empty()) break;  // stopping_ and fully drained
+
+    std::vector<uint8_t> chunk = std::move(sealed_.front());
+    sealed_.pop_front();
+    lock.unlock();
+    fwrite(chunk.data(), 1, chunk.size(), file_);
+    fflush(file_);
+    lock.lock();
+    spare_.push_back(std::move(chunk));
+  }
+}
+
+void InputJournalWriter::SealIfIdle() {
+  std::lock_guard<std::mutex> lock(encoder_mutex_);
+  if (appended_ == appended_at_idle_check_) SealChunk();
+  appended_at_idle_check_ = appended_;
+}
+
+// ---------------------------------------------------------------------------
+// InputJournalReader
+// ---------------------------------------------------------------------------
+
+InputJournalReader::~InputJournalReader() {
+  if (file_) fclose(file_);
+}
+
+bool InputJournalReader::Open(const std::string& path) {
+  if (file_) fclose(file_);
+  index_.clear();
+  file_ = fopen(path.c_str(), "rb");
+  if (!file_) return false;
+
+  uint8_t header[InputJournal::kHeaderBytes];
+  if (fread(header, 1, 8, file_) != 8 || memcmp(header, kFileMagic, 4) != 0 ||
+      GetU32(header + 4) != kVersion) {
+    return false;
+  }
+
+  // Hop from header to header; a torn chunk at the tail (e.g. after a crash)
+  // simply ends the index.
+  long offset = 8;
+  while (fread(header, 1, sizeof(header), file_) == sizeof(header) &&
+         memcmp(header, kChunkMagic, 4) == 0) {
+    ChunkEntry entry;
+    entry.offset = offset;
+    entry.payload_bytes = GetU32(header + 4);
+    entry.first_us = GetI64(header + 8);
+    entry.last_us = GetI64(header + 16);
+    entry.event_count = GetU32(header + 24);
+    offset += InputJournal::kHeaderBytes + entry.payload_bytes;
+    if (fseek(file_, offset, SEEK_SET) != 0) break;
+    index_.push_back(entry);
+  }
+
+  // The last entry may be truncated; drop it if its payload is incomplete.
+  if (!index_.empty()) {
+    fseek(file_, 0, SEEK_END);
+    const ChunkEntry& last = index_.back();
+    if (ftell(file_) <
+        last.offset + InputJournal::kHeaderBytes + static_cast<long>(
+                                                       last.payload_bytes)) {
+      index_.pop_back();
+    }
+  }
+
+  return !index_.empty() && LoadChunk(0);
+}
+
+bool InputJournalReader::Seek(int64_t timestamp_us) {
+  if (index_.empty()) return false;
+  seek_us_ = timestamp_us;
+
+  // Last chunk starting at or before the target; chunks are in time order.
+  size_t lo = 0;
+  size_t hi = index_.size();
+  while (hi - lo > 1) {
+    size_t mid = (lo + hi) / 2;
+    if (index_[mid].first_us <= timestamp_us) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  // Skip chunks that end before the target entirely.
+  while (lo + 1 < index_.size() && index_[lo].last_us < timestamp_us) ++lo;
+  if (!LoadChunk(lo)) return false;
+
+  // Decode forward within the chunk until the target is reached and hold
+  // that event back for the next call to Next().
+  while (remaining_ > 0) {
+    if (!Decode(&pending_)) return false;
+    if (pending_.timestamp_us >= timestamp_us) {
+      has_pending_ = true;
+      return true;
+    }
+  }
+  return chunk_ + 1 < index_.size() && LoadChunk(chunk_ + 1);
+}
+
+void InputJournalReader::SeekState(std::vector<JournalEvent>* events) const {
+  for (const auto& [id, state] : pads_) {
+    InputJournal::PadState pad = state;
+    if (has_pending_ && pending_.gamepad_id == id) {
+      int slot = ControlSlot(pending_.type, pending_.index);
+      if (slot >= 0) {
+        pad.controls[slot] -= last_delta_;
+      } else {
+        pad.connected = (pad.connected ? 1 : 0) - last_delta_ != 0;
+      }
+    }
+    if (!pad.connected) continue;
+
+    events->push_back({seek_us_, id, 0, 0, 1.0});
+    for (int i = 0; i < InputJournal::kControlCount; ++i) {
+      bool button = i < ButtonMapping::kButtonCount;
+      events->push_back(
+          {seek_us_, id, static_cast<uint8_t>(button ? 1 : 2),
+           static_cast<uint8_t>(button ? i : i - ButtonMapping::kButtonCount),
+           pad.controls[i] / kScale});
+    }
+  }
+}
+
+bool InputJournalReader::Next(JournalEvent* event) {
+  if (has_pending_) {
+    *event = pending_;
+    has_pending_ = false;
+    return true;
+  }
+  while (remaining_ == 0) {
+    if (chunk_ + 1 >= index_.size() || !LoadChunk(chunk_ + 1)) return false;
+  }
+  return Decode(event);
+}
+
+int64_t InputJournalReader::first_timestamp_us() const {
+  return index_.empty() ? 0 : index_.front().first_us;
+}
+
+int64_t InputJournalReader::last_timestamp_us() const {
+  return index_.empty() ? 0 : index_.back().last_us;
+}
+
+bool InputJournalReader::LoadChunk(size_t chunk) {
+  const ChunkEntry& entry = index_[chunk];
+  payload_.resize(entry.payload_bytes);
+  if (fseek(file_, entry.offset + InputJournal::kHeaderBytes, SEEK_SET) != 0 ||
+      fread(payload_.data(), 1, payload_.size(), file_) != payload_.size()) {
+    return false;
+  }
+
+  chunk_ = chunk;
+  has_pending_ = false;
+  pos_ = 0;
+  remaining_ = entry.event_count;
+  prev_us_ = entry.first_us;
+  prev_gamepad_ = -1;
+  pads_.clear();
+
+  uint64_t count;
+  if (!GetVarint(payload_, pos_, &count)) return false;
+  for (uint64_t i = 0; i < count; ++i) {
+    int64_t id;
+    if (!GetZigzag(payload_, pos_, &id) || pos_ >= payload_.size()) {
+      return false;
+    }
+    InputJournal::PadState& pad = pads_[static_cast<int32_t>(id)];
+    pad.connected = payload_[pos_++] != 0;
+    for (int32_t& q : pad.controls) {
+      int64_t v;
+      if (!GetZigzag(payload_, pos_, &v)) return false;
+      q = static_cast<int32_t>(v);
+    }
+  }
+  return true;
+}
+
+bool InputJournalReader::Decode(JournalEvent* event) {
+  uint64_t dt;
+  if (!GetVarint(payload_, pos_, &dt) || pos_ >= payload_.size()) {
+    remaining_ = 0;
+    return false;
+  }
+  uint8_t tag = payload_[pos_++];
+  if (tag & kNewGamepadBit) {
+    int64_t id;
+    if (!GetZigzag(payload_, pos_, &id)) {
+      remaining_ = 0;
+      return false;
+    }
+    prev_gamepad_ = static_cast<int32_t>(id);
+  }
+  int64_t dq;
+  if (!GetZigzag(payload_, pos_, &dq)) {
+    remaining_ = 0;
+    return false;
+  }
+  --remaining_;
+  last_delta_ = static_cast<int32_t>(dq);
+
+  prev_us_ += static_cast<int64_t>(dt);
+  event->timestamp_us = prev_us_;
+  event->gamepad_id = prev_gamepad_;
+  event->type = (tag >> kTypeShift) & kTypeMask;
+  event->index = tag & kIndexMask;
+
+  InputJournal::PadState& pad = pads_[prev_gamepad_];
+  int slot = ControlSlot(event->type, event->index);
+  if (slot >= 0) {
+    pad.controls[slot] += static_cast<int32_t>(dq);
+    event->value = pad.controls[slot] / kScale;
+  } else {
+    pad.connected = ((pad.connected ? 1 : 0) + dq) != 0;
+    event->value = pad.connected ? 1.0 : 0.0;
+  }
+  return true;
+}
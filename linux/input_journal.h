@@ -0,0 +1,180 @@
+#ifndef INPUT_JOURNAL_H_
+#define INPUT_JOURNAL_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "button_mapping.h"
+
+/// A processed (W3C-level) event as stored in an input journal.
+struct JournalEvent {
+  int64_t timestamp_us;
+  int32_t gamepad_id;
+  // Wire format type tag: 0 = connection, 1 = button, 2 = axis.
+  uint8_t type;
+  // W3C button / axis index; 0 for connection events.
+  uint8_t index;
+  // Button 0.0 - 1.0, axis -1.0 - 1.0, connection 1.0 / 0.0.
+  double value;
+};
+
+/// Shared on-disk layout of an input journal.
+///
+///   file   := "UGJ1" u32:version chunk*
+///   chunk  := header keyframe event*
+///   header := "UGJC" u32:payload_bytes i64:first_us i64:last_us
+///             u32:event_count u32:reserved          (32 bytes, little endian)
+///   keyframe := varint:pads { zigzag:id u8:connected zigzag:q * 21 }
+///   event  := varint:dt_us u8:tag [zigzag:gamepad_id] zigzag:dq
+///
+/// Values are quantized to 1/32767.  Every event is delta-encoded against
+/// the previous event's timestamp and the previous value of the same
+/// control, starting from the chunk's keyframe (full state of every pad), so
+/// any chunk can be decoded on its own.  The tag packs the W3C index (bits
+/// 0-4), the type (bits 5-6) and whether the gamepad id differs from the
+/// previous event (bit 7).
+namespace InputJournal {
+
+constexpr int kHeaderBytes = 32;
+constexpr int kControlCount =
+    ButtonMapping::kButtonCount + ButtonMapping::kAxisCount;
+
+/// Quantized state of one gamepad, used for keyframes and delta decoding.
+struct PadState {
+  bool connected = false;
+  int32_t controls[kControlCount] = {};
+};
+
+}  // namespace InputJournal
+
+/// Appends processed events to a journal file.
+///
+/// Append() runs on the evdev worker and only encodes into an in-memory
+/// chunk; sealed chunks are written by a private flush thread, so the worker
+/// never blocks on disk I/O.  A chunk is sealed, and a new keyframe started,
+/// every kKeyframeIntervalUs of input or when it reaches kChunkBytes.  The
+/// flush thread also seals a chunk that received nothing for a whole
+/// kKeyframeIntervalUs, so the tail of an idle session reaches the disk
+/// without waiting for more input or for the writer to be destroyed.
+class InputJournalWriter {
+ public:
+  static constexpr int64_t kKeyframeIntervalUs = 1000000;
+  static constexpr size_t kChunkBytes = 64 * 1024;
+
+  /// Creates (truncates) |path|.  Returns nullptr if it cannot be opened.
+  static std::unique_ptr<InputJournalWriter> Open(const std::string& path);
+
+  /// Seals the current chunk and waits for all pending writes.  Blocks on
+  /// disk I/O, so not to be run on the evdev worker.
+  ~InputJournalWriter();
+
+  InputJournalWriter(const InputJournalWriter&) = delete;
+  InputJournalWriter& operator=(const InputJournalWriter&) = delete;
+
+  void Append(const JournalEvent& event);
+
+ private:
+  explicit InputJournalWriter(FILE* file);
+
+  void BeginChunk(int64_t timestamp_us);
+  // Requires encoder_mutex_.
+  void SealChunk();
+  void FlushLoop();
+  // Seals the open chunk if nothing was appended since the previous call.
+  void SealIfIdle();
+
+  // Encoder state — written by Append() on the worker; protected by
+  // encoder_mutex_, which the flush thread takes about once per
+  // kKeyframeIntervalUs to seal an idle chunk.
+  std::mutex encoder_mutex_;
+  uint64_t appended_ = 0;
+  uint64_t appended_at_idle_check_ = 0;
+  std::map<int32_t, InputJournal::PadState> pads_;
+  std::vector<uint8_t> chunk_;
+  bool chunk_open_ = false;
+  int64_t chunk_first_us_ = 0;
+  int64_t prev_us_ = 0;
+  uint32_t chunk_events_ = 0;
+  int32_t prev_gamepad_ = -1;
+
+  // Flush thread state — protected by mutex_.
+  FILE* file_;
+  std::thread flush_thread_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::vector<uint8_t>> sealed_;
+  std::vector<std::vector<uint8_t>> spare_;
+  bool stopping_ = false;
+};
+
+/// Reads a journal written by InputJournalWriter.
+///
+/// Open() builds a chunk index by hopping over chunk headers, so Seek() can
+/// jump to the keyframe preceding any timestamp and only decode that chunk.
+class InputJournalReader {
+ public:
+  InputJournalReader() = default;
+  ~InputJournalReader();
+
+  InputJournalReader(const InputJournalReader&) = delete;
+  InputJournalReader& operator=(const InputJournalReader&) = delete;
+
+  bool Open(const std::string& path);
+
+  /// Positions the reader at the first event at or after |timestamp_us|.
+  /// Returns false if the journal has no such event.
+  bool Seek(int64_t timestamp_us);
+
+  /// Appends the state of every pad at the position Seek() found to
+  /// |events|, as synthetic events stamped with the Seek() target: a
+  /// connection event for each connected pad followed by all of its
+  /// buttons and axes, decoded from the keyframe and the events before the
+  /// target.  Next() then returns the changes from there on.
+  void SeekState(std::vector<JournalEvent>* events) const;
+
+  /// Reads the next event.  Returns false at the end of the journal.
+  bool Next(JournalEvent* event);
+
+  /// Timestamp range covered by the journal (0 if empty).
+  int64_t first_timestamp_us() const;
+  int64_t last_timestamp_us() const;
+
+ private:
+  struct ChunkEntry {
+    long offset;
+    uint32_t payload_bytes;
+    uint32_t event_count;
+    int64_t first_us;
+    int64_t last_us;
+  };
+
+  bool LoadChunk(size_t chunk);
+  bool Decode(JournalEvent* event);
+
+  FILE* file_ = nullptr;
+  std::vector<ChunkEntry> index_;
+  size_t chunk_ = 0;
+  std::vector<uint8_t> payload_;
+  size_t pos_ = 0;
+  uint32_t remaining_ = 0;
+  int64_t prev_us_ = 0;
+  int32_t prev_gamepad_ = -1;
+  std::map<int32_t, InputJournal::PadState> pads_;
+  // Quantized change of the last decoded event, so SeekState() can take
+  // back |pending_|, which pads_ already includes.
+  int32_t last_delta_ = 0;
+  int64_t seek_us_ = 0;
+  // Event decoded by Seek() and returned by the following Next().
+  JournalEvent pending_ = {};
+  bool has_pending_ = false;
+};
+
+#endif  // INPUT_JOURNAL_H_
@@ -0,0 +1,137 @@
+#include "input_wire.h"
+
+#include <cstring>
+
+namespace {
+
+// Standard message codec type tags and the method codec's success
+// envelope, as in flutter/shell/platform/linux/fl_standard_*_codec.cc.
+constexpr uint8_t kEnvelopeSuccess = 0;
+constexpr uint8_t kValueNull = 0;
+constexpr uint8_t kValueTrue = 1;
+constexpr uint8_t kValueFalse = 2;
+constexpr uint8_t kValueInt32 = 3;
+constexpr uint8_t kValueInt64 = 4;
+constexpr uint8_t kValueFloat64 = 6;
+constexpr uint8_t kValueList = 12;
+
+size_t FieldCount(const InputWireEvent& event) {
+  switch (event.type) {
+    case 1:
+      return 6;
+    case 2:
+      return event.mode == AxisCoalescing::kLatest ? 5 : 9;
+    default:
+      return 5;
+  }
+}
+
+FlValue* NewFloatOrNull(bool present, double value) {
+  return present ? fl_value_new_float(value) : fl_value_new_null();
+}
+
+}  // namespace
+
+FlValue* NewInputWireValue(const InputWireEvent& event) {
+  FlValue* fe = fl_value_new_list();
+  fl_value_append_take(fe, fl_value_new_int(event.type));
+  fl_value_append_take(fe, fl_value_new_int(event.gamepad_id));
+  fl_value_append_take(fe, fl_value_new_int(event.timestamp));
+  if (event.type == 3) {
+    fl_value_append_take(fe, fl_value_new_float(event.value));
+    fl_value_append_take(fe, fl_value_new_float(event.delta_y));
+    return fe;
+  }
+  fl_value_append_take(fe, fl_value_new_int(event.index));
+  if (event.type == 1) {
+    fl_value_append_take(fe, fl_value_new_bool(event.pressed ? TRUE : FALSE));
+  }
+  fl_value_append_take(fe, fl_value_new_float(event.value));
+  if (event.type != 2 || event.mode == AxisCoalescing::kLatest) return fe;
+
+  bool envelope = event.mode == AxisCoalescing::kEnvelope;
+  fl_value_append_take(fe, NewFloatOrNull(envelope, event.min));
+  fl_value_append_take(fe, NewFloatOrNull(envelope, event.max));
+  fl_value_append_take(
+      fe, NewFloatOrNull(event.mode == AxisCoalescing::kAverage,
+                         event.average));
+  fl_value_append_take(
+      fe, NewFloatOrNull(event.mode == AxisCoalescing::kDisplacement,
+                         event.displacement));
+  return fe;
+}
+
+InputWireEncoder::~InputWireEncoder() {
+  for (GBytes* message : messages_) {
+    if (message) g_bytes_unref(message);
+  }
+}
+
+GBytes* InputWireEncoder::Encode(const InputWireEvent& event) {
+  length_ = 0;
+  WriteByte(kEnvelopeSuccess);
+  WriteByte(kValueList);
+  WriteByte(static_cast<uint8_t>(FieldCount(event)));
+  WriteInt(event.type);
+  WriteInt(event.gamepad_id);
+  WriteInt(event.timestamp);
+  if (event.type == 3) {
+    WriteFloat(event.value);
+    WriteFloat(event.delta_y);
+  } else {
+    WriteInt(event.index);
+    if (event.type == 1) WriteBool(event.pressed);
+    WriteFloat(event.value);
+    if (event.type == 2 && event.mode != AxisCoalescing::kLatest) {
+      bool envelope = event.mode == AxisCoalescing::kEnvelope;
+      WriteFloatOrNull(envelope, event.min);
+      WriteFloatOrNull(envelope, event.max);
+      WriteFloatOrNull(event.mode == AxisCoalescing::kAverage,
+                       event.average);
+      WriteFloatOrNull(event.mode == AxisCoalescing::kDisplacement,
+                       event.displacement);
+    }
+  }
+
+  GBytes*& message = messages_[length_];
+  if (!message) message = g_bytes_new_static(buffer_, length_);
+  return message;
+}
+
+void InputWireEncoder::WriteByte(uint8_t byte) { buffer_[length_++] = byte; }
+
+void InputWireEncoder::WriteInt(int64_t value) {
+  // Like FlStandardMessageCodec: int32 when the value fits.
+  if (value >= INT32_MIN && value <= INT32_MAX) {
+    auto value32 = static_cast<int32_t>(value);
+    WriteByte(kValueInt32);
+    std::memcpy(buffer_ + length_, &value32, sizeof(value32));
+    length_ += sizeof(value32);
+  } else {
+    WriteByte(kValueInt64);
+    std::memcpy(buffer_ + length_, &value, sizeof(value));
+    length_ += sizeof(value);
+  }
+}
+
+void InputWireEncoder::WriteFloat(double value) {
+  WriteByte(kValueFloat64);
+  // Float64 payloads are aligned to 8 bytes from the message start.
+  while (length_ % 8 != 0) WriteByte(0);
+  std::memcpy(buffer_ + length_, &value, sizeof(value));
+  length_ += sizeof(value);
+}
+
+void InputWireEncoder::WriteBool(bool value) {
+  WriteByte(value ? kValueTrue : kValueFalse);
+}
+
+void InputWireEncoder::WriteNull() { WriteByte(kValueNull); }
+
+void InputWireEncoder::WriteFloatOrNull(bool present, double value) {
+  if (present) {
+    WriteFloat(value);
+  } else {
+    WriteNull();
+  }
+}
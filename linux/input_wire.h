@@ -0,0 +1,80 @@
+#ifndef INPUT_WIRE_H_
+#define INPUT_WIRE_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "axis_window.h"
+
+/// A button, axis or pointer event as it goes on the wire.  The event
+/// channel carries it as the list GamepadEvent.fromList reads:
+///
+///   button:  [1, gamepadId, timestamp, buttonIndex, pressed, value]
+///   axis:    [2, gamepadId, timestamp, axisIndex, value]
+///            [2, gamepadId, timestamp, axisIndex, value, min, max,
+///             average, displacement] unless |mode| is kLatest; the fields
+///             of other modes are null
+///   pointer: [3, gamepadId, timestamp, dx, dy]
+struct InputWireEvent {
+  int type;
+  int gamepad_id;
+  int64_t timestamp;
+  // Button or axis index.
+  int index;
+  bool pressed;
+  // Button or axis value; dx for pointer events.
+  double value;
+  // Pointer events only.
+  double delta_y;
+  // Axis events only.
+  AxisCoalescing mode;
+  double min;
+  double max;
+  double average;
+  double displacement;
+};
+
+/// Builds the wire list of |event|.  Caller owns the returned value.
+FlValue* NewInputWireValue(const InputWireEvent& event);
+
+/// Encodes InputWireEvents into the bytes fl_event_channel_send() would
+/// send for their wire lists (a standard method codec success envelope),
+/// without building FlValues.
+///
+/// The message is written into a fixed buffer, and each length gets one
+/// static GBytes over that buffer the first time it occurs, so encoding
+/// allocates nothing once every event shape has been seen.  The GBytes
+/// returned stays owned by the encoder and its contents are only valid
+/// until the next Encode(): hand it to a call that copies the message
+/// before returning, like fl_binary_messenger_send_on_channel() without a
+/// reply callback.
+class InputWireEncoder {
+ public:
+  InputWireEncoder() = default;
+  ~InputWireEncoder();
+
+  InputWireEncoder(const InputWireEncoder&) = delete;
+  InputWireEncoder& operator=(const InputWireEncoder&) = delete;
+
+  GBytes* Encode(const InputWireEvent& event);
+
+ private:
+  // Largest message: the envelope byte, the list header and nine values of
+  // at most 16 bytes (a float64 with its alignment padding).
+  static constexpr size_t kMaxBytes = 160;
+
+  void WriteByte(uint8_t byte);
+  void WriteInt(int64_t value);
+  void WriteFloat(double value);
+  void WriteBool(bool value);
+  void WriteNull();
+  void WriteFloatOrNull(bool present, double value);
+
+  uint8_t buffer_[kMaxBytes];
+  size_t length_ = 0;
+  GBytes* messages_[kMaxBytes + 1] = {};
+};
+
+#endif  // INPUT_WIRE_H_
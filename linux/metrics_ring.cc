@@ -0,0 +1,149 @@
+#include "metrics_ring.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <utility>
+
+#include "report_rate_meter.h"
+
+namespace {
+
+struct FileHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t header_bytes;
+  uint32_t record_bytes;
+  uint32_t slot_count;
+  uint32_t bucket_count;
+  uint32_t max_devices;
+  uint32_t reserved;
+  uint64_t next_sequence;
+  int64_t created_us;
+  int32_t latency_limits_us[MetricsRing::kBucketCount - 1];
+  int32_t jitter_limits_us[ReportRateMeter::kBucketCount - 1];
+  uint8_t padding[24];
+};
+
+static_assert(sizeof(FileHeader) == MetricsRing::kHeaderBytes,
+              "FileHeader layout");
+static_assert(ReportRateMeter::kBucketCount == 8,
+              "MetricsDevice::jitter_buckets follows ReportRateMeter");
+
+constexpr char kMagic[4] = {'U', 'G', 'M', '1'};
+
+bool Matches(const FileHeader& header, uint32_t slot_count) {
+  return std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 &&
+         header.version == MetricsRing::kVersion &&
+         header.header_bytes == MetricsRing::kHeaderBytes &&
+         header.record_bytes == sizeof(MetricsSnapshot) &&
+         header.slot_count == slot_count && header.next_sequence > 0;
+}
+
+}  // namespace
+
+// static
+std::unique_ptr<MetricsRing> MetricsRing::Open(const std::string& path,
+                                               uint32_t slot_count) {
+  if (slot_count == 0) return nullptr;
+  size_t size = kHeaderBytes + slot_count * sizeof(MetricsSnapshot);
+  int fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+  struct stat st;
+  FileHeader existing;
+  bool reuse = fd >= 0 && fstat(fd, &st) == 0 &&
+               static_cast<size_t>(st.st_size) == size &&
+               pread(fd, &existing, sizeof(existing), 0) ==
+                   static_cast<ssize_t>(sizeof(existing)) &&
+               Matches(existing, slot_count);
+  // A new file is built beside the old one and renamed over it, so a ring
+  // still mapping the old file keeps its blocks instead of faulting on a
+  // truncated one.
+  std::string temp_path = path + ".tmp";
+  if (!reuse) {
+    if (fd >= 0) close(fd);
+    fd = open(temp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+              0644);
+    if (fd < 0) return nullptr;
+    // Reserve the blocks up front: writing to a hole of a full disk
+    // through the mapping would raise SIGBUS instead of failing here.
+    if (posix_fallocate(fd, 0, static_cast<off_t>(size)) != 0) {
+      close(fd);
+      unlink(temp_path.c_str());
+      return nullptr;
+    }
+  }
+
+  void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED) {
+    close(fd);
+    if (!reuse) unlink(temp_path.c_str());
+    return nullptr;
+  }
+
+  auto* header = static_cast<FileHeader*>(map);
+  if (!reuse) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    std::memset(header, 0, sizeof(*header));
+    std::memcpy(header->magic, kMagic, sizeof(kMagic));
+    header->version = kVersion;
+    header->header_bytes = kHeaderBytes;
+    header->record_bytes = sizeof(MetricsSnapshot);
+    header->slot_count = slot_count;
+    header->bucket_count = kBucketCount;
+    header->max_devices = kMaxDevices;
+    header->next_sequence = 1;
+    header->created_us =
+        static_cast<int64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+    for (int i = 0; i < kBucketCount - 1; ++i) {
+      header->latency_limits_us[i] = static_cast<int32_t>(kBucketLimitsUs[i]);
+      header->jitter_limits_us[i] =
+          static_cast<int32_t>(ReportRateMeter::kBucketLimitsUs[i]);
+    }
+    if (rename(temp_path.c_str(), path.c_str()) != 0) {
+      munmap(map, size);
+      close(fd);
+      unlink(temp_path.c_str());
+      return nullptr;
+    }
+  }
+
+  return std::unique_ptr<MetricsRing>(new MetricsRing(
+      path, fd, static_cast<uint8_t*>(map), size, slot_count));
+}
+
+MetricsRing::MetricsRing(std::string path, int fd, uint8_t* map, size_t size,
+                         uint32_t slot_count)
+    : path_(std::move(path)),
+      fd_(fd),
+      map_(map),
+      size_(size),
+      slot_count_(slot_count) {}
+
+MetricsRing::~MetricsRing() {
+  munmap(map_, size_);
+  close(fd_);
+}
+
+void MetricsRing::Append(const MetricsSnapshot& snapshot) {
+  auto* header = reinterpret_cast<FileHeader*>(map_);
+  uint64_t sequence = header->next_sequence;
+  auto* slot = reinterpret_cast<MetricsSnapshot*>(map_ + kHeaderBytes) +
+               (sequence - 1) % slot_count_;
+
+  constexpr size_t kBodyOffset = sizeof(snapshot.sequence);
+  slot->sequence = 0;
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(reinterpret_cast<uint8_t*>(slot) + kBodyOffset,
+              reinterpret_cast<const uint8_t*>(&snapshot) + kBodyOffset,
+              sizeof(MetricsSnapshot) - kBodyOffset);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot->sequence = sequence;
+  header->next_sequence = sequence + 1;
+}
@@ -0,0 +1,116 @@
+#ifndef METRICS_RING_H_
+#define METRICS_RING_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/// Report cadence of one device in a metrics snapshot (96 bytes).
+struct MetricsDevice {
+  // -1 for an unused slot.
+  int32_t gamepad_id;
+  float report_rate_hz;
+  float jitter_us;
+  uint32_t reserved;
+  uint64_t intervals;
+  uint64_t gaps;
+  // ReportRateMeter's jitter histogram.
+  uint64_t jitter_buckets[8];
+};
+
+/// One record of a metrics ring (672 bytes).  Counters and histograms are
+/// cumulative since |session_start_us|; a reader diffs consecutive records
+/// of the same session.  Histograms bucket microseconds by
+/// MetricsRing::kBucketLimitsUs.
+struct MetricsSnapshot {
+  // 1-based; 0 marks a slot that was never written or is being written.
+  uint64_t sequence;
+  int64_t wall_time_us;
+  int64_t monotonic_us;
+  int64_t session_start_us;
+  uint64_t drain_ticks;
+  uint64_t events_delivered;
+  // Axis events superseded in the queue before they were delivered.
+  uint64_t events_coalesced;
+  uint64_t raw_batches;
+  uint64_t overloaded_ticks;
+  uint64_t config_version;
+  uint32_t drain_interval_ms;
+  uint32_t device_count;
+  float load_factor;
+  float event_cost_us;
+  // Queue time of delivered events, and the drain timer's lateness and cost.
+  uint64_t queue_latency[8];
+  uint64_t drain_lateness[8];
+  uint64_t drain_cost[8];
+  MetricsDevice devices[4];
+};
+
+static_assert(sizeof(MetricsDevice) == 96, "MetricsDevice layout");
+static_assert(sizeof(MetricsSnapshot) == 672, "MetricsSnapshot layout");
+
+/// Fixed-size ring of MetricsSnapshot records in a memory-mapped file, for
+/// pulling performance data off devices after the fact:
+///
+///   file   := header slot{slot_count}
+///   header := "UGM1" u32:version u32:header_bytes u32:record_bytes
+///             u32:slot_count u32:bucket_count u32:max_devices u32:reserved
+///             u64:next_sequence i64:created_us
+///             i32:latency_limits_us[7] i32:jitter_limits_us[7]
+///             (padded to 128 bytes, little endian)
+///
+/// Record n lives in slot (n - 1) % slot_count.  Append() is a memcpy into
+/// the shared mapping; the kernel writes pages back on its own, so no I/O
+/// happens on the caller's thread and a crash loses nothing already
+/// appended.  A record's sequence is cleared before and set after its body
+/// is copied, so a torn record reads as empty.  An existing file with the
+/// same layout is continued, otherwise a new one replaces it by rename.
+class MetricsRing {
+ public:
+  static constexpr uint32_t kVersion = 1;
+  static constexpr uint32_t kHeaderBytes = 128;
+  static constexpr int kBucketCount = 8;
+  static constexpr int kMaxDevices = 4;
+
+  /// Upper bounds of the latency histogram buckets; the last bucket holds
+  /// everything above the final bound.
+  static constexpr int64_t kBucketLimitsUs[kBucketCount - 1] = {
+      500, 1000, 2000, 4000, 8000, 16000, 32000};
+
+  /// Maps |path| with room for |slot_count| records.  Returns nullptr if
+  /// the file cannot be created, sized or mapped.  Creating a file blocks
+  /// on the disk, so call this off the main thread.
+  static std::unique_ptr<MetricsRing> Open(const std::string& path,
+                                           uint32_t slot_count);
+
+  static int Bucket(int64_t us) {
+    int bucket = 0;
+    while (bucket < kBucketCount - 1 && us > kBucketLimitsUs[bucket]) {
+      ++bucket;
+    }
+    return bucket;
+  }
+
+  ~MetricsRing();
+
+  MetricsRing(const MetricsRing&) = delete;
+  MetricsRing& operator=(const MetricsRing&) = delete;
+
+  /// Stores |snapshot| as the next record; its sequence is assigned here.
+  void Append(const MetricsSnapshot& snapshot);
+
+  const std::string& path() const { return path_; }
+  uint32_t slot_count() const { return slot_count_; }
+
+ private:
+  MetricsRing(std::string path, int fd, uint8_t* map, size_t size,
+              uint32_t slot_count);
+
+  std::string path_;
+  int fd_;
+  uint8_t* map_;
+  size_t size_;
+  uint32_t slot_count_;
+};
+
+#endif  // METRICS_RING_H_
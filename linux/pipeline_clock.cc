@@ -0,0 +1,129 @@
+#include "pipeline_clock.h"
+
+#include <algorithm>
+
+// ---------------------------------------------------------------------------
+// SystemPipelineClock
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct TimerSource {
+  GSource source;
+  guint interval_ms;
+};
+
+void ArmTimer(GSource* source, int64_t from_us) {
+  auto* timer = reinterpret_cast<TimerSource*>(source);
+  g_source_set_ready_time(
+      source, from_us + static_cast<int64_t>(timer->interval_ms) * 1000);
+}
+
+gboolean DispatchTimer(GSource* source, GSourceFunc callback,
+                       gpointer user_data) {
+  // Re-armed before the callback runs, so it can move the timer.
+  ArmTimer(source, g_source_get_time(source));
+  return callback(user_data);
+}
+
+GSourceFuncs kTimerSourceFuncs = {nullptr, nullptr, DispatchTimer,
+                                  nullptr, nullptr, nullptr};
+
+}  // namespace
+
+SystemPipelineClock::~SystemPipelineClock() {
+  for (auto& [id, source] : timers_) {
+    g_source_destroy(source);
+    g_source_unref(source);
+  }
+}
+
+int64_t SystemPipelineClock::NowMicros() { return g_get_real_time(); }
+
+guint SystemPipelineClock::AddTimer(guint interval_ms, GSourceFunc callback,
+                                    gpointer user_data) {
+  // Timers whose callback returned G_SOURCE_REMOVE are destroyed but still
+  // referenced here.
+  for (auto it = timers_.begin(); it != timers_.end();) {
+    if (g_source_is_destroyed(it->second)) {
+      g_source_unref(it->second);
+      it = timers_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  GSource* source = g_source_new(&kTimerSourceFuncs, sizeof(TimerSource));
+  reinterpret_cast<TimerSource*>(source)->interval_ms = interval_ms;
+  ArmTimer(source, g_get_monotonic_time());
+  g_source_set_callback(source, callback, user_data, nullptr);
+  guint id = g_source_attach(source, nullptr);  // default (main) context
+  timers_[id] = source;
+  return id;
+}
+
+void SystemPipelineClock::RemoveTimer(guint id) {
+  auto it = timers_.find(id);
+  if (it == timers_.end()) return;
+  g_source_destroy(it->second);
+  g_source_unref(it->second);
+  timers_.erase(it);
+}
+
+void SystemPipelineClock::SetTimerInterval(guint id, guint interval_ms) {
+  auto it = timers_.find(id);
+  if (it == timers_.end()) return;
+  reinterpret_cast<TimerSource*>(it->second)->interval_ms = interval_ms;
+  ArmTimer(it->second, g_get_monotonic_time());
+}
+
+// ---------------------------------------------------------------------------
+// SimulatedPipelineClock
+// ---------------------------------------------------------------------------
+
+SimulatedPipelineClock::SimulatedPipelineClock(int64_t start_us)
+    : now_us_(start_us) {}
+
+int64_t SimulatedPipelineClock::NowMicros() { return now_us_; }
+
+guint SimulatedPipelineClock::AddTimer(guint interval_ms,
+                                       GSourceFunc callback,
+                                       gpointer user_data) {
+  int64_t interval_us = static_cast<int64_t>(interval_ms) * 1000;
+  guint id = next_id_++;
+  timers_.push_back(
+      {id, interval_us, now_us_ + interval_us, callback, user_data});
+  return id;
+}
+
+void SimulatedPipelineClock::RemoveTimer(guint id) {
+  timers_.erase(std::remove_if(timers_.begin(), timers_.end(),
+                               [id](const Timer& t) { return t.id == id; }),
+                timers_.end());
+}
+
+void SimulatedPipelineClock::SetTimerInterval(guint id, guint interval_ms) {
+  for (Timer& timer : timers_) {
+    if (timer.id != id) continue;
+    timer.interval_us = static_cast<int64_t>(interval_ms) * 1000;
+    timer.next_us = now_us_ + timer.interval_us;
+  }
+}
+
+void SimulatedPipelineClock::AdvanceTo(int64_t time_us) {
+  for (;;) {
+    auto next = std::min_element(
+        timers_.begin(), timers_.end(),
+        [](const Timer& a, const Timer& b) { return a.next_us < b.next_us; });
+    if (next == timers_.end() || next->next_us > time_us) break;
+
+    // The callback may add or remove timers, so don't hold on to |next|.
+    guint id = next->id;
+    GSourceFunc callback = next->callback;
+    gpointer user_data = next->user_data;
+    now_us_ = next->next_us;
+    next->next_us += next->interval_us;
+    if (callback(user_data) == G_SOURCE_REMOVE) RemoveTimer(id);
+  }
+  now_us_ = std::max(now_us_, time_us);
+}
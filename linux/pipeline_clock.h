@@ -0,0 +1,89 @@
+#ifndef PIPELINE_CLOCK_H_
+#define PIPELINE_CLOCK_H_
+
+#include <glib.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/// Source of time and periodic timers for the event pipeline.
+///
+/// EvdevManager takes every timestamp and schedules its main-thread drain
+/// through a PipelineClock, so the same pipeline can run against wall time
+/// (SystemPipelineClock) or against a SimulatedPipelineClock that a replay
+/// advances as fast as the CPU allows.
+class PipelineClock {
+ public:
+  virtual ~PipelineClock() = default;
+
+  /// Current time in microseconds since the Unix epoch.  Any thread.
+  virtual int64_t NowMicros() = 0;
+
+  /// Calls |callback| every |interval_ms| until it returns G_SOURCE_REMOVE
+  /// or the timer is removed.  Returns a non-zero timer id.  Main thread
+  /// only.
+  virtual guint AddTimer(guint interval_ms, GSourceFunc callback,
+                         gpointer user_data) = 0;
+
+  /// Cancels a timer returned by AddTimer().  Main thread only.
+  virtual void RemoveTimer(guint id) = 0;
+
+  /// Makes timer |id| fire |interval_ms| from now and every |interval_ms|
+  /// after that, without allocating.  May be called from the timer's own
+  /// callback.  Main thread only.
+  virtual void SetTimerInterval(guint id, guint interval_ms) = 0;
+
+  int64_t NowMillis() { return NowMicros() / 1000; }
+};
+
+/// Wall-clock time; timers are GLib sources on the main context that
+/// re-arm themselves by ready time, like timeout sources but with an
+/// interval that can change.
+class SystemPipelineClock : public PipelineClock {
+ public:
+  SystemPipelineClock() = default;
+  ~SystemPipelineClock() override;
+
+  int64_t NowMicros() override;
+  guint AddTimer(guint interval_ms, GSourceFunc callback,
+                 gpointer user_data) override;
+  void RemoveTimer(guint id) override;
+  void SetTimerInterval(guint id, guint interval_ms) override;
+
+ private:
+  std::unordered_map<guint, GSource*> timers_;
+};
+
+/// Manually advanced time for replays.  Timers fire synchronously from
+/// AdvanceTo(), in deadline order, with NowMicros() reporting each timer's
+/// deadline while it runs.  Not thread-safe.
+class SimulatedPipelineClock : public PipelineClock {
+ public:
+  explicit SimulatedPipelineClock(int64_t start_us);
+
+  int64_t NowMicros() override;
+  guint AddTimer(guint interval_ms, GSourceFunc callback,
+                 gpointer user_data) override;
+  void RemoveTimer(guint id) override;
+  void SetTimerInterval(guint id, guint interval_ms) override;
+
+  /// Moves time forward to |time_us|, firing every timer deadline passed on
+  /// the way.  Never moves time backwards.
+  void AdvanceTo(int64_t time_us);
+
+ private:
+  struct Timer {
+    guint id;
+    int64_t interval_us;
+    int64_t next_us;
+    GSourceFunc callback;
+    gpointer user_data;
+  };
+
+  int64_t now_us_;
+  guint next_id_ = 1;
+  std::vector<Timer> timers_;
+};
+
+#endif  // PIPELINE_CLOCK_H_
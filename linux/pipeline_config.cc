@@ -0,0 +1,232 @@
+#include "pipeline_config.h"
+
+#include <cmath>
+
+namespace {
+
+constexpr const char* kGroup = "pipeline";
+// Keeps a typo from mapping gigabytes (~670 MiB).
+constexpr guint kMaxMetricsSlots = 1 << 20;
+
+// Reads |key| into |value| if present.  Returns false on a malformed value.
+bool ReadDouble(GKeyFile* file, const char* key, double* value,
+                std::string* error) {
+  if (!g_key_file_has_key(file, kGroup, key, nullptr)) return true;
+  GError* key_error = nullptr;
+  double read = g_key_file_get_double(file, kGroup, key, &key_error);
+  if (key_error) {
+    *error = std::string(key) + ": " + key_error->message;
+    g_error_free(key_error);
+    return false;
+  }
+  *value = read;
+  return true;
+}
+
+bool ReadInt(GKeyFile* file, const char* key, guint* value,
+             std::string* error) {
+  if (!g_key_file_has_key(file, kGroup, key, nullptr)) return true;
+  GError* key_error = nullptr;
+  gint read = g_key_file_get_integer(file, kGroup, key, &key_error);
+  if (key_error) {
+    *error = std::string(key) + ": " + key_error->message;
+    g_error_free(key_error);
+    return false;
+  }
+  if (read <= 0) {
+    *error = std::string(key) + ": must be positive";
+    return false;
+  }
+  *value = static_cast<guint>(read);
+  return true;
+}
+
+bool ReadBool(GKeyFile* file, const char* key, bool* value,
+              std::string* error) {
+  if (!g_key_file_has_key(file, kGroup, key, nullptr)) return true;
+  GError* key_error = nullptr;
+  gboolean read = g_key_file_get_boolean(file, kGroup, key, &key_error);
+  if (key_error) {
+    *error = std::string(key) + ": " + key_error->message;
+    g_error_free(key_error);
+    return false;
+  }
+  *value = read;
+  return true;
+}
+
+bool ReadString(GKeyFile* file, const char* key, std::string* value,
+                std::string* error) {
+  if (!g_key_file_has_key(file, kGroup, key, nullptr)) return true;
+  GError* key_error = nullptr;
+  gchar* read = g_key_file_get_string(file, kGroup, key, &key_error);
+  if (key_error) {
+    *error = std::string(key) + ": " + key_error->message;
+    g_error_free(key_error);
+    return false;
+  }
+  *value = read;
+  g_free(read);
+  return true;
+}
+
+// Reads every key of |file| over the defaults, and checks the ranges.
+bool FromKeyFile(GKeyFile* file, PipelineConfig* config, std::string* error) {
+  PipelineConfig loaded;
+  bool ok = ReadDouble(file, "axis_epsilon", &loaded.axis_epsilon, error) &&
+            ReadDouble(file, "trigger_epsilon", &loaded.trigger_epsilon,
+                       error) &&
+            ReadDouble(file, "stick_deadzone", &loaded.stick_deadzone,
+                       error) &&
+            ReadDouble(file, "trigger_deadzone", &loaded.trigger_deadzone,
+                       error) &&
+            ReadBool(file, "dedupe_buttons", &loaded.dedupe_buttons, error) &&
+            ReadInt(file, "min_drain_ms", &loaded.min_drain_ms, error) &&
+            ReadInt(file, "max_drain_ms", &loaded.max_drain_ms, error) &&
+            ReadString(file, "metrics_file", &loaded.metrics_file, error) &&
+            ReadInt(file, "metrics_interval_s", &loaded.metrics_interval_s,
+                    error) &&
+            ReadInt(file, "metrics_slots", &loaded.metrics_slots, error);
+  if (!ok) return false;
+
+  for (double value : {loaded.axis_epsilon, loaded.trigger_epsilon}) {
+    if (!(value >= 0.0 && value < 1.0)) {
+      *error = "epsilons must be in [0, 1)";
+      return false;
+    }
+  }
+  for (double value : {loaded.stick_deadzone, loaded.trigger_deadzone}) {
+    if (!(value >= 0.0 && value < 1.0)) {
+      *error = "deadzones must be in [0, 1)";
+      return false;
+    }
+  }
+  if (loaded.min_drain_ms && loaded.max_drain_ms &&
+      loaded.min_drain_ms > loaded.max_drain_ms) {
+    *error = "min_drain_ms must not exceed max_drain_ms";
+    return false;
+  }
+  if (loaded.metrics_slots > kMaxMetricsSlots) {
+    *error = "metrics_slots must be at most " +
+             std::to_string(kMaxMetricsSlots);
+    return false;
+  }
+  *config = loaded;
+  return true;
+}
+
+}  // namespace
+
+// static
+std::string PipelineConfig::DefaultPath() {
+  const gchar* path = g_getenv("UNIVERSAL_GAMEPAD_CONFIG");
+  if (path && *path) return path;
+  g_autofree gchar* default_path = g_build_filename(
+      g_get_user_config_dir(), "universal_gamepad", "pipeline.conf", nullptr);
+  return default_path;
+}
+
+// static
+bool PipelineConfig::Load(const std::string& path, PipelineConfig* config,
+                          std::string* error) {
+  PipelineConfig loaded;
+  GKeyFile* file = g_key_file_new();
+  GError* load_error = nullptr;
+  if (!g_key_file_load_from_file(file, path.c_str(), G_KEY_FILE_NONE,
+                                 &load_error)) {
+    g_key_file_free(file);
+    bool missing = g_error_matches(load_error, G_FILE_ERROR,
+                                   G_FILE_ERROR_NOENT);
+    if (!missing) *error = load_error->message;
+    g_error_free(load_error);
+    if (!missing) return false;
+    *config = loaded;
+    return true;
+  }
+
+  bool ok = FromKeyFile(file, &loaded, error);
+  g_key_file_free(file);
+  if (!ok) return false;
+  loaded.path = path;
+  *config = loaded;
+  return true;
+}
+
+// static
+bool PipelineConfig::Parse(const std::string& data, PipelineConfig* config,
+                           std::string* error) {
+  GKeyFile* file = g_key_file_new();
+  GError* load_error = nullptr;
+  if (!g_key_file_load_from_data(file, data.c_str(), data.size(),
+                                 G_KEY_FILE_NONE, &load_error)) {
+    *error = load_error->message;
+    g_error_free(load_error);
+    g_key_file_free(file);
+    return false;
+  }
+  bool ok = FromKeyFile(file, config, error);
+  g_key_file_free(file);
+  return ok;
+}
+
+std::vector<std::string> PipelineConfig::ToKeyValues() const {
+  std::vector<std::string> lines;
+  auto add = [&lines](const char* key, const std::string& value) {
+    lines.push_back(std::string(key) + "=" + value);
+  };
+  auto number = [](double value) {
+    gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+    return std::string(g_ascii_dtostr(buffer, sizeof(buffer), value));
+  };
+  add("axis_epsilon", number(axis_epsilon));
+  add("trigger_epsilon", number(trigger_epsilon));
+  add("stick_deadzone", number(stick_deadzone));
+  add("trigger_deadzone", number(trigger_deadzone));
+  add("dedupe_buttons", dedupe_buttons ? "true" : "false");
+  if (min_drain_ms) add("min_drain_ms", std::to_string(min_drain_ms));
+  if (max_drain_ms) add("max_drain_ms", std::to_string(max_drain_ms));
+  return lines;
+}
+
+// static
+double PipelineConfig::ApplyDeadzone(double value, double deadzone) {
+  if (deadzone <= 0.0) return value;
+  double magnitude = std::fabs(value);
+  if (magnitude <= deadzone) return 0.0;
+  double scaled = (magnitude - deadzone) / (1.0 - deadzone);
+  return value < 0 ? -scaled : scaled;
+}
+
+FlValue* PipelineConfig::ToValue() const {
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "version",
+                           fl_value_new_int(static_cast<int64_t>(version)));
+  fl_value_set_string_take(map, "path", fl_value_new_string(path.c_str()));
+  fl_value_set_string_take(map, "axisEpsilon",
+                           fl_value_new_float(axis_epsilon));
+  fl_value_set_string_take(map, "triggerEpsilon",
+                           fl_value_new_float(trigger_epsilon));
+  fl_value_set_string_take(map, "stickDeadzone",
+                           fl_value_new_float(stick_deadzone));
+  fl_value_set_string_take(map, "triggerDeadzone",
+                           fl_value_new_float(trigger_deadzone));
+  fl_value_set_string_take(map, "dedupeButtons",
+                           fl_value_new_bool(dedupe_buttons));
+  if (min_drain_ms) {
+    fl_value_set_string_take(map, "minDrainMs",
+                             fl_value_new_int(min_drain_ms));
+  }
+  if (max_drain_ms) {
+    fl_value_set_string_take(map, "maxDrainMs",
+                             fl_value_new_int(max_drain_ms));
+  }
+  if (!metrics_file.empty()) {
+    fl_value_set_string_take(map, "metricsFile",
+                             fl_value_new_string(metrics_file.c_str()));
+  }
+  fl_value_set_string_take(map, "metricsIntervalS",
+                           fl_value_new_int(metrics_interval_s));
+  fl_value_set_string_take(map, "metricsSlots",
+                           fl_value_new_int(metrics_slots));
+  return map;
+}
@@ -0,0 +1,75 @@
+#ifndef PIPELINE_CONFIG_H_
+#define PIPELINE_CONFIG_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Tunables of the event pipeline, loaded from an optional key file so a
+/// fleet can be retuned for a new controller model without a rebuild:
+///
+///   [pipeline]
+///   axis_epsilon=0.005      # smallest stick change that is delivered
+///   trigger_epsilon=0.005   # same for analog triggers
+///   stick_deadzone=0.0      # per-axis, rescaled past the edge
+///   trigger_deadzone=0.0
+///   dedupe_buttons=false    # drop button events that repeat the state
+///   min_drain_ms=4          # delivery batching bounds; unset keeps the
+///   max_drain_ms=16         # ones set through setDeliveryLatencyBounds
+///   metrics_file=/var/log/gamepad.metrics  # MetricsRing, off if unset
+///   metrics_interval_s=10   # seconds between snapshots
+///   metrics_slots=8640      # ring capacity in snapshots
+///
+/// Missing keys keep their defaults.  Snapshots are immutable once
+/// published; a reload builds a new one with a higher version.
+struct PipelineConfig {
+  // 0 for the built-in defaults.
+  uint64_t version = 0;
+  // File the values came from, "" for the defaults.
+  std::string path;
+  double axis_epsilon = 0.005;
+  double trigger_epsilon = 0.005;
+  double stick_deadzone = 0.0;
+  double trigger_deadzone = 0.0;
+  bool dedupe_buttons = false;
+  // 0 = not set.
+  guint min_drain_ms = 0;
+  guint max_drain_ms = 0;
+  // "" = no metrics file.
+  std::string metrics_file;
+  guint metrics_interval_s = 10;
+  // A day at the default interval, ~5.6 MiB.
+  guint metrics_slots = 8640;
+
+  /// $UNIVERSAL_GAMEPAD_CONFIG, or universal_gamepad/pipeline.conf in the
+  /// user config directory.
+  static std::string DefaultPath();
+
+  /// Parses |path| over the defaults into |config|.  Returns false, with
+  /// the reason in |error|, if the file exists but is malformed or out of
+  /// range; a missing file yields the defaults.
+  static bool Load(const std::string& path, PipelineConfig* config,
+                   std::string* error);
+
+  /// Parses key file text |data| over the defaults into |config|, with the
+  /// same checks as Load().
+  static bool Parse(const std::string& data, PipelineConfig* config,
+                    std::string* error);
+
+  /// The keys that shape event processing (not the metrics file), as
+  /// "key=value" lines of the [pipeline] group that Parse() reads back.
+  std::vector<std::string> ToKeyValues() const;
+
+  /// Rescales |value| (-1..1 or 0..1) so |deadzone| around zero reads 0.
+  static double ApplyDeadzone(double value, double deadzone);
+
+  /// Builds the diagnostics map: {version, path, axisEpsilon,
+  /// triggerEpsilon, stickDeadzone, triggerDeadzone, dedupeButtons,
+  /// minDrainMs?, maxDrainMs?, metricsFile?, metricsIntervalS,
+  /// metricsSlots}.
+  FlValue* ToValue() const;
+};
+
+#endif  // PIPELINE_CONFIG_H_
@@ -0,0 +1,45 @@
+#include "pointer_emulator.h"
+
+#include <algorithm>
+#include <cmath>
+
+void PointerEmulator::OnAxis(int index, double value, int64_t time_us,
+                             const PointerSettings& settings) {
+  if (index != settings.x_axis && index != settings.x_axis + 1) return;
+  Integrate(time_us, settings);
+  if (index == settings.x_axis) {
+    stick_x_ = value;
+  } else {
+    stick_y_ = value;
+  }
+}
+
+bool PointerEmulator::Take(int64_t now_us, const PointerSettings& settings,
+                           double* dx, double* dy) {
+  Integrate(now_us, settings);
+  if (delta_x_ == 0.0 && delta_y_ == 0.0) return false;
+  *dx = delta_x_;
+  *dy = delta_y_;
+  delta_x_ = 0.0;
+  delta_y_ = 0.0;
+  return true;
+}
+
+void PointerEmulator::Integrate(int64_t time_us,
+                                const PointerSettings& settings) {
+  int64_t last_us = last_us_;
+  if (time_us <= last_us) return;
+  last_us_ = time_us;
+  if (last_us == 0) return;
+
+  double magnitude = std::hypot(stick_x_, stick_y_);
+  if (magnitude <= settings.deadzone) return;
+
+  // Rescale past the deadzone so motion starts from zero at its edge.
+  double live = std::min(
+      (magnitude - settings.deadzone) / (1.0 - settings.deadzone), 1.0);
+  double speed = settings.speed * std::pow(live, settings.curve);
+  double dt = (time_us - last_us) / 1e6;
+  delta_x_ += stick_x_ / magnitude * speed * dt;
+  delta_y_ += stick_y_ / magnitude * speed * dt;
+}
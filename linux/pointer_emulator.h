@@ -0,0 +1,52 @@
+#ifndef POINTER_EMULATOR_H_
+#define POINTER_EMULATOR_H_
+
+#include <cstdint>
+
+/// Tunables of stick pointer emulation.
+struct PointerSettings {
+  // W3C index of the stick's X axis; Y is the next axis.
+  int x_axis = 2;
+  // Pointer speed at full deflection, in logical pixels per second.
+  double speed = 1500.0;
+  // Radial deadzone as a fraction of full deflection.
+  double deadzone = 0.15;
+  // Response curve exponent applied past the deadzone; 1 is linear.
+  double curve = 2.0;
+};
+
+/// Integrates a stick into cursor motion.
+///
+/// The stick's deflection is mapped through a radial deadzone and a power
+/// response curve to a velocity, which is integrated over the time between
+/// raw samples (using their kernel timestamps) and, when the accumulated
+/// delta is taken, up to the current time.  Motion therefore depends only
+/// on how long the stick was held where, not on how often samples or
+/// deliveries happen.
+///
+/// Not thread-safe; EvdevManager guards it with its queue mutex.
+class PointerEmulator {
+ public:
+  /// Records a raw sample of W3C axis |index| at time |time_us|, first
+  /// integrating the previous deflection up to it.  Axes other than the
+  /// configured stick are ignored.
+  void OnAxis(int index, double value, int64_t time_us,
+              const PointerSettings& settings);
+
+  /// Integrates up to |now_us| and moves the delta accumulated since the
+  /// previous call into |dx| and |dy|.  Returns false when there was no
+  /// motion.
+  bool Take(int64_t now_us, const PointerSettings& settings, double* dx,
+            double* dy);
+
+ private:
+  void Integrate(int64_t time_us, const PointerSettings& settings);
+
+  double stick_x_ = 0.0;
+  double stick_y_ = 0.0;
+  int64_t last_us_ = 0;
+  double delta_x_ = 0.0;
+  double delta_y_ = 0.0;
+};
+
+#endif  // POINTER_EMULATOR_H_
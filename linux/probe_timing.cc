@@ -0,0 +1,49 @@
+#include "probe_timing.h"
+
+namespace {
+
+const char* OutcomeName(ProbeTiming::Outcome outcome) {
+  switch (outcome) {
+    case ProbeTiming::Outcome::kAttached:
+      return "attached";
+    case ProbeTiming::Outcome::kOpenFailed:
+      return "openFailed";
+    case ProbeTiming::Outcome::kEvdevFailed:
+      return "evdevFailed";
+    case ProbeTiming::Outcome::kNotGamepad:
+      return "notGamepad";
+    case ProbeTiming::Outcome::kDropped:
+      return "dropped";
+  }
+  return "unknown";
+}
+
+}  // namespace
+
+FlValue* ProbeTiming::ToValue(int64_t origin_us) const {
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "path", fl_value_new_string(path.c_str()));
+  fl_value_set_string_take(map, "outcome",
+                           fl_value_new_string(OutcomeName(outcome)));
+  if (gamepad_id >= 0) {
+    fl_value_set_string_take(map, "id", fl_value_new_int(gamepad_id));
+  }
+  fl_value_set_string_take(map, "atUs",
+                           fl_value_new_int(started_at_us - origin_us));
+  fl_value_set_string_take(map, "openUs", fl_value_new_int(open_us));
+  fl_value_set_string_take(map, "evdevInitUs",
+                           fl_value_new_int(evdev_init_us));
+  fl_value_set_string_take(map, "classifyUs", fl_value_new_int(classify_us));
+  fl_value_set_string_take(map, "absInfoUs", fl_value_new_int(abs_info_us));
+  fl_value_set_string_take(map, "handoffUs", fl_value_new_int(handoff_us));
+  fl_value_set_string_take(map, "attachUs", fl_value_new_int(attach_us));
+  if (attached_at_us) {
+    fl_value_set_string_take(map, "attachedAtUs",
+                             fl_value_new_int(attached_at_us - origin_us));
+  }
+  if (first_event_at_us) {
+    fl_value_set_string_take(map, "firstEventAtUs",
+                             fl_value_new_int(first_event_at_us - origin_us));
+  }
+  return map;
+}
@@ -0,0 +1,50 @@
+#ifndef PROBE_TIMING_H_
+#define PROBE_TIMING_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+#include <cstdint>
+#include <string>
+
+/// Where the time of one device probe went.  Times are GLib monotonic
+/// microseconds; durations are per phase, in the order they run.
+struct ProbeTiming {
+  enum class Outcome {
+    kAttached,
+    kOpenFailed,
+    kEvdevFailed,
+    kNotGamepad,
+    // Probed, but gone or attached elsewhere before the worker took it.
+    kDropped,
+  };
+
+  std::string path;
+  Outcome outcome = Outcome::kAttached;
+  // -1 unless attached.
+  int gamepad_id = -1;
+  int64_t started_at_us = 0;
+  // open().
+  int64_t open_us = 0;
+  // libevdev_new_from_fd().
+  int64_t evdev_init_us = 0;
+  // Gamepad check, capability and battery lookups.
+  int64_t classify_us = 0;
+  int64_t abs_info_us = 0;
+  // Probe finished until the worker started attaching (hand-off queue).
+  int64_t handoff_us = 0;
+  // IO watch creation and registration on the worker.
+  int64_t attach_us = 0;
+  // When the device was attached, 0 if it never was.
+  int64_t attached_at_us = 0;
+  // When its first input event was delivered, 0 if none has been yet.
+  int64_t first_event_at_us = 0;
+
+  /// Builds the diagnostics map of this probe, with absolute times made
+  /// relative to |origin_us|:
+  ///
+  ///   {path, outcome, id?, atUs, openUs, evdevInitUs, classifyUs,
+  ///    absInfoUs, handoffUs, attachUs, attachedAtUs?, firstEventAtUs?}
+  FlValue* ToValue(int64_t origin_us) const;
+};
+
+#endif  // PROBE_TIMING_H_
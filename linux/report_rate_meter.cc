@@ -0,0 +1,69 @@
+#include "report_rate_meter.h"
+
+#include <cmath>
+
+void ReportRateMeter::OnReport(int64_t time_us) {
+  int64_t last_us = last_us_;
+  last_us_ = time_us;
+  if (last_us == 0 || time_us <= last_us) return;
+
+  auto interval = static_cast<double>(time_us - last_us);
+  uint64_t count = intervals_.load(std::memory_order_relaxed);
+  double mean = mean_interval_us_.load(std::memory_order_relaxed);
+
+  if (count >= kWarmupIntervals && interval > mean * kGapFactor) {
+    gaps_.store(gaps_.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+    // A run of "gaps" means the device really slowed down (e.g. switched
+    // from USB to Bluetooth polling): start measuring afresh.
+    if (++consecutive_gaps_ < kWarmupIntervals) return;
+    count = 0;
+  }
+  consecutive_gaps_ = 0;
+
+  double deviation = count == 0 ? 0.0 : std::fabs(interval - mean);
+  if (count == 0) {
+    mean = interval;
+  } else {
+    mean += (interval - mean) * kAlpha;
+  }
+  double jitter = jitter_us_.load(std::memory_order_relaxed);
+  jitter += (deviation - jitter) * kAlpha;
+
+  int bucket = 0;
+  while (bucket < kBucketCount - 1 && deviation > kBucketLimitsUs[bucket]) {
+    ++bucket;
+  }
+
+  mean_interval_us_.store(mean, std::memory_order_relaxed);
+  jitter_us_.store(jitter, std::memory_order_relaxed);
+  buckets_[bucket].store(
+      buckets_[bucket].load(std::memory_order_relaxed) + 1,
+      std::memory_order_relaxed);
+  intervals_.store(count + 1, std::memory_order_relaxed);
+}
+
+double ReportRateMeter::rate_hz() const {
+  double mean = mean_interval_us_.load(std::memory_order_relaxed);
+  return mean > 0.0 ? 1e6 / mean : 0.0;
+}
+
+double ReportRateMeter::mean_interval_us() const {
+  return mean_interval_us_.load(std::memory_order_relaxed);
+}
+
+double ReportRateMeter::jitter_us() const {
+  return jitter_us_.load(std::memory_order_relaxed);
+}
+
+uint64_t ReportRateMeter::intervals() const {
+  return intervals_.load(std::memory_order_relaxed);
+}
+
+uint64_t ReportRateMeter::gaps() const {
+  return gaps_.load(std::memory_order_relaxed);
+}
+
+uint64_t ReportRateMeter::bucket(int index) const {
+  return buckets_[index].load(std::memory_order_relaxed);
+}
@@ -0,0 +1,65 @@
+#ifndef REPORT_RATE_METER_H_
+#define REPORT_RATE_METER_H_
+
+#include <atomic>
+#include <cstdint>
+
+/// Measures a device's report cadence from the kernel timestamps of its
+/// SYN_REPORTs.
+///
+/// evdev only reports when something changed, so a resting pad goes quiet
+/// and an idle-ish one skips reports.  Once the meter has warmed up,
+/// intervals longer than kGapFactor times the running mean are counted as
+/// gaps instead of being averaged in, so the rate tracks the device's real
+/// polling interval rather than how busy the player is.
+///
+/// Jitter is the running mean absolute deviation of each interval from the
+/// running mean interval; the histogram buckets the same deviations.
+///
+/// Single writer (the evdev worker).  Readers on any thread get relaxed
+/// atomic snapshots, which may mix values from adjacent reports.
+class ReportRateMeter {
+ public:
+  static constexpr int kBucketCount = 8;
+
+  /// Upper bounds in microseconds of the jitter histogram buckets; the last
+  /// bucket holds everything above the final bound.
+  static constexpr int64_t kBucketLimitsUs[kBucketCount - 1] = {
+      125, 250, 500, 1000, 2000, 4000, 8000};
+
+  ReportRateMeter() = default;
+
+  ReportRateMeter(const ReportRateMeter&) = delete;
+  ReportRateMeter& operator=(const ReportRateMeter&) = delete;
+
+  /// Records a SYN_REPORT at kernel time |time_us|.  Writer thread only.
+  void OnReport(int64_t time_us);
+
+  /// Reports per second derived from the mean interval; 0 until measured.
+  double rate_hz() const;
+  double mean_interval_us() const;
+  double jitter_us() const;
+  /// Intervals averaged in, and intervals skipped as gaps.
+  uint64_t intervals() const;
+  uint64_t gaps() const;
+  uint64_t bucket(int index) const;
+
+ private:
+  // Smoothing factor of the running means (~32 report time constant).
+  static constexpr double kAlpha = 1.0 / 32;
+  // Intervals averaged in before gap filtering starts.
+  static constexpr uint64_t kWarmupIntervals = 16;
+  static constexpr double kGapFactor = 2.5;
+
+  // Writer only.
+  int64_t last_us_ = 0;
+  uint64_t consecutive_gaps_ = 0;
+
+  std::atomic<double> mean_interval_us_{0.0};
+  std::atomic<double> jitter_us_{0.0};
+  std::atomic<uint64_t> intervals_{0};
+  std::atomic<uint64_t> gaps_{0};
+  std::atomic<uint64_t> buckets_[kBucketCount] = {};
+};
+
+#endif  // REPORT_RATE_METER_H_
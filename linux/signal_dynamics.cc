@@ -0,0 +1,93 @@
+#include "signal_dynamics.h"
+
+#include <algorithm>
+#include <cmath>
+
+void SignalDynamics::Add(int channel, double value, int64_t time_us) {
+  Channel& c = channels_[channel];
+  int64_t last_us = c.last_us;
+  double last_value = c.last_value;
+  c.last_us = time_us;
+  c.last_value = value;
+  c.value.store(value, std::memory_order_relaxed);
+  c.time_us.store(time_us, std::memory_order_relaxed);
+  // The first sample has nothing to differentiate against, and samples
+  // sharing a timestamp (one SYN_REPORT) have no interval.
+  if (last_us == 0 || time_us <= last_us) return;
+
+  auto dt_us = static_cast<double>(time_us - last_us);
+  double dt = dt_us / 1e6;
+  double velocity = c.velocity.load(std::memory_order_relaxed);
+  double acceleration = c.acceleration.load(std::memory_order_relaxed);
+
+  // Score the predictor on this sample before updating it.
+  double mean_interval = c.mean_interval_us.load(std::memory_order_relaxed);
+  bool held = mean_interval > 0.0 && dt_us > mean_interval * kHeldFactor;
+  if (!held) {
+    double predicted = last_value + Extrapolate(velocity, dt_us);
+    double error_rate = c.error_rate.load(std::memory_order_relaxed);
+    error_rate += (std::fabs(value - predicted) / dt - error_rate) / 16;
+    c.error_rate.store(error_rate, std::memory_order_relaxed);
+    mean_interval = mean_interval == 0.0
+                        ? dt_us
+                        : mean_interval + (dt_us - mean_interval) / 16;
+    c.mean_interval_us.store(mean_interval, std::memory_order_relaxed);
+  }
+
+  double raw_velocity = (value - last_value) / dt;
+  double next_velocity =
+      velocity +
+      (raw_velocity - velocity) * (1.0 - std::exp(-dt_us / kVelocityTauUs));
+  double raw_acceleration = (next_velocity - velocity) / dt;
+  acceleration += (raw_acceleration - acceleration) *
+                  (1.0 - std::exp(-dt_us / kAccelerationTauUs));
+
+  c.velocity.store(next_velocity, std::memory_order_relaxed);
+  c.acceleration.store(acceleration, std::memory_order_relaxed);
+}
+
+SignalDynamics::State SignalDynamics::Read(int channel,
+                                           int64_t now_us) const {
+  const Channel& c = channels_[channel];
+  State state{c.value.load(std::memory_order_relaxed),
+              c.velocity.load(std::memory_order_relaxed),
+              c.acceleration.load(std::memory_order_relaxed)};
+  // No samples since |time_us| means the signal has been holding still.
+  int64_t held_us = now_us - c.time_us.load(std::memory_order_relaxed);
+  if (held_us > 0) {
+    state.velocity *= std::exp(-held_us / kVelocityTauUs);
+    state.acceleration *= std::exp(-held_us / kAccelerationTauUs);
+  }
+  return state;
+}
+
+SignalDynamics::Prediction SignalDynamics::Predict(int channel,
+                                                   int64_t now_us,
+                                                   int64_t target_us) const {
+  const Channel& c = channels_[channel];
+  double value = c.value.load(std::memory_order_relaxed);
+  int64_t time_us = c.time_us.load(std::memory_order_relaxed);
+  double mean_interval = c.mean_interval_us.load(std::memory_order_relaxed);
+  double error_rate = c.error_rate.load(std::memory_order_relaxed);
+
+  bool held = mean_interval == 0.0 ||
+              now_us - time_us > mean_interval * kHeldFactor;
+  // A held signal stays put; a moving one is extrapolated from its last
+  // sample, which is already |now_us - time_us| old.
+  int64_t from_us = held ? std::max(now_us, time_us) : time_us;
+  double h_us = std::max<int64_t>(target_us - from_us, 0);
+  if (!held) {
+    value += Extrapolate(c.velocity.load(std::memory_order_relaxed), h_us);
+  }
+  double low = channel < kTriggerChannel ? -1.0 : 0.0;
+  value = std::clamp(value, low, 1.0);
+
+  double expected_error = error_rate * h_us / 1e6;
+  return {value, 1.0 / (1.0 + expected_error / kErrorTolerance)};
+}
+
+// static
+double SignalDynamics::Extrapolate(double velocity, double h_us) {
+  return velocity * kPredictionTauUs / 1e6 *
+         (1.0 - std::exp(-h_us / kPredictionTauUs));
+}
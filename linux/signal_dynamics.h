@@ -0,0 +1,94 @@
+#ifndef SIGNAL_DYNAMICS_H_
+#define SIGNAL_DYNAMICS_H_
+
+#include <atomic>
+#include <cstdint>
+
+/// Filtered first and second derivatives of a pad's analog signals, taken
+/// from every raw sample and its kernel timestamp.
+///
+/// Runs before throttling and coalescing, so the derivatives see the full
+/// sample stream at microsecond resolution instead of the millisecond-
+/// stamped events Dart receives.  Each derivative is a finite difference
+/// smoothed by a one-pole low-pass whose coefficient follows the sample
+/// interval, so irregular report timing does not bias it.  evdev goes quiet
+/// when a signal stops changing; readers therefore decay the derivatives by
+/// the time elapsed since the last sample.
+///
+/// Predict() extrapolates a channel to a future time with a damped
+/// constant-velocity model: the filtered velocity at the last sample,
+/// fading with kPredictionTauUs so long horizons don't run away.  A
+/// channel that has gone quiet for longer than kHeldFactor sample
+/// intervals is holding still and predicts its last value.  Confidence
+/// comes from the running one-step error of the same model on the actual
+/// samples, scaled to the horizon.
+///
+/// Single writer (the evdev worker).  Readers on any thread get relaxed
+/// atomic snapshots, which may mix values from adjacent samples.
+class SignalDynamics {
+ public:
+  /// Channels 0-3 are the W3C stick axes, kTriggerChannel and the next one
+  /// the left and right trigger.
+  static constexpr int kTriggerChannel = 4;
+  static constexpr int kChannelCount = 6;
+
+  struct State {
+    double value;
+    // Units per second, and per second squared.
+    double velocity;
+    double acceleration;
+  };
+
+  struct Prediction {
+    double value;
+    // 0 (no better than a guess) to 1.
+    double confidence;
+  };
+
+  SignalDynamics() = default;
+
+  SignalDynamics(const SignalDynamics&) = delete;
+  SignalDynamics& operator=(const SignalDynamics&) = delete;
+
+  /// Records a raw |value| of |channel| at kernel time |time_us|.  Writer
+  /// thread only.
+  void Add(int channel, double value, int64_t time_us);
+
+  /// Returns |channel| as of |now_us| (same clock as the kernel timestamps).
+  State Read(int channel, int64_t now_us) const;
+
+  /// Extrapolates |channel| to |target_us| as seen at |now_us|.
+  Prediction Predict(int channel, int64_t now_us, int64_t target_us) const;
+
+ private:
+  // Smoothing time constants of the velocity and acceleration filters.
+  static constexpr double kVelocityTauUs = 8000.0;
+  static constexpr double kAccelerationTauUs = 16000.0;
+  // Fade-out of the extrapolated velocity.
+  static constexpr double kPredictionTauUs = 50000.0;
+  // Quiet for this many mean sample intervals means the signal is held.
+  static constexpr double kHeldFactor = 2.5;
+  // Expected prediction error at which confidence drops to one half.
+  static constexpr double kErrorTolerance = 0.02;
+
+  /// Distance the damped constant-velocity model travels over |h_us|.
+  static double Extrapolate(double velocity, double h_us);
+
+  struct Channel {
+    // Writer only.
+    double last_value = 0.0;
+    int64_t last_us = 0;
+
+    std::atomic<double> value{0.0};
+    std::atomic<double> velocity{0.0};
+    std::atomic<double> acceleration{0.0};
+    std::atomic<int64_t> time_us{0};
+    std::atomic<double> mean_interval_us{0.0};
+    // Running one-step prediction error, in value units per second.
+    std::atomic<double> error_rate{0.0};
+  };
+
+  Channel channels_[kChannelCount];
+};
+
+#endif  // SIGNAL_DYNAMICS_H_
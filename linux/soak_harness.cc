@@ -0,0 +1,250 @@
+#include "soak_harness.h"
+
+#include "evdev_manager.h"
+#include "virtual_gamepad.h"
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace SoakHarness {
+
+namespace {
+
+// Time for the worker to notice a created or destroyed pad.
+constexpr guint kSettleMs = 100;
+// Cycles run before the baseline sample, so one-off allocations (GLib type
+// registration, queue growth) don't count as leaks.
+constexpr int kWarmupCycles = 20;
+constexpr int kSampleEvery = 50;
+// Largest tolerated RSS growth, as the least-squares slope over the samples
+// after the warm-up: about 100 bytes per cycle.  Allocator noise moves RSS
+// by whole pages now and then, which over hundreds of cycles stays far
+// below this; a leak of even one small allocation per cycle does not.
+constexpr double kMaxRssKbPerCycle = 0.1;
+// Fewer samples than this can't tell a slope from a step.
+constexpr size_t kMinSlopeSamples = 3;
+
+struct Metrics {
+  int cycle;
+  int64_t rss_kb;
+  int fds;
+  int live_sources;
+  int attached_sources;
+};
+
+int64_t ReadRssKb() {
+  FILE* file = fopen("/proc/self/statm", "r");
+  if (!file) return 0;
+  long long pages = 0;
+  long long resident = 0;
+  if (fscanf(file, "%lld %lld", &pages, &resident) != 2) resident = 0;
+  fclose(file);
+  return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+int CountFds() {
+  DIR* dir = opendir("/proc/self/fd");
+  if (!dir) return 0;
+  int count = 0;
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != nullptr) {
+    if (entry->d_name[0] != '.') ++count;
+  }
+  closedir(dir);
+  // Don't count the descriptor opendir() itself holds.
+  return count - 1;
+}
+
+// State of one soak, owned by its pending GLib timeout.
+struct Run {
+  FlMethodCall* method_call;
+  EvdevManager* manager;
+  int cycles;
+  int events_per_cycle;
+  int cycle = 0;
+  std::unique_ptr<VirtualGamepad> pad;
+  std::vector<Metrics> samples;
+};
+
+// Number of sources attached to |context|.  GLib has no call for this, but
+// a context hands out source ids in increasing order, so every attached
+// source has an id below the one a new source gets.
+int CountSources(GMainContext* context) {
+  GSource* marker = g_idle_source_new();
+  guint top = g_source_attach(marker, context);
+  g_source_destroy(marker);
+  g_source_unref(marker);
+  int count = 0;
+  for (guint id = 1; id < top; ++id) {
+    if (g_main_context_find_source_by_id(context, id)) ++count;
+  }
+  return count;
+}
+
+// Sources on the worker and probe contexts.  The main context is left out:
+// the engine attaches short-lived sources of its own there, and the
+// plugin's sources on it are its timers and live_sources() tasks.
+int CountManagerSources(const EvdevManager& manager) {
+  GMainContext* worker = manager.worker_context();
+  GMainContext* probe = manager.probe_context();
+  GMainContext* main = g_main_context_default();
+  int count = 0;
+  if (worker && worker != main) count += CountSources(worker);
+  if (probe && probe != main && probe != worker) count += CountSources(probe);
+  return count;
+}
+
+Metrics Sample(const Run& run) {
+  return {run.cycle, ReadRssKb(), CountFds(), run.manager->live_sources(),
+          CountManagerSources(*run.manager)};
+}
+
+// Least-squares slope of RSS over cycles, in KiB per cycle.
+double RssSlope(const std::vector<Metrics>& samples) {
+  double n = static_cast<double>(samples.size());
+  double sum_x = 0, sum_y = 0, sum_xx = 0, sum_xy = 0;
+  for (const Metrics& m : samples) {
+    double x = m.cycle;
+    double y = static_cast<double>(m.rss_kb);
+    sum_x += x;
+    sum_y += y;
+    sum_xx += x * x;
+    sum_xy += x * y;
+  }
+  double denominator = n * sum_xx - sum_x * sum_x;
+  if (denominator == 0) return 0;
+  return (n * sum_xy - sum_x * sum_y) / denominator;
+}
+
+FlValue* BuildReport(const Run& run) {
+  const Metrics& baseline = run.samples.front();
+  const Metrics& last = run.samples.back();
+  int64_t rss_growth = last.rss_kb - baseline.rss_kb;
+  double rss_slope = run.samples.size() >= kMinSlopeSamples
+                         ? RssSlope(run.samples)
+                         : 0.0;
+  int fd_growth = last.fds - baseline.fds;
+  int source_growth = last.attached_sources - baseline.attached_sources;
+  int live_source_growth = last.live_sources - baseline.live_sources;
+  bool leaked = rss_slope > kMaxRssKbPerCycle || fd_growth > 0 ||
+                source_growth > 0 || live_source_growth > 0;
+
+  FlValue* samples = fl_value_new_list();
+  for (const Metrics& m : run.samples) {
+    FlValue* sample = fl_value_new_map();
+    fl_value_set_string_take(sample, "cycle", fl_value_new_int(m.cycle));
+    fl_value_set_string_take(sample, "rssKb", fl_value_new_int(m.rss_kb));
+    fl_value_set_string_take(sample, "fds", fl_value_new_int(m.fds));
+    fl_value_set_string_take(sample, "liveSources",
+                             fl_value_new_int(m.live_sources));
+    fl_value_set_string_take(sample, "attachedSources",
+                             fl_value_new_int(m.attached_sources));
+    fl_value_append_take(samples, sample);
+  }
+
+  FlValue* report = fl_value_new_map();
+  fl_value_set_string_take(report, "cycles", fl_value_new_int(run.cycle));
+  fl_value_set_string_take(report, "leaked", fl_value_new_bool(leaked));
+  fl_value_set_string_take(report, "rssGrowthKb",
+                           fl_value_new_int(rss_growth));
+  fl_value_set_string_take(report, "rssSlopeKbPerCycle",
+                           fl_value_new_float(rss_slope));
+  fl_value_set_string_take(report, "maxRssSlopeKbPerCycle",
+                           fl_value_new_float(kMaxRssKbPerCycle));
+  fl_value_set_string_take(report, "fdGrowth", fl_value_new_int(fd_growth));
+  fl_value_set_string_take(report, "sourceGrowth",
+                           fl_value_new_int(source_growth));
+  fl_value_set_string_take(report, "liveSourceGrowth",
+                           fl_value_new_int(live_source_growth));
+  fl_value_set_string_take(report, "samples", samples);
+  return report;
+}
+
+void Finish(Run* run) {
+  std::unique_ptr<Run> owned(run);
+  g_autoptr(GError) error = nullptr;
+  gboolean ok;
+  if (run->samples.empty()) {
+    ok = fl_method_call_respond_error(run->method_call, "soak_error",
+                                      "Too few cycles to sample", nullptr,
+                                      &error);
+  } else {
+    g_autoptr(FlValue) report = BuildReport(*run);
+    ok = fl_method_call_respond_success(run->method_call, report, &error);
+  }
+  if (!ok) {
+    g_warning("gamepad: failed to respond to soak: %s", error->message);
+  }
+  g_object_unref(run->method_call);
+}
+
+gboolean OnDisconnected(gpointer user_data);
+
+// The pad has been picked up by the worker: stream input, then unplug it.
+gboolean OnConnected(gpointer user_data) {
+  auto* run = static_cast<Run*>(user_data);
+  for (int i = 0; i < run->events_per_cycle; ++i) {
+    run->pad->SetAxis(i % ButtonMapping::kAxisCount,
+                      (i % 200) / 100.0 - 1.0);
+    run->pad->SetButton(0, i % 2 == 0 ? 1.0 : 0.0);
+    run->pad->Sync();
+  }
+  run->pad.reset();
+  g_timeout_add(kSettleMs, OnDisconnected, run);
+  return G_SOURCE_REMOVE;
+}
+
+// The previous pad is gone: sample if due, then plug in the next one.
+gboolean OnDisconnected(gpointer user_data) {
+  auto* run = static_cast<Run*>(user_data);
+  if (run->cycle >= kWarmupCycles &&
+      ((run->cycle - kWarmupCycles) % kSampleEvery == 0 ||
+       run->cycle == run->cycles)) {
+    run->samples.push_back(Sample(*run));
+  }
+  if (run->cycle == run->cycles) {
+    Finish(run);
+    return G_SOURCE_REMOVE;
+  }
+
+  ++run->cycle;
+  run->pad = VirtualGamepad::Create("Universal Gamepad Soak", 0, 0,
+                                    VirtualGamepad::kInjectorPhys);
+  if (!run->pad) {
+    Finish(run);
+    return G_SOURCE_REMOVE;
+  }
+  g_timeout_add(kSettleMs, OnConnected, run);
+  return G_SOURCE_REMOVE;
+}
+
+}  // namespace
+
+void Start(FlMethodCall* method_call, EvdevManager* manager, int cycles,
+           int events_per_cycle) {
+  // Probe for uinput up front so the caller gets a clear error.
+  if (!VirtualGamepad::Create("Universal Gamepad Soak", 0, 0,
+                              VirtualGamepad::kInjectorPhys)) {
+    g_autoptr(GError) error = nullptr;
+    if (!fl_method_call_respond_error(method_call, "soak_unavailable",
+                                      "/dev/uinput is not writable", nullptr,
+                                      &error)) {
+      g_warning("gamepad: failed to respond to soak: %s", error->message);
+    }
+    return;
+  }
+
+  auto* run = new Run();
+  run->method_call = FL_METHOD_CALL(g_object_ref(method_call));
+  run->manager = manager;
+  run->cycles = cycles;
+  run->events_per_cycle = events_per_cycle;
+  // Let the probe pad's removal settle before the first cycle.
+  g_timeout_add(kSettleMs, OnDisconnected, run);
+}
+
+}  // namespace SoakHarness
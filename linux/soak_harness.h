@@ -0,0 +1,35 @@
+#ifndef SOAK_HARNESS_H_
+#define SOAK_HARNESS_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+class EvdevManager;
+
+/// Hotplug churn soak test for the device lifecycle.
+///
+/// Each cycle creates a uinput pad (picked up by |manager| through hotplug
+/// like a physical device), streams input through it, and destroys it again.
+/// Process RSS, open fds, EvdevManager::live_sources() and the sources
+/// actually attached to the worker and probe contexts are sampled every
+/// kSampleEvery cycles once a warm-up has passed.  The run is marked
+/// leaking when the fd or source counts end above their post-warm-up
+/// baseline, or when RSS grows by more than kMaxRssKbPerCycle per cycle
+/// (least-squares slope over the samples).  The result map is sent as the
+/// response to |method_call|:
+///
+///   {cycles, leaked, rssGrowthKb, rssSlopeKbPerCycle,
+///    maxRssSlopeKbPerCycle, fdGrowth, sourceGrowth, liveSourceGrowth,
+///    samples: [{cycle, rssKb, fds, liveSources, attachedSources}]}
+///
+/// Responds with a "soak_unavailable" error when /dev/uinput is not
+/// writable.
+namespace SoakHarness {
+
+/// Starts a soak of |cycles| cycles of |events_per_cycle| input events each.
+/// |manager| must outlive the run.  Main thread only.
+void Start(FlMethodCall* method_call, EvdevManager* manager, int cycles,
+           int events_per_cycle);
+
+}  // namespace SoakHarness
+
+#endif  // SOAK_HARNESS_H_
@@ -0,0 +1,139 @@
+#include "virtual_gamepad.h"
+
+#include "button_mapping.h"
+
+#include <glib.h>
+#include <libevdev/libevdev-uinput.h>
+#include <libevdev/libevdev.h>
+
+#include <cmath>
+#include <cstring>
+#include <unistd.h>
+
+namespace {
+
+constexpr int kStickMin = -32768;
+constexpr int kStickMax = 32767;
+constexpr int kTriggerMax = 255;
+
+void EnableAbs(struct libevdev* dev, unsigned int code, int minimum,
+               int maximum, int flat) {
+  struct input_absinfo ai {};
+  ai.minimum = minimum;
+  ai.maximum = maximum;
+  ai.flat = flat;
+  libevdev_enable_event_code(dev, EV_ABS, code, &ai);
+}
+
+}  // namespace
+
+std::unique_ptr<VirtualGamepad> VirtualGamepad::Create(
+    const std::string& name, uint16_t vendor_id, uint16_t product_id,
+    const char* phys) {
+  struct libevdev* dev = libevdev_new();
+  if (!dev) return nullptr;
+
+  libevdev_set_name(dev, name.c_str());
+  libevdev_set_phys(dev, phys);
+  libevdev_set_id_bustype(dev, BUS_VIRTUAL);
+  libevdev_set_id_vendor(dev, vendor_id);
+  libevdev_set_id_product(dev, product_id);
+
+  libevdev_enable_event_type(dev, EV_KEY);
+  for (int i = 0; i < ButtonMapping::kButtonCount; ++i) {
+    int code = ButtonMapping::W3CButtonToEvdev(i);
+    if (code >= 0) libevdev_enable_event_code(dev, EV_KEY, code, nullptr);
+  }
+
+  libevdev_enable_event_type(dev, EV_ABS);
+  for (int i = 0; i < ButtonMapping::kAxisCount; ++i) {
+    EnableAbs(dev, ButtonMapping::W3CAxisToEvdev(i), kStickMin, kStickMax,
+              0);
+  }
+  EnableAbs(dev, ABS_Z, 0, kTriggerMax, 0);
+  EnableAbs(dev, ABS_RZ, 0, kTriggerMax, 0);
+  EnableAbs(dev, ABS_HAT0X, -1, 1, 0);
+  EnableAbs(dev, ABS_HAT0Y, -1, 1, 0);
+
+  struct libevdev_uinput* uinput = nullptr;
+  int rc = libevdev_uinput_create_from_device(
+      dev, LIBEVDEV_UINPUT_OPEN_MANAGED, &uinput);
+  libevdev_free(dev);
+  if (rc < 0) {
+    g_warning("evdev: failed to create uinput device: %s", strerror(-rc));
+    return nullptr;
+  }
+
+  return std::unique_ptr<VirtualGamepad>(new VirtualGamepad(uinput));
+}
+
+VirtualGamepad::VirtualGamepad(struct libevdev_uinput* uinput)
+    : uinput_(uinput), fd_(libevdev_uinput_get_fd(uinput)) {}
+
+VirtualGamepad::~VirtualGamepad() { libevdev_uinput_destroy(uinput_); }
+
+void VirtualGamepad::SetButton(int index, double value) {
+  switch (index) {
+    case ButtonMapping::kLeftTrigger:
+      Queue(EV_ABS, ABS_Z,
+            static_cast<int32_t>(std::lround(value * kTriggerMax)));
+      return;
+    case ButtonMapping::kRightTrigger:
+      Queue(EV_ABS, ABS_RZ,
+            static_cast<int32_t>(std::lround(value * kTriggerMax)));
+      return;
+    case ButtonMapping::kDpadUp:
+    case ButtonMapping::kDpadDown:
+    case ButtonMapping::kDpadLeft:
+    case ButtonMapping::kDpadRight: {
+      dpad_[index - ButtonMapping::kDpadUp] = value > 0.5;
+      bool up = dpad_[0], down = dpad_[1], left = dpad_[2], right = dpad_[3];
+      if (index <= ButtonMapping::kDpadDown) {
+        Queue(EV_ABS, ABS_HAT0Y, (down ? 1 : 0) - (up ? 1 : 0));
+      } else {
+        Queue(EV_ABS, ABS_HAT0X, (right ? 1 : 0) - (left ? 1 : 0));
+      }
+      return;
+    }
+    default: {
+      int code = ButtonMapping::W3CButtonToEvdev(index);
+      if (code >= 0) Queue(EV_KEY, code, value > 0.5 ? 1 : 0);
+      return;
+    }
+  }
+}
+
+void VirtualGamepad::SetAxis(int index, double value) {
+  int code = ButtonMapping::W3CAxisToEvdev(index);
+  if (code < 0) return;
+  double scaled = (value + 1.0) * 0.5 * (kStickMax - kStickMin) + kStickMin;
+  Queue(EV_ABS, code, static_cast<int32_t>(std::lround(scaled)));
+}
+
+void VirtualGamepad::Sync() {
+  if (pending_count_ == 0) return;
+  Queue(EV_SYN, SYN_REPORT, 0);
+  ssize_t len = static_cast<ssize_t>(pending_count_ * sizeof(input_event));
+  if (write(fd_, pending_, len) != len) {
+    g_warning("evdev: short write to uinput device");
+  }
+  pending_count_ = 0;
+}
+
+void VirtualGamepad::Queue(uint16_t type, uint16_t code, int32_t value) {
+  if (pending_count_ == kMaxPending) {
+    // Never expected for a single report, but keep the buffer bounded:
+    // flush what we have without a SYN so the kernel still sees every
+    // change, and let the caller's Sync() terminate the report.
+    ssize_t len = static_cast<ssize_t>(pending_count_ * sizeof(input_event));
+    if (write(fd_, pending_, len) != len) {
+      g_warning("evdev: short write to uinput device");
+    }
+    pending_count_ = 0;
+  }
+  struct input_event& ev = pending_[pending_count_++];
+  memset(&ev, 0, sizeof(ev));
+  ev.type = type;
+  ev.code = code;
+  ev.value = value;
+}
@@ -0,0 +1,69 @@
+#ifndef VIRTUAL_GAMEPAD_H_
+#define VIRTUAL_GAMEPAD_H_
+
+#include <linux/input.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+struct libevdev_uinput;
+
+/// A uinput virtual gamepad that re-emits processed W3C gamepad state.
+///
+/// The device looks like a standard XInput-style pad: face/shoulder/menu
+/// buttons as keys, sticks as ABS_X/ABS_Y/ABS_RX/ABS_RY, analog triggers as
+/// ABS_Z/ABS_RZ and the d-pad as ABS_HAT0X/ABS_HAT0Y.  Changes are buffered
+/// and written to the uinput fd with a single write() per Sync(), so a whole
+/// evdev report is forwarded in one syscall from the thread that read it.
+///
+/// Not thread-safe; owned and driven by the evdev worker thread.
+class VirtualGamepad {
+ public:
+  /// Physical path reported by every virtual pad.  EvdevManager uses it to
+  /// recognise (and skip) its own devices when they show up in /dev/input.
+  static constexpr const char* kPhys = "universal_gamepad/virtual";
+
+  /// Physical path of the benchmark injector.  Unlike kPhys it is picked up
+  /// by EvdevManager, so injected input takes the same path as a real pad.
+  static constexpr const char* kInjectorPhys = "universal_gamepad/injector";
+
+  /// Creates the uinput device.  Returns nullptr if /dev/uinput is missing
+  /// or not writable.
+  static std::unique_ptr<VirtualGamepad> Create(const std::string& name,
+                                                uint16_t vendor_id,
+                                                uint16_t product_id,
+                                                const char* phys = kPhys);
+
+  ~VirtualGamepad();
+
+  VirtualGamepad(const VirtualGamepad&) = delete;
+  VirtualGamepad& operator=(const VirtualGamepad&) = delete;
+
+  /// Sets a W3C button (0.0 - 1.0).  Triggers are forwarded as analog axes,
+  /// d-pad buttons as hat axes.
+  void SetButton(int index, double value);
+
+  /// Sets a W3C stick axis (-1.0 - 1.0).
+  void SetAxis(int index, double value);
+
+  /// Flushes buffered changes followed by SYN_REPORT.  No-op if nothing
+  /// changed since the last call.
+  void Sync();
+
+ private:
+  static constexpr int kMaxPending = 32;
+
+  explicit VirtualGamepad(struct libevdev_uinput* uinput);
+
+  void Queue(uint16_t type, uint16_t code, int32_t value);
+
+  struct libevdev_uinput* uinput_;
+  int fd_;
+  struct input_event pending_[kMaxPending];
+  int pending_count_ = 0;
+  // Held d-pad directions; the hats are derived from opposing pairs.
+  bool dpad_[4] = {false, false, false, false};
+};
+
+#endif  // VIRTUAL_GAMEPAD_H_
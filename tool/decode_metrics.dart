@@ -0,0 +1,249 @@
+// Decodes a Linux metrics ring file (see linux/metrics_ring.h).
+//
+// Prints one line per snapshot, oldest first, with the counters turned into
+// rates over the interval since the previous snapshot of the same session.
+// Run with:
+//
+//   dart run tool/decode_metrics.dart gamepad.metrics [--json]
+//
+// --json prints every record in full, one JSON object per line.
+
+// ignore_for_file: avoid_print
+
+import 'dart:convert';
+import 'dart:io';
+import 'dart:typed_data';
+
+const _magic = 'UGM1';
+const _version = 1;
+const _recordBytes = 672;
+const _deviceBytes = 96;
+
+class _Header {
+  _Header(ByteData data)
+      : headerBytes = data.getUint32(8, Endian.little),
+        recordBytes = data.getUint32(12, Endian.little),
+        slotCount = data.getUint32(16, Endian.little),
+        bucketCount = data.getUint32(20, Endian.little),
+        maxDevices = data.getUint32(24, Endian.little),
+        nextSequence = data.getUint64(32, Endian.little),
+        createdUs = data.getInt64(40, Endian.little),
+        latencyLimitsUs = [
+          for (var i = 0; i < 7; i++) data.getInt32(48 + i * 4, Endian.little),
+        ],
+        jitterLimitsUs = [
+          for (var i = 0; i < 7; i++) data.getInt32(76 + i * 4, Endian.little),
+        ];
+
+  final int headerBytes;
+  final int recordBytes;
+  final int slotCount;
+  final int bucketCount;
+  final int maxDevices;
+  final int nextSequence;
+  final int createdUs;
+  final List<int> latencyLimitsUs;
+  final List<int> jitterLimitsUs;
+}
+
+class _Device {
+  _Device(ByteData data, int offset, int bucketCount)
+      : id = data.getInt32(offset, Endian.little),
+        reportRateHz = data.getFloat32(offset + 4, Endian.little),
+        jitterUs = data.getFloat32(offset + 8, Endian.little),
+        intervals = data.getUint64(offset + 16, Endian.little),
+        gaps = data.getUint64(offset + 24, Endian.little),
+        jitterBuckets = _buckets(data, offset + 32, bucketCount);
+
+  final int id;
+  final double reportRateHz;
+  final double jitterUs;
+  final int intervals;
+  final int gaps;
+  final List<int> jitterBuckets;
+
+  Map<String, Object> toJson() => {
+        'id': id,
+        'reportRateHz': reportRateHz,
+        'jitterUs': jitterUs,
+        'intervals': intervals,
+        'gaps': gaps,
+        'jitterBuckets': jitterBuckets,
+      };
+}
+
+class _Record {
+  _Record(ByteData data, int offset, _Header header)
+      : sequence = data.getUint64(offset, Endian.little),
+        wallTimeUs = data.getInt64(offset + 8, Endian.little),
+        monotonicUs = data.getInt64(offset + 16, Endian.little),
+        sessionStartUs = data.getInt64(offset + 24, Endian.little),
+        drainTicks = data.getUint64(offset + 32, Endian.little),
+        eventsDelivered = data.getUint64(offset + 40, Endian.little),
+        eventsCoalesced = data.getUint64(offset + 48, Endian.little),
+        rawBatches = data.getUint64(offset + 56, Endian.little),
+        overloadedTicks = data.getUint64(offset + 64, Endian.little),
+        configVersion = data.getUint64(offset + 72, Endian.little),
+        drainIntervalMs = data.getUint32(offset + 80, Endian.little),
+        deviceCount = data.getUint32(offset + 84, Endian.little),
+        loadFactor = data.getFloat32(offset + 88, Endian.little),
+        eventCostUs = data.getFloat32(offset + 92, Endian.little),
+        queueLatency = _buckets(data, offset + 96, header.bucketCount),
+        drainLateness = _buckets(data, offset + 160, header.bucketCount),
+        drainCost = _buckets(data, offset + 224, header.bucketCount),
+        devices = [
+          for (var i = 0; i < header.maxDevices; i++)
+            _Device(data, offset + 288 + i * _deviceBytes, header.bucketCount),
+        ].where((d) => d.id >= 0).toList();
+
+  final int sequence;
+  final int wallTimeUs;
+  final int monotonicUs;
+  final int sessionStartUs;
+  final int drainTicks;
+  final int eventsDelivered;
+  final int eventsCoalesced;
+  final int rawBatches;
+  final int overloadedTicks;
+  final int configVersion;
+  final int drainIntervalMs;
+  final int deviceCount;
+  final double loadFactor;
+  final double eventCostUs;
+  final List<int> queueLatency;
+  final List<int> drainLateness;
+  final List<int> drainCost;
+  final List<_Device> devices;
+
+  Map<String, Object> toJson() => {
+        'sequence': sequence,
+        'wallTime': _time(wallTimeUs),
+        'monotonicUs': monotonicUs,
+        'sessionStart': _time(sessionStartUs),
+        'drainTicks': drainTicks,
+        'eventsDelivered': eventsDelivered,
+        'eventsCoalesced': eventsCoalesced,
+        'rawBatches': rawBatches,
+        'overloadedTicks': overloadedTicks,
+        'configVersion': configVersion,
+        'drainIntervalMs': drainIntervalMs,
+        'deviceCount': deviceCount,
+        'loadFactor': loadFactor,
+        'eventCostUs': eventCostUs,
+        'queueLatency': queueLatency,
+        'drainLateness': drainLateness,
+        'drainCost': drainCost,
+        'devices': [for (final d in devices) d.toJson()],
+      };
+}
+
+List<int> _buckets(ByteData data, int offset, int count) => [
+      for (var i = 0; i < count; i++)
+        data.getUint64(offset + i * 8, Endian.little),
+    ];
+
+String _time(int us) =>
+    DateTime.fromMicrosecondsSinceEpoch(us, isUtc: true).toIso8601String();
+
+/// Upper bound of the bucket holding the |quantile| of the samples counted
+/// between two cumulative histograms, or '>last' for the overflow bucket.
+String _quantile(
+    List<int> now, List<int>? before, List<int> limits, double quantile) {
+  final counts = [
+    for (var i = 0; i < now.length; i++) now[i] - (before?[i] ?? 0),
+  ];
+  final total = counts.fold<int>(0, (a, b) => a + b);
+  if (total == 0) return '-';
+  var seen = 0;
+  for (var i = 0; i < counts.length; i++) {
+    seen += counts[i];
+    if (seen >= total * quantile) {
+      return i < limits.length ? '<=${limits[i]}' : '>${limits.last}';
+    }
+  }
+  return '>${limits.last}';
+}
+
+void main(List<String> arguments) {
+  final args = [...arguments];
+  final asJson = args.remove('--json');
+  if (args.length != 1) {
+    stderr.writeln('usage: decode_metrics.dart <file> [--json]');
+    exitCode = 64;
+    return;
+  }
+
+  final bytes = File(args.single).readAsBytesSync();
+  final data = ByteData.sublistView(bytes);
+  if (bytes.length < 128 ||
+      ascii.decode(bytes.sublist(0, 4), allowInvalid: true) != _magic ||
+      data.getUint32(4, Endian.little) != _version) {
+    stderr.writeln('${args.single}: not a version $_version metrics ring');
+    exitCode = 65;
+    return;
+  }
+  final header = _Header(data);
+  if (header.recordBytes != _recordBytes ||
+      bytes.length < header.headerBytes + header.slotCount * _recordBytes) {
+    stderr.writeln('${args.single}: unexpected layout');
+    exitCode = 65;
+    return;
+  }
+
+  // Unwritten and torn slots read as sequence 0.
+  final records = [
+    for (var i = 0; i < header.slotCount; i++)
+      _Record(data, header.headerBytes + i * _recordBytes, header),
+  ].where((r) => r.sequence != 0).toList()
+    ..sort((a, b) => a.sequence.compareTo(b.sequence));
+
+  if (asJson) {
+    for (final record in records) {
+      print(jsonEncode(record.toJson()));
+    }
+    return;
+  }
+
+  print('# ${args.single}: ${records.length} of ${header.slotCount} slots, '
+      'created ${_time(header.createdUs)}, next ${header.nextSequence}');
+  print('# latency columns are bucket upper bounds in us (p50/p99)');
+  _Record? previous;
+  for (final record in records) {
+    final before = previous?.sessionStartUs == record.sessionStartUs
+        ? previous
+        : null;
+    if (before == null) {
+      print('# session ${_time(record.sessionStartUs)}');
+    }
+    final seconds = before == null
+        ? (record.wallTimeUs - record.sessionStartUs) / 1e6
+        : (record.wallTimeUs - before.wallTimeUs) / 1e6;
+    String perSecond(int now, int? then) => seconds <= 0
+        ? '-'
+        : ((now - (then ?? 0)) / seconds).toStringAsFixed(1);
+    String latency(List<int> now, List<int>? then) =>
+        '${_quantile(now, then, header.latencyLimitsUs, 0.5)}/'
+        '${_quantile(now, then, header.latencyLimitsUs, 0.99)}';
+
+    final pads = [
+      for (final d in record.devices)
+        '${d.id}:${d.reportRateHz.toStringAsFixed(0)}Hz'
+            '±${d.jitterUs.toStringAsFixed(0)}us',
+    ].join(' ');
+    print([
+      '#${record.sequence}',
+      _time(record.wallTimeUs),
+      'events/s ${perSecond(record.eventsDelivered, before?.eventsDelivered)}',
+      'coalesced/s '
+          '${perSecond(record.eventsCoalesced, before?.eventsCoalesced)}',
+      'ticks/s ${perSecond(record.drainTicks, before?.drainTicks)}',
+      'overloaded ${record.overloadedTicks - (before?.overloadedTicks ?? 0)}',
+      'interval ${record.drainIntervalMs}ms',
+      'queue ${latency(record.queueLatency, before?.queueLatency)}',
+      'late ${latency(record.drainLateness, before?.drainLateness)}',
+      'cost ${latency(record.drainCost, before?.drainCost)}',
+      'pads ${record.deviceCount} $pads',
+    ].join('  '));
+    previous = record;
+  }
+}
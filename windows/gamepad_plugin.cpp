@@ -9,6 +9,8 @@
 #include <flutter/plugin_registrar_windows.h>
 #include <flutter/standard_method_codec.h>
 
+#include "trace_points.h"
+
 #include <memory>
 #include <string>
 #include <atomic>
@@ -16,12 +18,20 @@
 
 namespace gamepad {
 
+namespace {
+
+constexpr char kEventChannelName[] = "dev.universal_gamepad/events";
+
+}  // namespace
+
 // static
 void GamepadPlugin::RegisterWithRegistrar(
     flutter::PluginRegistrarWindows* registrar) {
   // Create the stream handler (shared between plugin and SDL manager).
   auto stream_handler = std::make_shared<GamepadStreamHandler>();
 
+  TracePoints::NameThread("platform");
+
   // Create the SDL manager.
   auto sdl_manager = std::make_unique<SdlManager>(stream_handler);
 
@@ -34,8 +44,10 @@ void GamepadPlugin::RegisterWithRegistrar(
   // Set up the EventChannel.
   auto event_channel =
       std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
-          registrar->messenger(), "dev.universal_gamepad/events",
+          registrar->messenger(), kEventChannelName,
           &flutter::StandardMethodCodec::GetInstance());
+  // Button and axis events bypass the event sink; see GamepadStreamHandler.
+  stream_handler->SetMessenger(registrar->messenger(), kEventChannelName);
 
   auto window_handle = std::make_shared<std::atomic<HWND>>(nullptr);
   const int window_proc_delegate_id =
@@ -121,6 +133,35 @@ void GamepadPlugin::HandleMethodCall(
   } else if (method == "resume") {
     sdl_manager_->Resume();
     result->Success();
+  } else if (method == "setTracing") {
+    const auto* args =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    bool enabled = false;
+    if (args) {
+      auto it = args->find(flutter::EncodableValue("enabled"));
+      if (it != args->end()) {
+        if (const auto* value = std::get_if<bool>(&it->second)) {
+          enabled = *value;
+        }
+      }
+    }
+    TracePoints::SetEnabled(enabled);
+    result->Success();
+  } else if (method == "exportTrace") {
+    const auto* args =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const std::string* path = nullptr;
+    if (args) {
+      auto it = args->find(flutter::EncodableValue("path"));
+      if (it != args->end()) {
+        path = std::get_if<std::string>(&it->second);
+      }
+    }
+    if (path && TracePoints::ExportChromeTrace(*path)) {
+      result->Success();
+    } else {
+      result->Error("trace_error", "Cannot write trace file");
+    }
   } else {
     result->NotImplemented();
   }
@@ -1,15 +1,83 @@
 #include "gamepad_stream_handler.h"
 
+#include "trace_points.h"
+
+#include <cstring>
+
 namespace gamepad {
 
+namespace {
+
+// Standard message codec type tags and the method codec's success
+// envelope, as written by flutter::StandardCodecSerializer.
+constexpr uint8_t kEnvelopeSuccess = 0;
+constexpr uint8_t kValueTrue = 1;
+constexpr uint8_t kValueFalse = 2;
+constexpr uint8_t kValueInt32 = 3;
+constexpr uint8_t kValueInt64 = 4;
+constexpr uint8_t kValueFloat64 = 6;
+constexpr uint8_t kValueList = 12;
+// Room for the largest message (40 bytes).
+constexpr size_t kMaxWireBytes = 48;
+
+template <typename T>
+void AppendRaw(std::vector<uint8_t>& buffer, T value) {
+  uint8_t bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+void AppendInt32(std::vector<uint8_t>& buffer, int32_t value) {
+  buffer.push_back(kValueInt32);
+  AppendRaw(buffer, value);
+}
+
+void AppendInt64(std::vector<uint8_t>& buffer, int64_t value) {
+  buffer.push_back(kValueInt64);
+  AppendRaw(buffer, value);
+}
+
+void AppendDouble(std::vector<uint8_t>& buffer, double value) {
+  buffer.push_back(kValueFloat64);
+  // Float64 payloads are aligned to 8 bytes from the message start.
+  while (buffer.size() % 8 != 0) buffer.push_back(0);
+  AppendRaw(buffer, value);
+}
+
+}  // namespace
+
 // ---------------------------------------------------------------------------
 // GamepadStreamHandler
 // ---------------------------------------------------------------------------
 
-GamepadStreamHandler::GamepadStreamHandler() = default;
+GamepadStreamHandler::GamepadStreamHandler() {
+  pending_events_.reserve(kInitialQueueCapacity);
+  flushing_events_.reserve(kInitialQueueCapacity);
+  wire_buffer_.reserve(kMaxWireBytes);
+}
+
 GamepadStreamHandler::~GamepadStreamHandler() = default;
 
 void GamepadStreamHandler::SendEvent(const flutter::EncodableValue& event) {
+  Enqueue({0, 0, 0, 0, false, 0.0, event});
+}
+
+void GamepadStreamHandler::SendButtonEvent(int32_t gamepad_id,
+                                           int64_t timestamp, int32_t index,
+                                           bool pressed, double value) {
+  Enqueue({1, gamepad_id, timestamp, index, pressed, value,
+           flutter::EncodableValue()});
+}
+
+void GamepadStreamHandler::SendAxisEvent(int32_t gamepad_id,
+                                         int64_t timestamp, int32_t index,
+                                         double value) {
+  Enqueue({2, gamepad_id, timestamp, index, false, value,
+           flutter::EncodableValue()});
+}
+
+void GamepadStreamHandler::Enqueue(QueuedEvent&& event) {
+  GAMEPAD_TRACE_SCOPE("SendEvent");
   std::function<void()> wake_callback;
   bool should_post = false;
   {
@@ -17,9 +85,11 @@ void GamepadStreamHandler::SendEvent(const flutter::EncodableValue& event) {
     if (!event_sink_) {
       return;
     }
-    pending_events_.push_back(event);
+    pending_events_.push_back(std::move(event));
     should_post = !flush_posted_.exchange(true);
-    wake_callback = wake_callback_;
+    if (should_post) {
+      wake_callback = wake_callback_;
+    }
   }
   if (should_post && wake_callback) {
     wake_callback();
@@ -27,19 +97,29 @@ void GamepadStreamHandler::SendEvent(const flutter::EncodableValue& event) {
 }
 
 void GamepadStreamHandler::FlushQueuedEvents() {
-  std::deque<flutter::EncodableValue> local_events;
+  GAMEPAD_TRACE_SCOPE("FlushQueuedEvents");
   {
+    // flushing_events_ is always empty here; swapping keeps both buffers'
+    // capacity, so steady-state flushing never reallocates the queue.
     std::lock_guard<std::mutex> lock(sink_mutex_);
-    local_events.swap(pending_events_);
+    flushing_events_.swap(pending_events_);
     flush_posted_.store(false);
     if (!event_sink_) {
+      flushing_events_.clear();
       return;
     }
   }
 
-  for (const auto& event : local_events) {
-    event_sink_->Success(event);
+  for (const auto& event : flushing_events_) {
+    if (event.type == 0) {
+      event_sink_->Success(event.event);
+      continue;
+    }
+    // The engine copies the message before Send() returns.
+    EncodeEvent(event);
+    messenger_->Send(channel_name_, wire_buffer_.data(), wire_buffer_.size());
   }
+  flushing_events_.clear();
 
   std::function<void()> wake_callback;
   bool should_post = false;
@@ -55,6 +135,30 @@ void GamepadStreamHandler::FlushQueuedEvents() {
   }
 }
 
+void GamepadStreamHandler::EncodeEvent(const QueuedEvent& event) {
+  // clear() keeps the capacity reserved in the constructor.
+  wire_buffer_.clear();
+  wire_buffer_.push_back(kEnvelopeSuccess);
+  wire_buffer_.push_back(kValueList);
+  wire_buffer_.push_back(static_cast<uint8_t>(event.type == 1 ? 6 : 5));
+  AppendInt32(wire_buffer_, event.type);
+  AppendInt32(wire_buffer_, event.gamepad_id);
+  AppendInt64(wire_buffer_, event.timestamp);
+  AppendInt32(wire_buffer_, event.index);
+  if (event.type == 1) {
+    // Wire format: [1, gamepadId, timestamp, buttonIndex, pressed, value]
+    wire_buffer_.push_back(event.pressed ? kValueTrue : kValueFalse);
+  }
+  // Wire format: [2, gamepadId, timestamp, axisIndex, value]
+  AppendDouble(wire_buffer_, event.value);
+}
+
+void GamepadStreamHandler::SetMessenger(flutter::BinaryMessenger* messenger,
+                                        const std::string& channel_name) {
+  messenger_ = messenger;
+  channel_name_ = channel_name;
+}
+
 bool GamepadStreamHandler::HasListener() const {
   std::lock_guard<std::mutex> lock(sink_mutex_);
   return event_sink_ != nullptr;
@@ -1,14 +1,17 @@
 #ifndef FLUTTER_PLUGIN_GAMEPAD_STREAM_HANDLER_H_
 #define FLUTTER_PLUGIN_GAMEPAD_STREAM_HANDLER_H_
 
+#include <flutter/binary_messenger.h>
 #include <flutter/encodable_value.h>
 #include <flutter/event_channel.h>
 #include <flutter/event_stream_handler_functions.h>
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
-#include <deque>
+#include <string>
+#include <vector>
 #include <atomic>
 
 #include <windows.h>
@@ -20,6 +23,13 @@ namespace gamepad {
 /// Holds the EventSink provided by Flutter and exposes a thread-safe
 /// method to send events from any thread. Events are dispatched to the
 /// Flutter/UI thread by posting through the event sink.
+///
+/// Button and axis events are queued as plain records in two swapped
+/// vectors that keep their capacity, so the polling thread does not
+/// allocate per event.  When the queue is flushed on the platform thread,
+/// each one is encoded into a reused buffer as the message the event sink
+/// would send for its wire list, and handed to the messenger directly, so
+/// no EncodableList is built per event either.
 class GamepadStreamHandler
     : public flutter::StreamHandler<flutter::EncodableValue> {
  public:
@@ -32,9 +42,25 @@ class GamepadStreamHandler
   /// The event should be a flutter::EncodableMap.
   void SendEvent(const flutter::EncodableValue& event);
 
+  /// Sends a button event without building an EncodableValue on the
+  /// calling thread. Thread-safe.
+  void SendButtonEvent(int32_t gamepad_id, int64_t timestamp, int32_t index,
+                       bool pressed, double value);
+
+  /// Sends an axis event without building an EncodableValue on the calling
+  /// thread. Thread-safe.
+  void SendAxisEvent(int32_t gamepad_id, int64_t timestamp, int32_t index,
+                     double value);
+
   /// Flushes queued events on the platform thread.
   void FlushQueuedEvents();
 
+  /// Sets the messenger and name of the event channel, which button and
+  /// axis events are sent on. Must be called before Dart listens; the
+  /// messenger must outlive this handler.
+  void SetMessenger(flutter::BinaryMessenger* messenger,
+                    const std::string& channel_name);
+
   /// Callback used to wake platform thread to flush queued events.
   void SetWakeCallback(std::function<void()> callback);
 
@@ -54,9 +80,37 @@ class GamepadStreamHandler
  private:
   friend class ForwardingStreamHandler;
 
+  /// Initial capacity of each queue buffer.
+  static constexpr size_t kInitialQueueCapacity = 256;
+
+  /// A queued event. Button (1) and axis (2) events are plain data; any
+  /// other event passed to SendEvent() is kept prebuilt in |event|.
+  struct QueuedEvent {
+    int type;
+    int32_t gamepad_id;
+    int64_t timestamp;
+    int32_t index;
+    bool pressed;
+    double value;
+    flutter::EncodableValue event;
+  };
+
+  /// Appends |event| to the queue and wakes the platform thread if needed.
+  void Enqueue(QueuedEvent&& event);
+
+  /// Encodes a queued button or axis event into wire_buffer_, as the
+  /// standard method codec's success envelope of its wire list.
+  void EncodeEvent(const QueuedEvent& event);
+
   mutable std::mutex sink_mutex_;
   std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> event_sink_;
-  std::deque<flutter::EncodableValue> pending_events_;
+  std::vector<QueuedEvent> pending_events_;
+  /// Batch being flushed; platform thread only.
+  std::vector<QueuedEvent> flushing_events_;
+  /// Message being sent; platform thread only.
+  std::vector<uint8_t> wire_buffer_;
+  flutter::BinaryMessenger* messenger_ = nullptr;
+  std::string channel_name_;
   std::function<void()> wake_callback_;
   std::atomic<bool> flush_posted_{false};
 };
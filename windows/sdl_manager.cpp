@@ -1,9 +1,11 @@
 #include "sdl_manager.h"
 
 #include "gamepad_stream_handler.h"
+#include "trace_points.h"
 
 #include <chrono>
 #include <cmath>
+#include <cstdio>
 #include <limits>
 
 namespace gamepad {
@@ -42,41 +44,90 @@ void SdlManager::Resume() {
 
 void SdlManager::CloseAllGamepads() {
   std::lock_guard<std::mutex> lock(state_mutex_);
-  for (auto& [id, info] : gamepads_) {
-    flutter::EncodableList event;
-    event.push_back(flutter::EncodableValue(0));
-    event.push_back(flutter::EncodableValue(static_cast<int32_t>(id)));
-    event.push_back(flutter::EncodableValue(CurrentTimestamp()));
-    event.push_back(flutter::EncodableValue(false));
-    event.push_back(flutter::EncodableValue(info.name));
-    event.push_back(flutter::EncodableValue(static_cast<int32_t>(info.vendor_id)));
-    event.push_back(flutter::EncodableValue(static_cast<int32_t>(info.product_id)));
-    stream_handler_->SendEvent(flutter::EncodableValue(event));
+  for (auto& [joystick_id, info] : gamepads_) {
+    SendConnectionEvent(info, false);
     if (info.gamepad) SDL_CloseGamepad(info.gamepad);
   }
   gamepads_.clear();
 }
 
+void SdlManager::SendConnectionEvent(const GamepadInfo& info,
+                                     bool connected) {
+  // Wire format: [0, gamepadId, timestamp, connected, name, vendorId,
+  //               productId, reconnected]
+  flutter::EncodableList event;
+  event.push_back(flutter::EncodableValue(0));
+  event.push_back(flutter::EncodableValue(info.id));
+  event.push_back(flutter::EncodableValue(CurrentTimestamp()));
+  event.push_back(flutter::EncodableValue(connected));
+  event.push_back(flutter::EncodableValue(info.name));
+  event.push_back(flutter::EncodableValue(static_cast<int32_t>(info.vendor_id)));
+  event.push_back(flutter::EncodableValue(static_cast<int32_t>(info.product_id)));
+  event.push_back(flutter::EncodableValue(connected && info.reconnected));
+  stream_handler_->SendEvent(flutter::EncodableValue(event));
+}
+
+std::string SdlManager::IdentityKey(SDL_Gamepad* gamepad) {
+  const char* serial = SDL_GetGamepadSerial(gamepad);
+  std::string id;
+  if (serial && *serial) {
+    id = std::string("serial:") + serial;
+  } else {
+    // The device path names the port, so a wired pad without a serial
+    // keeps its id as long as it is plugged back into the same one.
+    const char* path = SDL_GetGamepadPath(gamepad);
+    if (!path || !*path) return "";
+    id = std::string("path:") + path;
+  }
+  char prefix[16];
+  snprintf(prefix, sizeof(prefix), "%04x:%04x:", SDL_GetGamepadVendor(gamepad),
+           SDL_GetGamepadProduct(gamepad));
+  return prefix + id;
+}
+
+int32_t SdlManager::ClaimId(const std::string& key, bool* reconnected) {
+  *reconnected = false;
+  if (key.empty()) return next_id_++;
+  auto it = identities_.find(key);
+  if (it == identities_.end()) {
+    identities_[key] = next_id_;
+    return next_id_++;
+  }
+  // A second pad with the same key gets an id of its own.
+  for (const auto& [joystick_id, info] : gamepads_) {
+    if (info.id == it->second) return next_id_++;
+  }
+  *reconnected = true;
+  return it->second;
+}
+
 flutter::EncodableList SdlManager::ListGamepads() {
   std::lock_guard<std::mutex> lock(state_mutex_);
   flutter::EncodableList result;
 
-  for (const auto& [id, info] : gamepads_) {
+  for (const auto& [joystick_id, info] : gamepads_) {
     flutter::EncodableMap map;
-    map[flutter::EncodableValue("id")] =
-        flutter::EncodableValue(static_cast<int32_t>(id));
+    map[flutter::EncodableValue("id")] = flutter::EncodableValue(info.id);
     map[flutter::EncodableValue("name")] =
         flutter::EncodableValue(info.name);
     map[flutter::EncodableValue("vendorId")] =
         flutter::EncodableValue(static_cast<int32_t>(info.vendor_id));
     map[flutter::EncodableValue("productId")] =
         flutter::EncodableValue(static_cast<int32_t>(info.product_id));
+    map[flutter::EncodableValue("capabilities")] =
+        flutter::EncodableValue(info.capabilities);
+    if (info.power_state != SDL_POWERSTATE_NO_BATTERY) {
+      map[flutter::EncodableValue("battery")] = flutter::EncodableValue(
+          BatteryMap(info.power_state, info.battery_percent));
+    }
     result.push_back(flutter::EncodableValue(map));
   }
   return result;
 }
 
 void SdlManager::PollLoop() {
+  TracePoints::NameThread("sdl-poll");
+
   if (!SDL_Init(SDL_INIT_GAMEPAD)) {
     // SDL_Init failed; cannot poll gamepads.
     running_.store(false);
@@ -111,6 +162,7 @@ void SdlManager::PollLoop() {
 }
 
 void SdlManager::PollEvents() {
+  GAMEPAD_TRACE_SCOPE("PollEvents");
   SDL_Event event;
   while (SDL_PollEvent(&event)) {
     switch (event.type) {
@@ -130,6 +182,10 @@ void SdlManager::PollEvents() {
         HandleAxisEvent(event.gaxis.which, event.gaxis.axis,
                         event.gaxis.value);
         break;
+      case SDL_EVENT_JOYSTICK_BATTERY_UPDATED:
+        HandleBatteryEvent(event.jbattery.which, event.jbattery.state,
+                           event.jbattery.percent);
+        break;
       default:
         break;
     }
@@ -156,25 +212,134 @@ void SdlManager::HandleGamepadAdded(SDL_JoystickID joystick_id) {
     info.last_axis[i] = std::numeric_limits<double>::quiet_NaN();
   for (int i = 0; i < 2; i++)
     info.last_trigger[i] = std::numeric_limits<double>::quiet_NaN();
+  info.capabilities = BuildCapabilities(gamepad);
+  info.power_state = SDL_GetGamepadPowerInfo(gamepad, &info.battery_percent);
+  std::string key = IdentityKey(gamepad);
 
   {
     std::lock_guard<std::mutex> lock(state_mutex_);
+    info.id = ClaimId(key, &info.reconnected);
     gamepads_[joystick_id] = info;
   }
 
-  // Wire format: [0, gamepadId, timestamp, connected, name, vendorId, productId]
+  SendConnectionEvent(info, true);
+}
+
+void SdlManager::HandleBatteryEvent(SDL_JoystickID joystick_id,
+                                    SDL_PowerState state, int percent) {
+  int32_t gamepad_id;
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    auto it = gamepads_.find(joystick_id);
+    if (it == gamepads_.end()) return;
+    GamepadInfo& info = it->second;
+    if (info.power_state == state && info.battery_percent == percent) return;
+    info.power_state = state;
+    info.battery_percent = percent;
+    gamepad_id = info.id;
+  }
+
+  flutter::EncodableMap battery = BatteryMap(state, percent);
+  // Wire format: [4, gamepadId, timestamp, level, status]
   flutter::EncodableList event;
-  event.push_back(flutter::EncodableValue(0));
-  event.push_back(flutter::EncodableValue(static_cast<int32_t>(joystick_id)));
+  event.push_back(flutter::EncodableValue(4));
+  event.push_back(flutter::EncodableValue(gamepad_id));
   event.push_back(flutter::EncodableValue(CurrentTimestamp()));
-  event.push_back(flutter::EncodableValue(true));
-  event.push_back(flutter::EncodableValue(info.name));
-  event.push_back(flutter::EncodableValue(static_cast<int32_t>(info.vendor_id)));
-  event.push_back(flutter::EncodableValue(static_cast<int32_t>(info.product_id)));
-
+  event.push_back(battery[flutter::EncodableValue("level")]);
+  event.push_back(battery[flutter::EncodableValue("status")]);
   stream_handler_->SendEvent(flutter::EncodableValue(event));
 }
 
+flutter::EncodableMap SdlManager::BatteryMap(SDL_PowerState state,
+                                             int percent) {
+  const char* status = "unknown";
+  switch (state) {
+    case SDL_POWERSTATE_ON_BATTERY:
+      status = "discharging";
+      break;
+    case SDL_POWERSTATE_CHARGING:
+      status = "charging";
+      break;
+    case SDL_POWERSTATE_CHARGED:
+      status = "full";
+      break;
+    default:
+      break;
+  }
+  flutter::EncodableMap map;
+  map[flutter::EncodableValue("level")] =
+      percent >= 0 ? flutter::EncodableValue(percent)
+                   : flutter::EncodableValue();
+  map[flutter::EncodableValue("status")] = flutter::EncodableValue(status);
+  return map;
+}
+
+flutter::EncodableMap SdlManager::BuildCapabilities(SDL_Gamepad* gamepad) {
+  int32_t buttons = 0;
+  for (int b = 0; b < SDL_GAMEPAD_BUTTON_COUNT; b++) {
+    auto button = static_cast<SDL_GamepadButton>(b);
+    int index = SdlButtonToW3C(button);
+    if (index >= 0 && SDL_GamepadHasButton(gamepad, button)) {
+      buttons |= 1 << index;
+    }
+  }
+  int32_t axes = 0;
+  bool triggers = false;
+  for (int a = 0; a < SDL_GAMEPAD_AXIS_COUNT; a++) {
+    auto axis = static_cast<SDL_GamepadAxis>(a);
+    if (!SDL_GamepadHasAxis(gamepad, axis)) continue;
+    if (IsTriggerAxis(axis)) {
+      buttons |= 1 << TriggerAxisToButtonIndex(axis);
+      triggers = true;
+    } else if (SdlAxisToW3C(axis) >= 0) {
+      axes |= 1 << SdlAxisToW3C(axis);
+    }
+  }
+
+  // SDL presents digital triggers as full-range axes too, so it cannot
+  // tell the two apart.
+  SDL_PropertiesID props = SDL_GetGamepadProperties(gamepad);
+  bool rumble =
+      SDL_GetBooleanProperty(props, SDL_PROP_GAMEPAD_CAP_RUMBLE_BOOLEAN, false);
+  bool leds =
+      SDL_GetBooleanProperty(props, SDL_PROP_GAMEPAD_CAP_RGB_LED_BOOLEAN,
+                             false) ||
+      SDL_GetBooleanProperty(props, SDL_PROP_GAMEPAD_CAP_MONO_LED_BOOLEAN,
+                             false);
+
+  const char* bus = "unknown";
+  switch (SDL_GetGamepadConnectionState(gamepad)) {
+    case SDL_JOYSTICK_CONNECTION_WIRED:
+      bus = "wired";
+      break;
+    case SDL_JOYSTICK_CONNECTION_WIRELESS:
+      bus = "wireless";
+      break;
+    default:
+      break;
+  }
+  const char* serial = SDL_GetGamepadSerial(gamepad);
+
+  flutter::EncodableMap caps;
+  caps[flutter::EncodableValue("buttons")] = flutter::EncodableValue(buttons);
+  caps[flutter::EncodableValue("axes")] = flutter::EncodableValue(axes);
+  caps[flutter::EncodableValue("triggers")] =
+      flutter::EncodableValue(triggers ? "analog" : "none");
+  caps[flutter::EncodableValue("accelerometer")] =
+      flutter::EncodableValue(SDL_GamepadHasSensor(gamepad, SDL_SENSOR_ACCEL));
+  caps[flutter::EncodableValue("gyroscope")] =
+      flutter::EncodableValue(SDL_GamepadHasSensor(gamepad, SDL_SENSOR_GYRO));
+  caps[flutter::EncodableValue("touchpad")] =
+      flutter::EncodableValue(SDL_GetNumGamepadTouchpads(gamepad) > 0);
+  caps[flutter::EncodableValue("rumble")] = flutter::EncodableValue(rumble);
+  caps[flutter::EncodableValue("leds")] = flutter::EncodableValue(leds);
+  caps[flutter::EncodableValue("bus")] = flutter::EncodableValue(bus);
+  caps[flutter::EncodableValue("uniq")] =
+      serial && *serial ? flutter::EncodableValue(std::string(serial))
+                        : flutter::EncodableValue();
+  return caps;
+}
+
 void SdlManager::HandleGamepadRemoved(SDL_JoystickID joystick_id) {
   GamepadInfo info;
   {
@@ -190,26 +355,19 @@ void SdlManager::HandleGamepadRemoved(SDL_JoystickID joystick_id) {
     gamepads_.erase(it);
   }
 
-  // Wire format: [0, gamepadId, timestamp, connected, name, vendorId, productId]
-  flutter::EncodableList event;
-  event.push_back(flutter::EncodableValue(0));
-  event.push_back(flutter::EncodableValue(static_cast<int32_t>(joystick_id)));
-  event.push_back(flutter::EncodableValue(CurrentTimestamp()));
-  event.push_back(flutter::EncodableValue(false));
-  event.push_back(flutter::EncodableValue(info.name));
-  event.push_back(flutter::EncodableValue(static_cast<int32_t>(info.vendor_id)));
-  event.push_back(flutter::EncodableValue(static_cast<int32_t>(info.product_id)));
-
-  stream_handler_->SendEvent(flutter::EncodableValue(event));
+  SendConnectionEvent(info, false);
 }
 
 void SdlManager::HandleButtonEvent(SDL_JoystickID joystick_id, uint8_t button,
                                    bool pressed) {
+  int32_t gamepad_id;
   {
     std::lock_guard<std::mutex> lock(state_mutex_);
-    if (gamepads_.find(joystick_id) == gamepads_.end()) {
+    auto it = gamepads_.find(joystick_id);
+    if (it == gamepads_.end()) {
       return;
     }
+    gamepad_id = it->second.id;
   }
 
   int w3c_index = SdlButtonToW3C(static_cast<SDL_GamepadButton>(button));
@@ -217,16 +375,9 @@ void SdlManager::HandleButtonEvent(SDL_JoystickID joystick_id, uint8_t button,
     return;
   }
 
-  // Wire format: [1, gamepadId, timestamp, buttonIndex, pressed, value]
-  flutter::EncodableList event;
-  event.push_back(flutter::EncodableValue(1));
-  event.push_back(flutter::EncodableValue(static_cast<int32_t>(joystick_id)));
-  event.push_back(flutter::EncodableValue(CurrentTimestamp()));
-  event.push_back(flutter::EncodableValue(static_cast<int32_t>(w3c_index)));
-  event.push_back(flutter::EncodableValue(pressed));
-  event.push_back(flutter::EncodableValue(pressed ? 1.0 : 0.0));
-
-  stream_handler_->SendEvent(flutter::EncodableValue(event));
+  stream_handler_->SendButtonEvent(gamepad_id, CurrentTimestamp(),
+                                   static_cast<int32_t>(w3c_index), pressed,
+                                   pressed ? 1.0 : 0.0);
 }
 
 void SdlManager::HandleAxisEvent(SDL_JoystickID joystick_id, uint8_t axis,
@@ -260,16 +411,9 @@ void SdlManager::HandleAxisEvent(SDL_JoystickID joystick_id, uint8_t axis,
 
     bool pressed = normalized > 0.5;
 
-    // Wire format: [1, gamepadId, timestamp, buttonIndex, pressed, value]
-    flutter::EncodableList event;
-    event.push_back(flutter::EncodableValue(1));
-    event.push_back(flutter::EncodableValue(static_cast<int32_t>(joystick_id)));
-    event.push_back(flutter::EncodableValue(CurrentTimestamp()));
-    event.push_back(flutter::EncodableValue(static_cast<int32_t>(button_index)));
-    event.push_back(flutter::EncodableValue(pressed));
-    event.push_back(flutter::EncodableValue(normalized));
-
-    stream_handler_->SendEvent(flutter::EncodableValue(event));
+    stream_handler_->SendButtonEvent(info_ptr->id, CurrentTimestamp(),
+                                     static_cast<int32_t>(button_index),
+                                     pressed, normalized);
     return;
   }
 
@@ -287,15 +431,8 @@ void SdlManager::HandleAxisEvent(SDL_JoystickID joystick_id, uint8_t axis,
   }
   info_ptr->last_axis[w3c_index] = normalized;
 
-  // Wire format: [2, gamepadId, timestamp, axisIndex, value]
-  flutter::EncodableList event;
-  event.push_back(flutter::EncodableValue(2));
-  event.push_back(flutter::EncodableValue(static_cast<int32_t>(joystick_id)));
-  event.push_back(flutter::EncodableValue(CurrentTimestamp()));
-  event.push_back(flutter::EncodableValue(static_cast<int32_t>(w3c_index)));
-  event.push_back(flutter::EncodableValue(normalized));
-
-  stream_handler_->SendEvent(flutter::EncodableValue(event));
+  stream_handler_->SendAxisEvent(info_ptr->id, CurrentTimestamp(),
+                                 static_cast<int32_t>(w3c_index), normalized);
 }
 
 int64_t SdlManager::CurrentTimestamp() {
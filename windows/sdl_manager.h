@@ -49,13 +49,19 @@ class SdlManager {
   void Resume();
 
   /// Returns a list of currently connected gamepads as EncodableList.
-  /// Each element is an EncodableMap with keys: id, name, vendorId, productId.
+  /// Each element is an EncodableMap with keys: id, name, vendorId, productId,
+  /// capabilities, and battery ({level, status}) for pads that have one.
   flutter::EncodableList ListGamepads();
 
  private:
   /// Information cached for each connected gamepad.
   struct GamepadInfo {
     SDL_JoystickID joystick_id;
+    /// Id reported to Dart; unlike |joystick_id| it is kept across
+    /// reconnects of the same pad.
+    int32_t id;
+    /// Whether the pad came back under an id it had before.
+    bool reconnected;
     SDL_Gamepad* gamepad;
     std::string name;
     uint16_t vendor_id;
@@ -64,6 +70,11 @@ class SdlManager {
     double last_axis[4];
     /// Last emitted trigger values for throttling (0 = L2, 1 = R2).
     double last_trigger[2];
+    /// Capability descriptor, built once when the gamepad is opened.
+    flutter::EncodableMap capabilities;
+    /// Last reported battery state; percent is -1 when unknown.
+    SDL_PowerState power_state;
+    int battery_percent;
   };
 
   /// Main polling loop, runs on background thread.
@@ -86,6 +97,31 @@ class SdlManager {
   void HandleAxisEvent(SDL_JoystickID joystick_id, uint8_t axis,
                        int16_t value);
 
+  /// Handles a joystick battery update, emitting a battery event only if
+  /// the level or status changed.
+  void HandleBatteryEvent(SDL_JoystickID joystick_id, SDL_PowerState state,
+                          int percent);
+
+  /// Builds the {level, status} map of a battery.
+  static flutter::EncodableMap BatteryMap(SDL_PowerState state, int percent);
+
+  /// Builds the capabilities map of ListGamepads() for |gamepad|:
+  /// {buttons, axes (W3C index bitmaps), triggers: "none"|"analog",
+  ///  accelerometer, gyroscope, touchpad, rumble, leds,
+  ///  bus: "wired"|"wireless"|"unknown", uniq: serial or null}.
+  static flutter::EncodableMap BuildCapabilities(SDL_Gamepad* gamepad);
+
+  /// Returns the identity key of |gamepad|: vendor and product id plus its
+  /// serial or, failing that, its device path.  Empty if it has neither.
+  static std::string IdentityKey(SDL_Gamepad* gamepad);
+
+  /// Picks the id of a newly opened gamepad: the one |key| had before, or
+  /// a new one.  Caller holds state_mutex_.
+  int32_t ClaimId(const std::string& key, bool* reconnected);
+
+  /// Sends a connection event for |info|.
+  void SendConnectionEvent(const GamepadInfo& info, bool connected);
+
   /// Returns the current timestamp in milliseconds since epoch.
   static int64_t CurrentTimestamp();
 
@@ -103,6 +139,11 @@ class SdlManager {
   /// Map of joystick ID to connected gamepad info.
   std::unordered_map<SDL_JoystickID, GamepadInfo> gamepads_;
 
+  /// Ids by identity key, kept for the lifetime of the manager, and the
+  /// next id to hand out.  Protected by state_mutex_.
+  std::unordered_map<std::string, int32_t> identities_;
+  int32_t next_id_ = 0;
+
   /// Closes all open gamepad handles and emits disconnect events.
   void CloseAllGamepads();
 };
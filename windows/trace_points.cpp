@@ -0,0 +1,193 @@
+#include "trace_points.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace gamepad {
+namespace TracePoints {
+
+std::atomic<bool> g_enabled{false};
+
+namespace {
+
+constexpr size_t kEventsPerThread = size_t{1} << 14;
+
+struct Event {
+  std::atomic<const char*> name;
+  std::atomic<int64_t> begin_us;
+  std::atomic<int64_t> duration_us;
+};
+
+// Single-writer ring; the exporter reads it concurrently and drops entries
+// the owning thread may have overwritten while it was copying.
+struct ThreadBuffer {
+  std::atomic<int> tid{0};
+  std::atomic<const char*> thread_name{nullptr};
+  // Events before this index are ignored (set when tracing is re-enabled).
+  std::atomic<uint64_t> start{0};
+  std::atomic<uint64_t> head{0};
+  Event events[kEventsPerThread];
+};
+
+// Buffers are never freed so that a thread exiting can't invalidate a
+// concurrent export.  A thread takes one on its first event while tracing
+// is enabled and hands it back when it exits; the next thread to trace
+// reuses it, so there are only ever as many buffers as threads that traced
+// at the same time.
+std::mutex g_registry_mutex;
+std::vector<ThreadBuffer*> g_buffers;
+std::vector<ThreadBuffer*> g_free_buffers;
+int g_next_tid = 1;
+
+ThreadBuffer* AcquireBuffer(const char* thread_name) {
+  std::lock_guard<std::mutex> lock(g_registry_mutex);
+  ThreadBuffer* buffer;
+  if (g_free_buffers.empty()) {
+    buffer = new ThreadBuffer();
+    g_buffers.push_back(buffer);
+  } else {
+    buffer = g_free_buffers.back();
+    g_free_buffers.pop_back();
+    // The previous owner's events are exported no more.
+    buffer->start.store(buffer->head.load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+  }
+  buffer->tid.store(g_next_tid++, std::memory_order_relaxed);
+  buffer->thread_name.store(thread_name, std::memory_order_relaxed);
+  return buffer;
+}
+
+// The calling thread's name and buffer, if it has recorded anything.
+struct ThreadState {
+  const char* name = nullptr;
+  ThreadBuffer* buffer = nullptr;
+
+  ~ThreadState() {
+    if (!buffer) return;
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    g_free_buffers.push_back(buffer);
+  }
+};
+
+thread_local ThreadState t_state;
+
+}  // namespace
+
+void SetEnabled(bool enabled) {
+  if (enabled) {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    for (ThreadBuffer* buffer : g_buffers) {
+      buffer->start.store(buffer->head.load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+    }
+  }
+  g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void NameThread(const char* name) {
+  t_state.name = name;
+  if (t_state.buffer) {
+    t_state.buffer->thread_name.store(name, std::memory_order_relaxed);
+  }
+}
+
+int64_t NowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void Record(const char* name, int64_t begin_us, int64_t end_us) {
+  ThreadBuffer* buffer = t_state.buffer;
+  if (!buffer) buffer = t_state.buffer = AcquireBuffer(t_state.name);
+  uint64_t pos = buffer->head.load(std::memory_order_relaxed);
+  Event& event = buffer->events[pos & (kEventsPerThread - 1)];
+  event.name.store(name, std::memory_order_relaxed);
+  event.begin_us.store(begin_us, std::memory_order_relaxed);
+  event.duration_us.store(end_us - begin_us, std::memory_order_relaxed);
+  buffer->head.store(pos + 1, std::memory_order_release);
+}
+
+bool ExportChromeTrace(const std::string& path) {
+  std::vector<ThreadBuffer*> buffers;
+  {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    buffers = g_buffers;
+  }
+
+  FILE* file = nullptr;
+  if (fopen_s(&file, path.c_str(), "w") != 0 || !file) return false;
+  fprintf(file, "{\"traceEvents\":[\n");
+
+  bool first = true;
+  auto separator = [&]() {
+    if (!first) fprintf(file, ",\n");
+    first = false;
+  };
+
+  struct Copied {
+    const char* name;
+    int64_t begin_us;
+    int64_t duration_us;
+  };
+  std::vector<Copied> copied;
+
+  for (ThreadBuffer* buffer : buffers) {
+    int tid = buffer->tid.load(std::memory_order_relaxed);
+    const char* thread_name =
+        buffer->thread_name.load(std::memory_order_relaxed);
+    separator();
+    if (thread_name) {
+      fprintf(file,
+              "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+              "\"args\":{\"name\":\"%s\"}}",
+              tid, thread_name);
+    } else {
+      fprintf(file,
+              "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+              "\"args\":{\"name\":\"thread-%d\"}}",
+              tid, tid);
+    }
+
+    uint64_t end = buffer->head.load(std::memory_order_acquire);
+    uint64_t begin = end > kEventsPerThread ? end - kEventsPerThread : 0;
+    uint64_t start = buffer->start.load(std::memory_order_relaxed);
+    if (begin < start) begin = start;
+
+    copied.clear();
+    for (uint64_t i = begin; i < end; ++i) {
+      const Event& event = buffer->events[i & (kEventsPerThread - 1)];
+      copied.push_back({event.name.load(std::memory_order_relaxed),
+                        event.begin_us.load(std::memory_order_relaxed),
+                        event.duration_us.load(std::memory_order_relaxed)});
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t later = buffer->head.load(std::memory_order_relaxed);
+    uint64_t first_valid =
+        later + 1 > kEventsPerThread ? later + 1 - kEventsPerThread : 0;
+    size_t skip = first_valid > begin ? first_valid - begin : 0;
+
+    for (size_t i = skip; i < copied.size(); ++i) {
+      if (!copied[i].name) continue;
+      separator();
+      fprintf(file,
+              "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+              "\"ts\":%lld,\"dur\":%lld}",
+              copied[i].name, tid,
+              static_cast<long long>(copied[i].begin_us),
+              static_cast<long long>(copied[i].duration_us));
+    }
+  }
+
+  fprintf(file, "\n]}\n");
+  bool ok = ferror(file) == 0;
+  fclose(file);
+  return ok;
+}
+
+}  // namespace TracePoints
+}  // namespace gamepad
@@ -0,0 +1,69 @@
+#ifndef FLUTTER_PLUGIN_TRACE_POINTS_H_
+#define FLUTTER_PLUGIN_TRACE_POINTS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/// Compiled-in, runtime-toggleable trace points.
+///
+/// GAMEPAD_TRACE_SCOPE("Name") records how long the enclosing scope took
+/// into a fixed-size ring owned by the calling thread; no locks are taken
+/// after a thread's first event.  A thread gets its ring on its first event
+/// while tracing is enabled and returns it for reuse when it exits.  While tracing is disabled a scope costs a
+/// single relaxed load and branch.  ExportChromeTrace() writes everything
+/// recorded so far in the Chrome trace event format, which chrome://tracing
+/// and ui.perfetto.dev both open.
+///
+/// |name| must be a string literal (only the pointer is stored).
+namespace gamepad {
+namespace TracePoints {
+
+extern std::atomic<bool> g_enabled;
+
+inline bool Enabled() { return g_enabled.load(std::memory_order_relaxed); }
+
+/// Enables or disables recording.  Enabling clears previously recorded
+/// events.
+void SetEnabled(bool enabled);
+
+/// Names the calling thread in exported traces.  Cheap whether or not
+/// tracing is enabled; allocates nothing.
+void NameThread(const char* name);
+
+/// Monotonic timestamp used by trace events.
+int64_t NowMicros();
+
+/// Appends a complete event to the calling thread's ring.
+void Record(const char* name, int64_t begin_us, int64_t end_us);
+
+/// Writes all recorded events to |path| as Chrome trace JSON.  May run
+/// while other threads are recording.
+bool ExportChromeTrace(const std::string& path);
+
+class Scope {
+ public:
+  explicit Scope(const char* name)
+      : name_(Enabled() ? name : nullptr), begin_us_(name_ ? NowMicros() : 0) {}
+  ~Scope() {
+    if (name_) Record(name_, begin_us_, NowMicros());
+  }
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+ private:
+  const char* name_;
+  int64_t begin_us_;
+};
+
+}  // namespace TracePoints
+}  // namespace gamepad
+
+#define GAMEPAD_TRACE_CONCAT_(a, b) a##b
+#define GAMEPAD_TRACE_CONCAT(a, b) GAMEPAD_TRACE_CONCAT_(a, b)
+#define GAMEPAD_TRACE_SCOPE(name)                            \
+  ::gamepad::TracePoints::Scope GAMEPAD_TRACE_CONCAT(trace_scope_, \
+                                                     __LINE__)(name)
+
+#endif  // FLUTTER_PLUGIN_TRACE_POINTS_H_